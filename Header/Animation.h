@@ -0,0 +1,113 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mesh.hpp"
+
+struct aiMesh;
+struct aiScene;
+
+// Size of the bone palette uniform block. Must match MAX_BONES in basic.vert.
+#define MAX_BONES 128
+
+struct BoneInfo {
+    int id;            // index into the bone palette
+    glm::mat4 offset;  // mesh space -> bone space (inverse bind matrix)
+};
+
+struct VectorKey { float time; glm::vec3 value; };
+struct RotationKey { float time; glm::quat value; };
+
+// Keyframes for one skeleton node.
+struct AnimationChannel {
+    int node;
+    std::vector<VectorKey> positions;
+    std::vector<RotationKey> rotations;
+    std::vector<VectorKey> scales;
+};
+
+struct AnimationClip {
+    std::string name;
+    float duration;        // ticks
+    float ticksPerSecond;
+    std::vector<AnimationChannel> channels;
+    std::vector<int> channelOfNode;  // node index -> channel index, -1 if the node is not animated
+};
+
+// Node hierarchy of a model flattened so that parents always come before their children.
+struct Skeleton {
+    std::vector<std::string> names;
+    std::vector<int> parent;            // -1 for the root
+    std::vector<glm::mat4> bindLocal;   // node transform from the file (used when a node has no channel)
+    std::vector<int> boneIndex;         // palette slot, -1 for plain nodes
+    std::vector<glm::mat4> boneOffset;  // per node, only meaningful when boneIndex >= 0
+    glm::mat4 globalInverse = glm::mat4(1.0f);
+    int boneCount = 0;
+};
+
+// Per-character playback state. Palettes are double buffered: the worker writes the back one
+// while the renderer reads palettes[front].
+struct Animator {
+    const Skeleton* skeleton = nullptr;
+    const AnimationClip* clip = nullptr;
+    float time = 0.0f;   // ticks
+    float speed = 1.0f;  // playback rate multiplier (driven by movement speed)
+    std::vector<glm::mat4> palettes[2];
+    int front = 0;
+
+    // scratch space reused every sample (no per-frame allocations)
+    std::vector<glm::mat4> globals;
+
+    const std::vector<glm::mat4>& currentPalette() const { return palettes[front]; }
+};
+
+// Import helpers used by Model while the aiScene is alive.
+void extractBoneWeights(std::vector<Vertex>& vertices, const aiMesh* mesh, std::map<std::string, BoneInfo>& boneInfoMap, int& boneCounter);
+void buildSkeleton(const aiScene* scene, const std::map<std::string, BoneInfo>& boneInfoMap, Skeleton& out);
+void importAnimations(const aiScene* scene, const Skeleton& skeleton, std::vector<AnimationClip>& out);
+
+// Point an animator at a skeleton/clip (clip may be nullptr -> bind pose) and size its buffers.
+void resetAnimator(Animator& animator, const Skeleton* skeleton, const AnimationClip* clip);
+
+// Advance time by dt seconds (scaled by speed) and sample into the back palette.
+void advanceAnimator(Animator& animator, float dt);
+
+// CPU version of the vertex shader skinning (used for bounds of the posed mesh).
+glm::vec3 skinPosition(const Vertex& v, const std::vector<glm::mat4>& palette);
+
+// Samples bone palettes on a worker thread. kick() hands over a batch and returns immediately,
+// wait() blocks until it is done and flips every animator's palette.
+class AnimationWorker {
+public:
+    ~AnimationWorker();
+    void start();
+    void stop();
+    void kick(const std::vector<Animator*>& animators, float dt);
+    void wait();
+
+private:
+    void run();
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Animator*> jobs;
+    float jobDt = 0.0f;
+    bool pending = false;
+    bool quit = false;
+};
+
+// Bone palette uniform buffer (std140 block "BoneBlock", binding point BONE_BLOCK_BINDING).
+#define BONE_BLOCK_BINDING 0
+void initBoneBuffer();
+void bindBoneBlock(unsigned program);
+void uploadBonePalette(const std::vector<glm::mat4>& palette);
+void shutdownBoneBuffer();
@@ -0,0 +1,5 @@
+#pragma once
+
+// Offline performance benchmarks, run with `Kostur.exe --bench` (no interactive window).
+// Prints results to stdout; returns the process exit code.
+int runBenchmarks();
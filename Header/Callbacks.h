@@ -1,11 +1,12 @@
 #pragma once
 #include <GLFW/glfw3.h>
 
-void center_callback(GLFWwindow* window, int button, int action, int mods);
+// App input handlers. They are not registered with GLFW directly: drainInputEvents (InputQueue.h) calls them
+// at the start of a frame, so they must not issue GL calls.
+// center_callback gets the cursor position (window coordinates) at the time of the click.
+void center_callback(GLFWwindow* window, int button, int action, int mods, double cursorX, double cursorY);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
-void updateMovement(GLFWwindow* window, float dt);
-void updateMapMovement(GLFWwindow* window, float dt);
 
 // New: mouse movement callback (used for mouse-look when cursor is captured)
 void mouse_move_callback(GLFWwindow* window, double xpos, double ypos);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Camera paths: animated transitions (entering / leaving the overview) and scripted fly-throughs.
+// A path is a list of keys (time, position, orientation). Positions follow a Catmull-Rom spline through the
+// keys, orientations are slerped between neighbouring keys. When a path starts it is baked into poses at
+// CAMERA_PATH_BAKE_HZ, so playing it back is a lookup + lerp per frame.
+//
+// While a path plays it owns the camera (Main copies the pose into the ViewState and walking is paused).
+// Time advances with the frame dt, so a replayed session flies the same path.
+//
+// Prefetch: at start the baked poses are turned into the parts of the map plane the camera will see
+// (CameraPathRegion, every CAMERA_PATH_PREFETCH_STEP seconds) and handed to every registered prefetch hook
+// before the first frame of the path, so whatever loads data for a region can do it ahead of time.
+
+#define CAMERA_PATH_BAKE_HZ 120.0f
+#define CAMERA_PATH_PREFETCH_STEP 0.25f
+#define CAMERA_TRANSITION_SECONDS 0.8f   // enter / leave overview, and the lead-in / out of a fly-through
+#define CAMERA_FLYTHROUGH_PATH "Resources/flythrough.path" // P plays it
+
+struct CameraPose {
+    glm::vec3 position{ 0.0f };
+    float yawDeg = 0.0f;      // same convention as ViewState::cameraYaw / cameraPitch
+    float pitchDeg = 0.0f;
+};
+
+struct CameraPathKey {
+    float time = 0.0f;        // seconds from the start of the path
+    glm::vec3 position{ 0.0f };
+    glm::quat orientation;
+};
+
+// Part of the plane (y = 0) inside the view frustum at `time`: XZ bounds, not clamped to the map.
+struct CameraPathRegion {
+    float time = 0.0f;
+    glm::vec2 min{ 0.0f };
+    glm::vec2 max{ 0.0f };
+};
+
+// Projection the regions are computed for (kept current by Main).
+struct CameraLens {
+    float fovY = 0.78f;       // radians
+    float aspect = 1.0f;
+    float maxDistance = 60.0f;
+};
+
+glm::quat cameraOrientation(float yawDeg, float pitchDeg);
+CameraPose cameraPoseAt(const glm::vec3& position, const glm::quat& orientation);
+
+// Eased move from one pose to another over CAMERA_TRANSITION_SECONDS, arcing up a little on the way.
+void startCameraTransition(const CameraPose& from, const CameraPose& to);
+
+// Fly-through: keys from a text file, one per line "time x y z yaw pitch" (seconds, world units, degrees;
+// '#' starts a comment). The path leads in from `from` and returns to it at the end.
+// Returns false (and leaves the current path alone) if the file is missing or has fewer than two keys.
+bool startCameraFlythrough(const char* path, const CameraPose& from);
+
+// A fly-through flies back to where it started from the current pose; a transition just ends.
+void cancelCameraPath();
+bool cameraPathActive();
+bool cameraFlythroughActive();
+
+// Once per frame: advance by dt and write the pose. Returns false when no path is playing (pose untouched).
+bool updateCameraPath(float dt, CameraPose& pose);
+
+void setCameraPathLens(const CameraLens& lens);
+void addCameraPathPrefetch(std::function<void(const std::vector<CameraPathRegion>&)> hook);
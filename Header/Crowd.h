@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "mesh.hpp"
+#include "MeshLod.h"
+
+// Crowd of walking agents drawn with the active model (load tests / demo).
+// Agent state is kept as structure-of-arrays and advanced in a SIMD loop split across workerPool().
+// Each frame cullCrowd() frustum-culls the agents and buckets the survivors by mesh LOD (picked from
+// their projected screen size, with per-agent hysteresis), drawCrowd() then issues one instanced draw
+// per mesh per LOD.
+
+// model LOD levels 0..MESH_LOD_MAX-1, then the proxy prism for agents only a few pixels tall;
+// agents farther than maxDistance are dropped (culled counts go to the CULL_CROWD stats)
+#define CROWD_PROXY_LEVEL MESH_LOD_MAX
+#define CROWD_LOD_LEVELS  (MESH_LOD_MAX + 1)
+
+struct CrowdStats {
+    int    agents = 0;
+    int    visible = 0;
+    int    perLod[CROWD_LOD_LEVELS] = {};
+    double simulateMs = 0.0;
+    double cullMs = 0.0;
+    double drawMs = 0.0;   // CPU time spent submitting the instanced draws
+};
+
+// Simulation (CPU only, safe without a GL context)
+void initCrowd(int agentCount, float mapHalf, unsigned seed = 1);
+void updateCrowd(float dt);
+int  crowdSize();
+
+// Culling + LOD selection. lift = height of the agent origin above the plane, radius = bounding sphere,
+// height = agent height in world units (for the screen-size LOD pick with fovY / viewportHeightPx).
+void cullCrowd(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos,
+               float lift, float radius, float height, float fovY, float viewportHeightPx, float maxDistance);
+const CrowdStats& crowdStats();
+
+// Meshes the crowd is drawn with: the model's meshes (lodCount levels each) and the far proxy.
+// The pointers are not owned and must be reset when the model is reloaded.
+void setCrowdMeshes(const std::vector<Mesh*>& meshes, int lodCount, Mesh* proxy);
+
+// Low-poly stand-in (octagonal prism over the bounding box) used as the far LOD.
+Mesh buildCrowdProxyMesh(const glm::vec3& bbMin, const glm::vec3& bbMax, const glm::vec3& color);
+
+// baseModel = per-model scale / centering / orientation applied before the per-agent placement.
+// The shader must be built from crowd.vert (per-instance attribute 5).
+void drawCrowd(Shader& shader, const glm::mat4& baseModel, float lift, const glm::mat4& view, const glm::mat4& projection);
+void shutdownCrowd();
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// View frustum as six planes (xyz = inward normal, w = distance), extracted from projection * view.
+// Order: left, right, bottom, top, near, far.
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+Frustum extractFrustum(const glm::mat4& viewProjection);
+
+// True if the sphere touches the inside of the frustum (conservative).
+bool sphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius);
+
+// Bounding volume of an object: local box plus the sphere around it.
+struct Bounds {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+    glm::vec3 center = glm::vec3(0.0f);
+    float     radius = 0.0f;
+};
+
+Bounds boundsFromMinMax(const glm::vec3& min, const glm::vec3& max);
+Bounds mergeBounds(const Bounds& a, const Bounds& b);
+// World-space sphere of a local bounds under `model` (radius scaled by the largest axis scale).
+Bounds transformBounds(const Bounds& local, const glm::mat4& model);
+
+// Spheres as separate coordinate arrays. A null y / radius array means every sphere uses yConst / radiusConst
+// (crowd agents all stand at the same height and share one radius).
+struct SphereSoA {
+    const float* x = nullptr;
+    const float* y = nullptr;
+    const float* z = nullptr;
+    const float* radius = nullptr;
+    float yConst = 0.0f;
+    float radiusConst = 0.0f;
+};
+
+// Vectorized test (4 spheres per SSE step) of spheres [begin, end): visible[i - begin] = 1 when the sphere
+// touches the frustum and its near side is within maxDistance of eye. Safe to call from worker threads.
+void cullSpheres(const Frustum& frustum, const glm::vec3& eye, float maxDistance,
+                 const SphereSoA& spheres, size_t begin, size_t end, unsigned char* visible);
+
+// Per-frame culling stage used by main(): every 3D draw asks here before it is submitted.
+enum CullCategory {
+    CULL_MAP,
+    CULL_AVATAR,
+    CULL_PINS,
+    CULL_CROWD,
+    CULL_CATEGORY_COUNT
+};
+
+struct CullStats {
+    int tested[CULL_CATEGORY_COUNT] = {};
+    int culled[CULL_CATEGORY_COUNT] = {};
+};
+
+void beginCullFrame(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye, float maxDistance);
+
+// Single object test against the current frame (counted in the stats).
+bool cullObject(const Bounds& worldBounds, CullCategory category);
+// Batch test against the current frame (counted in the stats); returns how many are visible.
+size_t cullBatch(const SphereSoA& spheres, size_t count, unsigned char* visible, CullCategory category);
+// For stages that run cullSpheres themselves (e.g. in parallel chunks).
+void recordCulling(CullCategory category, int tested, int culled);
+
+const CullStats& cullStats();
+const char* cullCategoryName(CullCategory category);
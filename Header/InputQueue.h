@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct GLFWwindow;
+
+// Input events between the GLFW callbacks and the frame loop.
+// The callbacks (through the recorder, InputReplay.h) only push a compact event into a lock-free
+// single-producer / single-consumer ring; the frame drains it at one defined point (drainInputEvents, start
+// of frame) and that is where the app handlers in Callbacks.cpp run. Event handling therefore never
+// interleaves with rendering, and the producer (whoever pumps glfwPollEvents) and the consumer may be
+// different threads. The handlers only touch SceneState and window state (cursor / capture mode); GL state
+// they request (F1..F4) is applied by the frame.
+//
+// Every event is stamped when it arrives; after the frame that handled it is presented
+// (inputEventsPresented, right after the swap) the event-to-present time goes into inputLatencyStats().
+// Polled input (held keys, gamepad sticks) has no event of its own: the poll that first sees it change stamps
+// it (notePolledInputChange) and it is measured the same way.
+
+#define INPUT_QUEUE_CAPACITY 256  // events per frame before new ones are dropped (power of two)
+#define INPUT_LATENCY_HISTORY 120 // frames with input in the latency window
+
+enum InputEventType : uint8_t {
+    INPUT_EVENT_KEY = 1,
+    INPUT_EVENT_BUTTON,
+    INPUT_EVENT_CURSOR,
+    INPUT_EVENT_SCROLL
+};
+
+struct InputEvent {
+    uint8_t type = 0;
+    uint8_t action = 0;
+    uint8_t mods = 0;
+    int16_t code = 0;       // key or mouse button
+    int32_t scancode = 0;
+    double  x = 0.0, y = 0.0; // cursor position (BUTTON: where the click was), scroll offsets
+    int64_t arrivedUs = 0;  // steady clock
+};
+
+// Fixed-capacity SPSC ring: push() from one thread, pop() from one other thread, no locks.
+// head / tail live on their own cache lines so the two sides do not share one.
+template <typename T, size_t N>
+class SpscRing {
+    static_assert((N & (N - 1)) == 0, "capacity must be a power of two");
+public:
+    bool push(const T& item)
+    {
+        const size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) == N) return false; // full
+        items[tail & (N - 1)] = item;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        const size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire)) return false; // empty
+        item = items[head & (N - 1)];
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> headIndex{ 0 };
+    alignas(64) std::atomic<size_t> tailIndex{ 0 };
+    T items[N];
+};
+
+struct InputLatencyStats {
+    double lastMs = 0.0;     // oldest event of the last frame that had input
+    double avgMs = 0.0;      // over the window (per frame, oldest event)
+    double maxMs = 0.0;
+    uint64_t events = 0;     // handled since start
+    uint64_t dropped = 0;    // ring was full
+};
+
+// Producer side (GLFW callbacks). false = ring full, the event was dropped.
+bool pushInputEvent(InputEvent event);
+
+// Consumer side: run the handlers for everything queued so far.
+void drainInputEvents(GLFWwindow* window);
+
+// A polled input changed at arrivedUs (inputClockUs); counts towards the next present.
+void notePolledInputChange(int64_t arrivedUs);
+int64_t inputClockUs();
+
+// Right after glfwSwapBuffers: the events drained this frame are on screen.
+void inputEventsPresented();
+
+// Anything (events or polled changes) waiting for the next present (the latency mode flashes a marker then).
+bool inputPendingPresent();
+void resetInputLatencyStats();
+
+const InputLatencyStats& inputLatencyStats();
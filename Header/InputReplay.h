@@ -0,0 +1,66 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+// Input session recording / deterministic replay.
+// Everything the app reacts to goes through here: the GLFW callbacks (key, mouse button, cursor, scroll),
+// the keys the movement code polls every frame and the frame dt. --record <file> logs them to a compact
+// binary file; --replay <file> feeds them back instead of the live input (live events are ignored), with the
+// recorded dt, so the same session produces the same frames. --headless (with --replay) runs in a hidden
+// window without the frame limiter and prints frame time statistics at the end, so a kiosk session can be
+// replayed against different builds to bisect a performance regression.
+//
+// Gamepad: the first connected joystick with a gamepad mapping. Its sticks are read once per frame (and
+// recorded with the frame), the d-pad counts as the arrow keys, and the face / shoulder buttons are turned
+// into the key presses of the matching keyboard shortcuts (recorded and handled like real key events).
+//
+// File: "KINP" + version + framebuffer / window size, then records of [u8 type][u32 us since start][payload].
+// A FRAME record (dt + polled key bits + sticks) starts every frame; the events after it are the ones GLFW
+// delivered during that frame's poll. Little-endian, fields packed. Version 1 logs (no sticks) still replay.
+
+#define GAMEPAD_DEADZONE 0.15f  // radial, per stick
+
+// Sticks after the dead zone, -1..1 (quantized to 16 bits so a replay sees exactly what the session saw).
+struct GamepadInput {
+    bool connected = false;
+    float moveX = 0.0f, moveY = 0.0f;  // left stick: right, forward
+    float lookX = 0.0f, lookY = 0.0f;  // right stick: right, up
+};
+
+enum InputSessionMode {
+    INPUT_LIVE = 0,
+    INPUT_RECORD,
+    INPUT_REPLAY
+};
+
+// Before the window exists: open the log. Replay also returns the recorded framebuffer size.
+bool startInputRecording(const char* path);
+bool openInputReplay(const char* path, int& framebufferW, int& framebufferH);
+InputSessionMode inputSessionMode();
+
+// Registers the GLFW callbacks: they log (when recording) and queue the events for drainInputEvents
+// (InputQueue.h), which runs the app handlers.
+void installInputCallbacks(GLFWwindow* window);
+
+// Start of frame: reads the gamepad; record -> logs dt, the polled keys and the sticks; replay -> returns the
+// recorded dt. Live: measuredDt.
+float inputBeginFrame(GLFWwindow* window, float measuredDt);
+
+// End of frame, in place of glfwPollEvents(): replay queues this frame's logged events.
+void inputPollEvents(GLFWwindow* window);
+
+// Polled input (replaces glfwGetKey / glfwGetCursorPos / glfwGetWindowSize in the input handlers).
+bool inputKeyDown(GLFWwindow* window, int key);
+void inputCursorPos(GLFWwindow* window, double* x, double* y);
+void inputWindowSize(GLFWwindow* window, int* width, int* height);
+
+// The gamepad as of this frame's inputBeginFrame (the recorded one during a replay).
+const GamepadInput& inputGamepad();
+// Read the gamepad again now (live sampling between frames; button presses are delivered as usual).
+GamepadInput inputSampleGamepad(GLFWwindow* window);
+
+// true once a replay has run out of frames
+bool inputReplayFinished();
+
+// Flush / close the log; after a replay print the frame time summary.
+void finishInputSession();
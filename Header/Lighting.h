@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "SceneState.h"
+
+// Tiled forward lighting for the map plane (street lights, measurement pin glows, ...).
+// Every frame the visible point lights are binned into LIGHT_TILE_SIZE x LIGHT_TILE_SIZE screen tiles on
+// the CPU (rows split across workerPool()); the compact light array, the per-tile (offset, count) table and
+// the light index list go to texture buffers, and map3d.frag (TILED_LIGHTS variant) loops only over the
+// lights of its own tile. A tile keeps at most MAX_LIGHTS_PER_TILE lights, so the per-fragment cost stays
+// bounded however many lights the scene has.
+
+#define LIGHT_TILE_SIZE     32
+#define MAX_LIGHTS_PER_TILE 32
+#define MAX_SCENE_LIGHTS    4096
+
+// texture units the light buffers are bound to (after the map texture)
+#define LIGHT_DATA_UNIT  4
+#define LIGHT_TILE_UNIT  5
+#define LIGHT_INDEX_UNIT 6
+
+struct PointLight {
+    glm::vec3 position;
+    float     radius;    // contribution reaches zero here
+    glm::vec3 color;     // linear rgb
+    float     intensity;
+};
+
+struct LightingStats {
+    int    lights = 0;          // submitted this frame
+    int    visible = 0;         // survived distance / frustum tests
+    int    maxPerTile = 0;
+    int    saturatedTiles = 0;  // tiles that hit MAX_LIGHTS_PER_TILE
+    double binMs = 0.0;
+};
+
+void initLighting();
+void shutdownLighting();
+
+// Street lights on a jittered grid over the map (static, kept until the next call).
+void placeStreetLights(float mapHalf, float spacing, unsigned seed = 7);
+
+// Per-frame lights (pins, highlights): cleared by beginLightFrame().
+void beginLightFrame();
+void addLight(const PointLight& light);
+
+// Bin static + per-frame lights into screen tiles and upload. viewport = framebuffer size in pixels.
+void buildLightTiles(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos,
+                     int viewportW, int viewportH, float maxDistance);
+
+// Bind the buffers to LIGHT_*_UNIT and set the tile uniforms on the (bound) program.
+void bindLightTiles(unsigned program);
+
+const LightingStats& lightingStats();
+
+// Scene light uniform buffer (std140 block "SceneLightBlock", binding point SCENE_LIGHT_BLOCK_BINDING).
+// Uploaded once per frame and shared by every map3d variant and every view that draws the plane.
+#define SCENE_LIGHT_BLOCK_BINDING 1
+void bindSceneLightBlock(unsigned program);
+void uploadSceneLight(const SceneLightState& light);
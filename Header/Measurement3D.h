@@ -1,7 +1,33 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <vector>
 
-void initMeasurement3D();
+#include "SceneState.h"
+
+// Pin meshes (unit sphere + cone, position + normal per vertex). Built without GL, so startup can build them
+// on a worker while the GL thread sets up the rest.
+struct MeasurementGeometry {
+    std::vector<float> sphereVerts, coneVerts;
+    std::vector<unsigned> sphereIdx, coneIdx;
+};
+MeasurementGeometry buildMeasurementGeometry();
+
+void initMeasurement3D(const MeasurementGeometry& geometry = buildMeasurementGeometry());
 void shutdownMeasurement3D();
-void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, float planeScale);
\ No newline at end of file
+// Pins + path of the measurement points; points whose ray misses the plane fall back to the saved map window.
+void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, float planeScale,
+                        const MeasurementState& measurement, const SavedViewState& saved);
+
+// The measurement points on the plane (y = 0), unprojected through the camera they were clicked with.
+std::vector<glm::vec3> measurementWorldPoints(const glm::mat4& pickView, const glm::mat4& pickProjection, int fbW, int fbH,
+                                              float planeScale, const MeasurementState& measurement, const SavedViewState& saved);
+
+// Centers of the pin balls drawn by the last drawMeasurements3D call (the last one is the lit pin).
+const std::vector<glm::vec3>& measurementPinLights();
+
+// The same route seen from a second view (minimap): the points are unprojected through the camera they were
+// clicked with (pickView / pickProjection), pins are tested against this view's own frustum. The frame's
+// culling stats and measurementPinLights() are not touched.
+void drawMeasurementsInView(const glm::mat4& view, const glm::mat4& projection, const glm::mat4& pickView, const glm::mat4& pickProjection,
+                            float planeScale, const MeasurementState& measurement, const SavedViewState& saved);
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mesh.hpp"
+
+// Import-time LOD chains for model meshes.
+// Every level is an index list into the mesh's original vertex buffer (so textures, normals and
+// bone weights stay valid), produced by quadric edge-collapse simplification of the previous level.
+// Vertices on open borders and UV/normal seams are never moved. Chains are cached next to the
+// compressed textures (Resources/cache/<model>.lod) and rebuilt when the model file is newer.
+
+#define MESH_LOD_MAX 4
+
+// Index list for one mesh: level 0 first, then every generated level (same layout as Mesh::indices/lods).
+struct MeshLodChain {
+    std::vector<unsigned int> indices;
+    std::vector<MeshLod>      lods;
+};
+
+// Simplify `indices` towards targetIndexCount, never exceeding maxError (relative to the mesh bounds diagonal).
+// Returns the new index list; outError receives the largest collapse error that was accepted.
+std::vector<unsigned int> simplifyMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+    size_t targetIndexCount, float maxError, float* outError = nullptr);
+
+// Level 0 = the input indices, then up to MESH_LOD_MAX-1 simplified levels (levels that barely shrink are dropped).
+MeshLodChain buildLodChain(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+// Cache of a whole model's chains, one entry per mesh in import order. Entries are validated against the
+// vertex / level-0 index counts by the caller. load returns false if the cache is missing or stale.
+bool loadLodCache(const std::string& modelPath, std::vector<MeshLodChain>& chains);
+void saveLodCache(const std::string& modelPath, const std::vector<MeshLodChain>& chains);
+
+// Projected height in pixels of an object `worldHeight` tall seen from `distance` with a vertical fov.
+float projectedHeightPx(float worldHeight, float distance, float fovYRadians, float viewportHeightPx);
+
+// Screen-size LOD selection with hysteresis: a level is only left once the size is clearly past
+// the switch point, so objects hovering around a threshold do not pop back and forth.
+int selectLodLevel(float screenHeightPx, int currentLevel, int levelCount);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Overview minimap: a second view of the scene, drawn picture-in-picture in the top-right corner while
+// walking (N toggles). An orthographic camera looks straight down at the whole map plane; it shows the map,
+// the avatar and the measurement route.
+//
+// The view renders into its own small LDR target and the target is copied into the corner every frame. It
+// shares the frame's data with the walking view (scene light block, shadow map, bone palette, map texture)
+// and only sets its own camera uniforms. Its content is keyed like the shadow map: while the key changes it
+// is redrawn at most every MINIMAP_MIN_INTERVAL seconds, an unchanged one only every MINIMAP_IDLE_INTERVAL
+// (picks up what the key does not cover, e.g. a reloaded shader).
+
+#define MINIMAP_SIZE 256                  // texels, square
+#define MINIMAP_MARGIN 16                 // pixels from the window corner
+#define MINIMAP_MIN_INTERVAL (1.0 / 30.0) // seconds between redraws while the content changes
+#define MINIMAP_IDLE_INTERVAL 0.5         // seconds between redraws of unchanged content
+
+// Everything that changes what the minimap shows.
+struct MinimapKey {
+    glm::mat4 avatarModel = glm::mat4(0.0f); // zero = no avatar
+    int       measurementPoints = 0;
+    float     measurementDistance = 0.0f;
+    float     walkRouteLength = 0.0f;
+    glm::vec4 light = glm::vec4(0.0f);       // direction (or position) + intensity
+    glm::vec2 mapOffset = glm::vec2(0.0f);
+    float     mapTexScale = 0.0f;
+    bool      shadows = false;
+};
+
+struct MinimapStats {
+    int    renders = 0;          // redraws since start
+    int    reused = 0;           // frames that showed the previous image
+    double lastRenderMs = 0.0;   // CPU time of the last redraw
+};
+
+void initMinimap();
+void shutdownMinimap();
+
+// Top-down orthographic camera over a plane of half size planeHalf centered on the origin.
+void minimapCamera(float planeHalf, glm::mat4& view, glm::mat4& projection, glm::vec3& eye);
+
+// Returns true if the minimap must be redrawn this frame (now = seconds): its target is bound, cleared and
+// the viewport set; draw the view and call endMinimapPass(). false = the previous image is still shown.
+bool beginMinimapPass(const MinimapKey& key, double now);
+void endMinimapPass(int viewportW, int viewportH);
+
+// Copy the image into the top-right corner of the bound framebuffer (fbW x fbH), with a thin frame.
+void drawMinimap(int fbW, int fbH);
+
+const MinimapStats& minimapStats();
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Navigation layer over the map plane.
+// The plane is split into square cells; a cell is blocked or walkable. The walkable mask comes from a raster
+// (NAV_MASK_PATH, white = walkable) when one is supplied, otherwise it is derived from the map image itself
+// (water is blocked; streets, squares and blocks are walkable). Blocked bits are packed 64 cells per word,
+// and every NAV_BLOCK x NAV_BLOCK group of cells keeps a summary (free / mixed / full), so queries over open
+// ground or solid water are answered per block instead of per cell.
+//
+// Queries: point, circle (the avatar's footprint; the simulation thread uses it to stop the avatar at
+// the water's edge) and segment (line of sight). Paths: A* or jump point search (JPS) on the 8-connected grid
+// (diagonal steps only between two open cells), then shortened with line-of-sight checks.
+// A grid is immutable once built, so any thread may query it; building and route searches run on
+// workerPool(), never on the render thread.
+
+#define NAV_GRID_CELLS 512                    // cells per side of the map grid
+#define NAV_BLOCK_SHIFT 3
+#define NAV_BLOCK (1 << NAV_BLOCK_SHIFT)      // cells per side of an occupancy block
+#define NAV_AVATAR_RADIUS 0.08f               // world units
+#define NAV_MASK_PATH "Resources/navmask.png" // optional walkable raster (same framing as the map image)
+
+enum NavBlockState : uint8_t {
+    NAV_BLOCK_FREE = 0,
+    NAV_BLOCK_MIXED,
+    NAV_BLOCK_FULL
+};
+
+enum NavSearch {
+    NAV_SEARCH_ASTAR = 0,
+    NAV_SEARCH_JPS
+};
+
+class NavGrid {
+public:
+    NavGrid() = default;
+    // width x height cells covering [-worldHalf, worldHalf] on X and Z, all walkable
+    NavGrid(int width, int height, float worldHalf);
+
+    int width() const { return cellsX; }
+    int height() const { return cellsZ; }
+    float cellSize() const { return cell; }
+
+    // Edit, then rebuildBlocks() before querying.
+    void setBlocked(int x, int z, bool blocked);
+    void rebuildBlocks();
+
+    // Copy with every cell blocked that comes closer than radius to a blocked cell (or the edge): a walker of
+    // that radius fits wherever its center stays on open cells of the copy.
+    NavGrid inflated(float radius) const;
+
+    // Cells outside the grid are blocked.
+    bool blocked(int x, int z) const
+    {
+        if ((unsigned)x >= (unsigned)cellsX || (unsigned)z >= (unsigned)cellsZ) return true;
+        return (bits[(size_t)z * wordsPerRow + (x >> 6)] >> (x & 63)) & 1u;
+    }
+    NavBlockState blockState(int bx, int bz) const { return (NavBlockState)blocks[(size_t)bz * blocksX + bx]; }
+    float blockedFraction() const;
+
+    glm::ivec2 cellAt(const glm::vec2& worldXZ) const;
+    glm::vec2 cellCenter(const glm::ivec2& c) const;
+
+    bool walkable(const glm::vec2& worldXZ) const;
+    bool circleFree(const glm::vec2& center, float radius) const;
+    bool segmentFree(const glm::vec2& a, const glm::vec2& b) const;
+
+private:
+    bool cellsFree(int x0, int z0, int x1, int z1) const; // inclusive cell rectangle, via the blocks
+
+    int cellsX = 0, cellsZ = 0;
+    int wordsPerRow = 0;
+    int blocksX = 0, blocksZ = 0;
+    float half = 0.0f;
+    float cell = 1.0f;
+    std::vector<uint64_t> bits;   // 1 = blocked
+    std::vector<uint8_t> blocks;  // NavBlockState per block
+};
+
+struct NavSearchStats {
+    int    expanded = 0;  // nodes taken off the open list
+    double ms = 0.0;
+};
+
+// Cell path start -> goal (corner cells only: consecutive cells are joined by straight or diagonal runs).
+// Empty if either end is blocked or there is no path. Safe to run on several threads at once.
+std::vector<glm::ivec2> findNavPath(const NavGrid& grid, const glm::ivec2& start, const glm::ivec2& goal,
+                                    NavSearch search, NavSearchStats* stats = nullptr);
+
+// Drop corners that have line of sight past them (string pulling). Returns world XZ points. Line of sight is
+// tested on clearance, the search grid inflated by the walker's radius, so a shortcut never takes the body
+// over a blocked cell; on a path that hugs a wall the corners stay.
+std::vector<glm::vec2> smoothNavPath(const NavGrid& clearance, const std::vector<glm::ivec2>& cells);
+
+// ---- the map's grid (built once at startup) ----
+
+// Start building on workerPool() from the map image's decoded pixels (RGBA8, bottom row first as uploaded to
+// GL; empty = the image did not load), or from NAV_MASK_PATH when there is one. The map texture's read job
+// hands its pixels over, so the image is decoded once.
+void startNavGridBuild(std::vector<unsigned char> mapRgba, int width, int height, float worldHalf);
+// Block until the build is done; nullptr if it failed or was never started (movement is then only clamped
+// to the plane).
+const NavGrid* waitNavGrid();
+// nullptr until the build is done.
+const NavGrid* navGrid();
+
+// Walking route through the waypoints (world XZ, e.g. the measurement points), searched on workerPool().
+struct NavRoute {
+    unsigned request = 0;
+    std::vector<glm::vec3> points;  // on the plane (y = 0)
+    float length = 0.0f;            // world units
+    bool complete = false;          // every leg was found (a missing leg is drawn straight)
+    NavSearchStats search;          // summed over the legs
+};
+
+// Returns the request id; a newer request makes older results stale (they are never handed out).
+unsigned requestNavRoute(const std::vector<glm::vec2>& waypoints, NavSearch search = NAV_SEARCH_JPS);
+// The newest finished route, once: true when `route` was filled.
+bool takeNavRoute(NavRoute& route);
+
+struct NavStats {
+    double buildMs = 0.0;
+    float  blockedFraction = 0.0f;
+    bool   fromMask = false;       // built from NAV_MASK_PATH
+    int    routes = 0;             // routes finished since start
+    double lastRouteMs = 0.0;      // search time of the newest route (all legs)
+    int    lastRouteExpanded = 0;
+};
+const NavStats& navStats();
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "SceneState.h"
+
+// HDR scene target + bloom + anti-aliasing.
+// beginScenePass() redirects the 3D scene into an RGBA16F framebuffer so emissive surfaces can output
+// values above 1. endScenePass() builds the bloom: a thresholded half-resolution copy is downsampled into a
+// mip chain, upsampled back with additive blending, and composited over the scene into the default
+// framebuffer. The cost is a fixed set of full-screen passes, independent of how many objects glow.
+// 2D overlay / HUD are drawn after endScenePass() and are not bloomed.
+//
+// RenderSettings (SceneState.h) picks the work. bloomQuality (F6 cycles): 0 = off, 1 = fast (4 mips, 4-tap filters), 2 = high (6 mips,
+// 13-tap down / 9-tap tent up).
+//
+// antiAliasMode (F7 cycles, F8 = MSAA sample count):
+//   AA_MSAA - the scene target is multisampled (msaaSamples) and resolved before bloom.
+//   AA_FXAA - the composite goes to an LDR target and an FXAA pass writes the back buffer.
+// With bloom and AA both off the scene renders straight to the back buffer.
+//
+// Dynamic resolution (dynamicResolution, F9): the 3D scene renders at renderScale x the back buffer size and
+// is upscaled by the composite / FXAA pass; the HUD is drawn afterwards at native resolution. The scale
+// follows the smoothed GPU frame time against dynamicResolutionTargetMs, within renderScaleMin..Max, in
+// 5% steps: over 95% of the budget it drops to the scale that should fit, under 75% it grows one step,
+// in between it holds, and every change is followed by a cooldown so it does not oscillate.
+//
+// GPU cost comes from the frame profiler (Profiler.h, results a few frames late, no stalls): the scene part
+// (beginScenePass .. endScenePass) is the "scene" pass, the post part (resolve, bloom, composite, FXAA) a pass
+// named after the AA mode, e.g. "post (MSAA 4x)", so the F10 overlay and F11 trace show what the active mode
+// costs. postProcessStats() keeps a smoothed frame cost per AA mode, so the modes can be compared on the
+// machine at hand (F5 HUD). Without initProfiler (--bench) nothing is measured and the scale stays put.
+
+#define BLOOM_MAX_MIPS 6
+
+enum AntiAliasMode {
+    AA_OFF = 0,
+    AA_MSAA,
+    AA_FXAA,
+    AA_MODE_COUNT
+};
+
+struct PostProcessStats {
+    double sceneMs = 0.0;                  // GPU time of the last measured frame's scene
+    double postMs = 0.0;                   // ... and of its post-process passes
+    double modeMs[AA_MODE_COUNT] = {};     // smoothed scene + post per AA mode (0 = not measured yet)
+    int    modeSamples = 0;                // sample count modeMs[AA_MSAA] was last measured at
+    double gpuFrameMs = 0.0;               // smoothed scene + post, what the render scale follows
+    float  renderScale = 1.0f;
+    int    sceneWidth = 0, sceneHeight = 0;
+};
+
+void initPostProcess();
+void shutdownPostProcess();
+
+// Call before clearing the frame. viewport = framebuffer size in pixels (targets follow resizes).
+// settings are used until the next beginScenePass.
+void beginScenePass(int viewportW, int viewportH, const RenderSettings& settings);
+void endScenePass();
+
+// Size the 3D scene renders at this frame (after beginScenePass): viewport for passes that restore it and
+// for screen-space work like the light tiles.
+void sceneViewport(int& width, int& height);
+
+const char* antiAliasModeName(int mode);
+const PostProcessStats& postProcessStats();
@@ -0,0 +1,55 @@
+#pragma once
+
+// Frame profiler: nested CPU scopes, GPU pass timing, rolling per-pass histograms, HUD overlay (F10) and a
+// Chrome trace-event export (F11 records the next PROFILER_TRACE_FRAMES frames, open it in
+// chrome://tracing or Perfetto).
+//
+// PROFILE_SCOPE("name") times the enclosing block on the CPU; scopes nest. PROFILE_GPU_SCOPE("name") also
+// puts a GL_TIMESTAMP query at each end of the block, so GPU scopes nest the same way (an outer pass's GPU
+// time includes its inner passes'). Queries are buffered over PROFILER_LATENCY frames:
+// a frame's results are read that many frames later, when the GPU is done with them; a result that is
+// still not ready is dropped, the CPU never waits for it.
+//
+// Main thread only (scopes on other threads are ignored). Names must be string literals.
+
+#define PROFILER_LATENCY 3        // frames of queries in flight
+#define PROFILER_HISTORY 120      // samples per pass in the rolling window
+#define PROFILER_BUCKETS 8        // histogram buckets: <0.1, <0.25, <0.5, <1, <2, <4, <8, >=8 ms
+#define PROFILER_TRACE_FRAMES 300
+
+void initProfiler();
+void shutdownProfiler();
+
+// Frame boundaries: begin collects the finished queries of an older frame and opens the "frame" scope.
+void profilerBeginFrame();
+void profilerEndFrame();
+
+// Explicit scope calls, for blocks that are not a C++ scope. Prefer the macros.
+void profilerPush(const char* name, bool gpu);
+void profilerPop();
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name, bool gpu = false) { profilerPush(name, gpu); }
+    ~ProfileScope() { profilerPop(); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name, true)
+
+// Draw one line per pass (avg / p95 / max of CPU and GPU time + a GPU (or CPU) histogram) with drawText;
+// the block ends above bottomPx.
+void drawProfilerOverlay(float xPx, float bottomPx);
+
+// Start recording a trace; it is written to trace_<date>_<time>.json once the frames and their GPU
+// results are in.
+void requestProfilerTrace();
+bool profilerTraceActive();
+
+// GPU time of a pass in the newest resolved frame (summed over the frame), 0 if it has none yet. results
+// counts the frames resolved for the pass, so a caller can tell a new result from the one it already used.
+double profilerGpuMs(const char* name, unsigned* results = nullptr);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// A polyline parameterized by arc length, for following a route at constant speed.
+// Built once per route: cumulative segment lengths plus a bucket table over the arc length (each bucket knows
+// the first segment that reaches into it), so positionAt() is a bucket lookup and a short forward scan,
+// independent of how many thousand points the route has. There are at least as many buckets as segments,
+// more (up to ROUTE_TRACK_MAX_BUCKETS_PER_SEGMENT x) when the segment lengths vary a lot.
+// Immutable after construction: the simulation thread samples it while the main thread may build the next.
+
+#define ROUTE_TRACK_MAX_BUCKETS_PER_SEGMENT 16
+
+class RouteTrack {
+public:
+    // Consecutive duplicate points are dropped; fewer than two distinct points give an empty track.
+    explicit RouteTrack(const std::vector<glm::vec3>& points);
+
+    bool empty() const { return total <= 0.0f; }
+    float length() const { return total; }
+    size_t pointCount() const { return points.size(); }
+
+    // Point at arc length s (clamped to [0, length()]); direction (optional) = unit tangent of its segment.
+    glm::vec3 positionAt(float s, glm::vec3* direction = nullptr) const;
+
+private:
+    std::vector<glm::vec3> points;
+    std::vector<float> cumulative;  // arc length at each point
+    std::vector<uint32_t> buckets;  // first segment reaching into each bucket
+    float bucketLength = 1.0f;
+    float total = 0.0f;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Everything the input callbacks write and the renderer reads, in one value instead of loose globals.
+// Main owns the instance and registers it as the window user pointer; callbacks reach it with
+// sceneOf(window), render functions get the part they need by reference. Nothing else keeps a copy.
+//
+// Layout: the per-frame (hot) parts come first and are plain values, so a snapshot of a view is a
+// memcpy-sized copy (a second view = a second ViewState). Settings, presets and the saved overview view are
+// cold: written on key presses, read a few times per frame.
+// GL objects (VAOs, textures, cursors) are not scene state and stay in Globals.h.
+
+// Camera + 2D map window of one view. Hot.
+struct ViewState {
+    glm::vec3 cameraPos{ 0.0f, 1.60f, 0.0f };  // player eye position
+    glm::vec3 cameraFront{ 0.0f, 0.0f, 1.0f }; // derived from yaw / pitch (resetCameraFront)
+    glm::vec3 cameraUp{ 0.0f, 1.0f, 0.0f };
+    float cameraYaw = 90.0f;
+    float cameraPitch = -12.0f;
+    float cameraYWalking = 1.60f;              // eye height when walking (scroll changes it)
+
+    bool overviewMode = false;
+    bool pinShowsStanding = false;             // top pin icon follows the overview toggle
+    bool cameraOnPath = false;                 // a camera path (CameraPath.h) drives the camera this frame
+
+    // map pan/zoom: texture sub-rectangle the map shows
+    float mapOffsetX = 0.0f;
+    float mapOffsetY = 0.0f;
+    float mapTexScale = 1.0f;
+};
+
+// Avatar and the 2D walk sprite (written by the simulation results). Hot.
+struct AvatarState {
+    glm::vec3 pos{ 0.0f };
+    float yawDeg = 0.0f;   // facing direction in degrees
+    float meters = 0.0f;   // distance walked
+    int spriteState = 0;   // 0 idle, 1 right, 2 left, 3 up, 4 down
+    int spriteFrame = 0;
+    float spriteTimer = 0.0f;
+    bool autopilot = false;          // walking the measurement route (T)
+    float autopilotProgress = 0.0f;  // 0..1 along it
+};
+
+// View saved when entering overview, restored when leaving it.
+struct SavedViewState {
+    glm::vec3 cameraPos{ 0.0f, 1.60f, 0.0f };
+    glm::vec3 cameraFront{ 0.0f, 0.0f, 1.0f };
+    float cameraYaw = 90.0f;
+    float cameraPitch = -12.0f;
+    float mapOffsetX = 0.0f;
+    float mapOffsetY = 0.0f;
+    float mapTexScale = 0.15f;
+};
+
+// Measurement tool: clicked points in framebuffer pixels and the running total.
+struct MeasurementState {
+    std::vector<std::pair<float, float>> points;
+    float distancePixels = 0.0f;
+    // walking route through the points on the navigation grid (NavGrid.h), filled in when its search finishes
+    std::vector<glm::vec3> walkRoute;
+    float walkRouteLength = 0.0f;   // world units; 0 = no route yet
+};
+
+// Camera tuning and the overview (measuring) camera.
+struct CameraSettings {
+    float speed = 4.0f;           // walking-scale movement
+    float yMeasuring = 10.0f;     // upper bound of the walking eye height
+    float overviewBack = 20.0f;   // how far behind the map center the R overview camera sits
+    float clampMargin = 0.01f;    // world units the camera may stray outside the plane
+
+    // pin overview camera
+    float measureX = 0.0f;
+    float measureY = 18.0f;       // lower -> closer to map
+    float measureZ = -10.0f;      // more negative -> further back from origin (pulls map lower)
+    float measureYaw = 90.0f;
+    float measurePitch = -120.0f;
+};
+
+// Scene light (single point or directional).
+struct SceneLightState {
+    glm::vec3 pos{ 5.0f, 12.0f, 5.0f };
+    glm::vec3 color{ 1.0f, 0.96f, 0.90f };  // linear rgb 0..1, warm white
+    float intensity = 0.65f;
+    float radius = 1.0f;                    // point light falloff (ignored when directional)
+    bool directional = true;
+    glm::vec3 dir{ 0.0f, -1.0f, 0.0f };     // direction the light comes FROM (pointing toward scene)
+};
+
+// Render toggles and budgets (F-keys and letters in key_callback).
+struct RenderSettings {
+    // debug state: depth test / face culling / winding (F1..F4)
+    bool depthTestEnabled = true;
+    bool faceCullingEnabled = false;
+    bool cullBackFaces = true;
+    bool isCCWWinding = true;
+
+    // Culling: objects whose near side is farther than drawDistance are skipped; F5 shows the culled counts.
+    float drawDistance = 60.0f;
+    bool  showCullStats = false;
+
+    // Crowd mode (G toggles). Agents farther than crowdMaxDistance are not drawn.
+    bool  crowdEnabled = false;
+    int   crowdAgentCount = 2000;
+    float crowdMaxDistance = 14.0f;
+
+    // Tiled map lights (L toggles): street lights every streetLightSpacing units + measurement pin glows.
+    bool  mapLightsEnabled = true;
+    float streetLightSpacing = 1.25f;
+
+    // Avatar shadow map (K toggles): resolution in texels and PCF kernel radius (0..2 -> 1, 9 or 25 taps).
+    bool  shadowsEnabled = true;
+    int   shadowMapSize = 2048;
+    int   shadowPcfRadius = 1;
+
+    // HDR bloom (F6 cycles quality: 0 off, 1 fast, 2 high). Only emissive colors above bloomThreshold glow.
+    int   bloomQuality = 2;
+    float bloomThreshold = 1.0f;
+    float bloomIntensity = 0.9f;
+
+    // Anti-aliasing (F7 cycles off / MSAA / FXAA, F8 cycles the MSAA sample count 2/4/8). See PostProcess.h.
+    int   antiAliasMode = 1;
+    int   msaaSamples = 4;
+
+    // Dynamic resolution (F9 toggles): the scene render scale tracks the GPU frame time. See PostProcess.h.
+    bool  dynamicResolution = false;
+    float dynamicResolutionTargetMs = 1000.0f / 75.0f; // the frame limiter's rate
+    float renderScaleMin = 0.5f;
+    float renderScaleMax = 1.0f;
+
+    // Frame profiler overlay (F10; F11 records a Chrome trace). See Profiler.h.
+    bool  showProfiler = false;
+
+    // Overview minimap in the corner while walking (N toggles). See Minimap.h.
+    bool  showMinimap = true;
+
+    // Input latency measurement (F12): the swap is waited out (glFinish) before input-to-present is taken,
+    // and frames that present new input flash a white square in the bottom-right corner (for a photodiode /
+    // high-speed camera check of the same numbers). See InputQueue.h.
+    bool  latencyMode = false;
+};
+
+// Model sizing / runtime reload request (M / B keys).
+// - desiredHeight is used when positioning/lifting the model (vertical lift).
+// - loadHeight is the height passed to loadActiveModel when reloading the mesh (scale computation).
+// - reloadRequested tells Main to reload with loadHeight at the next frame.
+struct ModelRequest {
+    float desiredHeight = 1.5f;
+    float loadHeight = 1.5f;
+    bool  reloadRequested = false;
+};
+
+// Route following (T toggles, [ / ] change the speed): the avatar walks the measurement route, the
+// navigation route when there is one. See Simulation.h.
+struct AutopilotRequest {
+    float speed = 2.0f;             // world units / s
+    bool  toggleRequested = false;  // Main starts / stops it at the next frame
+};
+
+struct SceneState {
+    // hot
+    ViewState view;
+    AvatarState avatar;
+
+    // cold
+    SavedViewState saved;
+    MeasurementState measurement;
+    CameraSettings camera;
+    SceneLightState light;
+    RenderSettings render;
+    ModelRequest model;
+    AutopilotRequest autopilot;
+};
+
+static_assert(std::is_trivially_copyable<ViewState>::value, "ViewState snapshots are plain copies");
+static_assert(std::is_trivially_copyable<AvatarState>::value, "AvatarState snapshots are plain copies");
+
+struct GLFWwindow;
+
+// The scene a window's callbacks act on (glfwSetWindowUserPointer).
+SceneState& sceneOf(GLFWwindow* window);
+
+// cameraFront from cameraYaw / cameraPitch.
+void resetCameraFront(ViewState& view);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SceneState.h"
+
+// Session file: the scene survives a restart (camera, map window, avatar, measurement points, model size,
+// render choices (AA, bloom, shadows, minimap, crowd, dynamic resolution; not the debug toggles), light,
+// autopilot speed).
+// Restored at startup before the window opens, so the first frame already shows it. Saved while running:
+// once per SESSION_SAVE_INTERVAL the persistent part is encoded (a few hundred bytes) and compared with the
+// last save; if it changed, a worker writes it to a temp file and renames that over SESSION_PATH, so a crash
+// mid-write leaves the previous session intact. Exit writes the final state and waits for the writer.
+// Record / replay sessions neither restore nor save (a replay starts from the default scene).
+//
+// File: "KSES" + u32 version + u32 payload size + u32 FNV-1a of the payload, then sections
+// [u32 tag][u32 size][bytes]. Each section lists its fields explicitly (int32 / float / one-byte bool, vec3 as
+// three floats, no padding); a section whose size does not match its field list any more (or an unknown tag)
+// is skipped, so a changed list resets only its own part. Bump SESSION_VERSION when a section changes
+// meaning without changing size.
+
+#define SESSION_PATH "Resources/session.bin"
+#define SESSION_VERSION 2
+#define SESSION_SAVE_INTERVAL 1.0       // seconds between change checks
+#define SESSION_RESTORE_BUDGET_MS 5.0   // startup restore (read + decode); --bench fails above it
+
+// Encode / decode without I/O (the benchmark times them on their own).
+std::vector<uint8_t> encodeSession(const SceneState& scene);
+bool decodeSession(const uint8_t* data, size_t size, SceneState& scene);
+
+// Synchronous temp + rename write.
+bool writeSessionFile(const char* path, const std::vector<uint8_t>& bytes);
+
+// Startup: scene from the file; false (scene untouched) if there is none or it is unusable.
+bool restoreSession(SceneState& scene, const char* path = SESSION_PATH);
+
+// Once per frame (now = frame clock): saves in the background when the persistent state changed.
+void autosaveSession(const SceneState& scene, double now);
+
+// Exit: save the final state and wait until it is on disk.
+void flushSession(const SceneState& scene);
+
+struct SessionStats {
+    double restoreMs = 0.0;   // read + decode at startup
+    size_t bytes = 0;         // size of the last file read / written
+    int    saves = 0;
+};
+SessionStats sessionStats();
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+
+// Shader program cache.
+// Programs are keyed by a hash of their (preprocessed) vertex + fragment source, so two modules asking
+// for the same pair share one GL program (refcounted). Linked programs are also saved with
+// glGetProgramBinary to Resources/cache/shaders/<hash>.bin and restored with glProgramBinary on the
+// next start, which skips compile + link entirely. A binary from another driver / GPU, or one the driver
+// rejects, is ignored and the program is compiled from source as usual (and the binary rewritten).
+
+// Directory the program binaries are written to (created on demand).
+extern const char* SHADER_CACHE_DIR;
+
+// Get a linked program for the two GLSL files. Returns 0 if a file is missing or the program fails to link.
+unsigned acquireProgram(const char* vertexPath, const char* fragmentPath);
+
+// Same, from source strings; label is only used in log messages.
+unsigned acquireProgramFromSource(const std::string& vertexCode, const std::string& fragmentCode, const std::string& label);
+
+// Drop one reference; the program is deleted when the last user releases it.
+void releaseProgram(unsigned program);
+
+// Read a GLSL file the way the cache hashes/compiles it (UTF-8 BOM removed, #version moved to the top).
+std::string readShaderSource(const char* path);
+
+// Startup: read every .vert / .frag in `directory` on a worker now. Until endShaderSourcePrefetch(),
+// readShaderSource() serves those files from memory, so the many variants compiled at startup do not go back
+// to the disk; a file the worker has not read yet is read directly (no waiting on a busy pool). After it,
+// files are read again (hot reload must see edits).
+void prefetchShaderSources(const char* directory);
+void endShaderSourcePrefetch();
+
+// Put #define lines right after the #version line (variants); a #line directive keeps error line numbers
+// pointing at the file.
+std::string insertShaderDefines(const std::string& code, const std::string& defines);
+
+struct ShaderCacheStats {
+    int    requests = 0;       // acquire calls
+    int    shared = 0;         // served by an already live program (dedup)
+    int    fromBinary = 0;     // restored with glProgramBinary
+    int    compiled = 0;       // compiled + linked from source
+    int    binaryRejected = 0; // binaries that existed but did not load
+    double totalMs = 0.0;      // time spent creating programs
+};
+const ShaderCacheStats& shaderCacheStats();
+
+// Delete every program still held (at exit).
+void shutdownShaderCache();
@@ -0,0 +1,26 @@
+#pragma once
+#include <functional>
+#include <string>
+
+// Shader hot reload (for tuning map3d.frag / basic.frag without restarting).
+// A watcher thread polls the modification time of every watched GLSL file. When one changes (and has
+// stopped changing for one poll, so half-saved files are skipped) the thread re-reads and preprocesses
+// the vertex + fragment pair. applyShaderReloads(), called by the main loop between frames, then compiles
+// and links the new source through the program cache and swaps it into the registered slot. If
+// compilation or linking fails the error is logged and the slot keeps its last good program.
+
+// Start / stop the watcher thread. pollMs = how often the files are checked.
+void startShaderWatcher(int pollMs = 250);
+void stopShaderWatcher();
+
+// Register a program slot that should follow its source files. *program must stay valid until
+// unwatchShaderProgram() / stopShaderWatcher(). onReload (optional) runs on the main thread right after
+// the swap, with the new program bound nowhere - re-fetch cached uniform locations / block bindings there.
+// defines = variant #defines inserted into both stages (see insertShaderDefines).
+void watchShaderProgram(unsigned* program, const char* vertexPath, const char* fragmentPath,
+                        std::function<void(unsigned)> onReload = nullptr, const std::string& defines = std::string());
+void unwatchShaderProgram(unsigned* program);
+
+// Main thread, between frames. Returns the number of programs swapped. Costs one atomic load when
+// nothing changed.
+int applyShaderReloads();
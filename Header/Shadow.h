@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+#include "SceneState.h"
+#include "shader.hpp"
+
+// Directional shadow map for the avatar on the map plane.
+// The light frustum is an orthographic box fitted around the caster bounds: the casters are a few metres
+// across, so a single map already gives sharp contact shadows and no cascades are needed. The map is only
+// redrawn when something it depends on changed (caster transform / pose / LOD, light direction, map size);
+// otherwise last frame's map is sampled again. Casters are only rendered when they pass the view frustum
+// test. RenderSettings::shadowMapSize / shadowPcfRadius set the resolution / filtering budget.
+
+// texture unit map3d.frag samples the map from (the light tile buffers use 4..6)
+#define SHADOW_MAP_UNIT 3
+#define SHADOW_MAX_PCF_RADIUS 2
+
+// Everything about the casters that changes what the map contains.
+struct ShadowCasterKey {
+    glm::mat4 model = glm::mat4(1.0f);
+    float     poseTime = 0.0f;   // animator time; stands still when the avatar does
+    int       lod = 0;
+};
+
+struct ShadowStats {
+    int    renders = 0;          // maps drawn since start
+    int    reused = 0;           // frames that sampled an unchanged map
+    double lastRenderMs = 0.0;   // CPU time of the last caster pass
+};
+
+void initShadows(const RenderSettings& settings);
+void shutdownShadows();
+
+// Start of frame: shadows are off until a caster pass runs (or reuses the map) this frame.
+void beginShadowFrame();
+
+// Fit the light frustum to the casters and check the key. Returns true if the map must be redrawn: the
+// shadow FBO is bound and shadowCasterShader() is set up with the light matrices, draw the casters with it
+// and call endShadowPass(). false = the previous map is still valid (it is used as is).
+bool beginShadowPass(const glm::vec3& lightDir, const Bounds& casterBounds, const ShadowCasterKey& key,
+                     const RenderSettings& settings);
+void endShadowPass(int viewportW, int viewportH);
+
+// basic.vert + depth-only fragment shader (variants like the model shader: SKINNED, ...)
+Shader& shadowCasterShader();
+
+// true if this frame has a valid map to sample (casters were visible)
+bool shadowsActive();
+
+// Bind the map to SHADOW_MAP_UNIT and set uShadowMap / uLightVP / uShadowPcf on the bound program.
+void bindShadowMap(unsigned program, const RenderSettings& settings);
+
+const ShadowStats& shadowStats();
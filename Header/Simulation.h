@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "SceneState.h"
+
+struct GLFWwindow;
+class NavGrid;
+class RouteTrack;
+
+// Fixed-timestep simulation on its own thread.
+// The walking camera, the avatar (position, facing, distance walked) and the 2D walk sprite are stepped at
+// SIM_STEP_SECONDS, independent of the frame rate. Every frame the main thread polls the movement keys
+// (GLFW must stay on the main thread) and hands them over together with the frame dt; the thread consumes
+// the frames in order, so the same dt / key sequence always gives the same steps (input replay stays exact).
+// After each frame's steps it publishes the last two states + how far the frame got into the next step; the
+// renderer blends them, so motion stays smooth when the frame rate and the step rate do not line up.
+//
+// Input between frames: while the main thread waits in the frame limiter it keeps sampling the movement keys
+// and the gamepad at SIM_INPUT_SAMPLE_HZ (sampleSimInput). The samples go with the next frame and every step
+// takes the sample from the middle of its own time span, so a tap shorter than a frame still moves the avatar
+// for the steps it was held, whatever the render rate. Only live: a recorded / replayed session uses the one
+// poll per frame that is in the log. The gamepad's left stick moves the avatar (analog: half tilt, half
+// speed), its right stick turns the camera (integrated over the samples), the d-pad counts as the arrow keys.
+//
+// Autopilot: given a RouteTrack the avatar walks it at SimInput::autopilotSpeed (arc length advances by
+// speed * step, the position is a track lookup) and the distance counts as walked. It ends at the last point
+// or as soon as a WASD key is held / the left stick is pushed; the route itself is not checked against the navigation grid.
+//
+// Overview mode and camera paths (CameraPath.h) pause the movement (time still runs, the state holds). The overview camera and the
+// measurement points are placed by callbacks and stay on the main thread.
+
+#define SIM_STEP_SECONDS (1.0f / 120.0f)
+#define SIM_MAX_FRAME_SECONDS 0.25f   // longer frames (breakpoints, window drags) are cut, no catch-up burst
+#define SIM_INPUT_SAMPLE_HZ 1000.0     // input sampling between frames
+#define GAMEPAD_LOOK_DEG_PER_SEC 150.0f // right stick fully over
+
+enum SimKey : uint16_t {
+    SIM_KEY_W = 1 << 0,
+    SIM_KEY_A = 1 << 1,
+    SIM_KEY_S = 1 << 2,
+    SIM_KEY_D = 1 << 3,
+    SIM_KEY_UP = 1 << 4,
+    SIM_KEY_DOWN = 1 << 5,
+    SIM_KEY_LEFT = 1 << 6,
+    SIM_KEY_RIGHT = 1 << 7
+};
+
+struct SimInput {
+    uint16_t keys = 0;         // SimKey bits
+    glm::vec2 move{ 0.0f };    // analog (left stick): x right, y forward; added to WASD
+    bool paused = false;       // overview / camera path: nothing moves
+    float cameraYaw = 0.0f;    // mouse look stays on the main thread, movement follows it
+    float cameraY = 0.0f;      // walking eye height (scroll)
+    float autopilotSpeed = 2.0f; // world units / s while following a route
+};
+
+struct SimSnapshot {
+    glm::vec3 cameraPos{ 0.0f };
+    glm::vec3 avatarPos{ 0.0f };
+    float avatarYawDeg = 0.0f;
+    float avatarSpeed = 0.0f;  // world units / s over the last step (drives the walk cycle)
+    float avatarMeters = 0.0f; // distance walked
+    int spriteState = 0;       // 2D walk sprite: 0 idle, 1 right, 2 left, 3 up, 4 down
+    int spriteFrame = 0;
+    float spriteTimer = 0.0f;
+    bool autopilot = false;    // following a route
+    float autopilotProgress = 0.0f; // 0..1 along it
+};
+
+// Starts from the scene's current camera / avatar. nav: the avatar collides with its blocked cells
+// (NavGrid.h; nullptr = only clamped to the plane).
+void startSimulation(const SceneState& scene, const NavGrid* nav);
+void stopSimulation();
+
+// Main thread, once per frame: poll the movement keys / sticks into a SimInput (camera yaw / height from
+// view). The right stick turns the view's camera here (dt: this frame's, used when there are no samples).
+SimInput pollSimInput(GLFWwindow* window, ViewState& view, float dt);
+
+// Main thread, between frames (frame limiter): pump events and sample the input again if
+// 1 / SIM_INPUT_SAMPLE_HZ has passed. Does nothing unless the session is live.
+void sampleSimInput(GLFWwindow* window);
+
+struct SimInputStats {
+    bool gamepad = false;       // a gamepad is connected
+    int  samplesLastFrame = 0;  // sub-frame samples handed over with the last frame
+};
+const SimInputStats& simInputStats();
+
+// Follow this route from the next handed-over frame on (nullptr stops). The track is shared with the
+// simulation thread, which keeps it alive while it walks.
+void setSimAutopilot(std::shared_ptr<const RouteTrack> track);
+
+// Hand over one frame: dt seconds of simulation with this input. Returns immediately.
+void advanceSimulation(float dt, const SimInput& input);
+
+// Interpolated state of the last finished frame. wait = block until every handed-over frame is stepped
+// (a replay does, so its frames are reproducible; live rendering takes what is ready).
+SimSnapshot sampleSimulation(bool wait);
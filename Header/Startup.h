@@ -0,0 +1,99 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <utility>
+
+#include "ThreadPool.h"
+
+// Startup profiler + init scheduling.
+// beginStartup() at the top of main() starts the clock, finishStartup() after the first swap stops it and
+// prints every phase (start, duration, thread) and the time to first frame; with a trace path it also writes
+// the phases as a Chrome trace, one row per thread.
+//
+// STARTUP_PHASE("name") times the enclosing block on whichever thread runs it. Phases should not nest (the
+// summary adds up the worker phases). startupAsync() runs a CPU-only job (file reads, image decode, model
+// import, mesh generation) on the worker pool as its own phase and returns its future; startupWait() takes the
+// result on the GL thread right where it is uploaded, and records the wait, so the summary shows where the GL
+// thread still stalls on a worker.
+// Outside startup (after finishStartup) phases are not recorded and cost a clock read.
+// Names must outlive the startup (string literals).
+//
+// Before / after: --serial-startup runs the same jobs inline on the GL thread, one after another, as before the
+// scheduler (startupAsync runs the job on the spot, the shader sources are not prefetched), and writes its time
+// to first frame to STARTUP_BASELINE_PATH. A normal run sets its own time to first frame against that file.
+// Both leave out the GL thread's phases marked extra (work the old startup did not do: the wait for the nav
+// grid), so adding background work does not move the figure. --startup-check exits after the first frame and
+// fails when the ratio to the baseline is under STARTUP_TARGET_SPEEDUP, or there is no baseline; run both warm
+// (texture and shader caches already written).
+
+#define STARTUP_TARGET_SPEEDUP 2.0
+#define STARTUP_BASELINE_PATH "startup_baseline.txt"
+
+struct StartupReport {
+    bool serial = false;
+    double firstFrameMs = 0.0;
+    double extraMs = 0.0;      // GL thread time in extra phases, left out of the comparison
+    double baselineMs = 0.0;   // the --serial-startup run's time; 0 if there is none
+    double comparedMs() const { return firstFrameMs - extraMs; }
+    double speedup() const { return baselineMs > 0.0 && comparedMs() > 0.0 ? baselineMs / comparedMs() : 0.0; }
+};
+
+// Before beginStartup's jobs are queued: run them inline (the baseline) instead of on the workers.
+void setSerialStartup(bool serial);
+bool serialStartup();
+
+void beginStartup();
+// Prints the summary (and writes the trace), writes or reads the baseline; an empty report if startup was
+// already finished.
+StartupReport finishStartup(const char* tracePath = nullptr);
+bool startupActive();
+
+// ms since beginStartup; with recordStartupPhase, a phase that is not a C++ scope (startMs = clock at its start)
+double startupClockMs();
+void recordStartupPhase(const char* name, double startMs, bool wait, bool extra = false);
+
+class StartupPhase {
+public:
+    explicit StartupPhase(const char* name, bool wait = false, bool extra = false) : name(name), wait(wait), extra(extra), startMs(startupClockMs()) {}
+    ~StartupPhase() { recordStartupPhase(name, startMs, wait, extra); }
+    StartupPhase(const StartupPhase&) = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+
+private:
+    const char* name;
+    bool wait;
+    bool extra;
+    double startMs;
+};
+
+#define STARTUP_CONCAT_INNER(a, b) a##b
+#define STARTUP_CONCAT(a, b) STARTUP_CONCAT_INNER(a, b)
+#define STARTUP_PHASE(name) StartupPhase STARTUP_CONCAT(startupPhase_, __LINE__)(name)
+
+template <typename F>
+auto startupAsync(const char* name, F job) -> std::future<decltype(job())>
+{
+    using Result = decltype(job());
+    auto task = std::make_shared<std::packaged_task<Result()>>([name, job]() mutable {
+        StartupPhase phase(name);
+        return job();
+    });
+    std::future<Result> result = task->get_future();
+    if (serialStartup()) {
+        (*task)();
+        return result;
+    }
+    workerPool().submit([task] { (*task)(); });
+    return result;
+}
+
+template <typename T>
+T startupWait(const char* name, std::future<T>& result)
+{
+    {
+        StartupPhase phase(name, true);
+        result.wait();
+    }
+    return result.get();
+}
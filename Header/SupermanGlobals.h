@@ -1,11 +1,9 @@
 #pragma once
 #include <glm/glm.hpp>
 
-extern float supermanMeters;
+// Avatar tuning (its position / facing / distance are in SceneState::avatar)
 extern float METERS_PER_WORLD_UNIT;
 
-extern glm::vec3 supermanPos;
-extern float supermanYawDeg;            // facing direction in degrees 
 extern const float supermanMoveSpeed;
 extern const float supermanTurnSpeed;
 
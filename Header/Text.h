@@ -2,7 +2,11 @@
 
 // Simple in-canvas text rendering using stb_easy_font.
 // initText() must be called after an OpenGL context is ready.
-// drawText draws at pixel coordinates where (0,0) is top-left.
+// drawText draws at pixel coordinates where (0,0) is top-left; scale multiplies the stb_easy_font glyphs.
+// The debug HUD lines (F5 stats, profiler) use the small HUD_TEXT_SCALE, HUD_LINE_HEIGHT apart.
+#define HUD_TEXT_SCALE 2.0f
+#define HUD_LINE_HEIGHT 32.0f
+
 void initText();
-void drawText(const char* text, float xPx, float yPx, float r, float g, float b);
+void drawText(const char* text, float xPx, float yPx, float r, float g, float b, float scale = 6.0f);
 void cleanupText();
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Compressed texture cache (KTX2 containers holding BCn/ETC2 blocks and a prebuilt mip chain).
+// The first time an image is requested it is decoded with stb_image, its mip chain is built on the CPU,
+// every level is encoded to a block-compressed format by the driver and the result is written to
+// Resources/cache/<name>.ktx2. Later runs upload the cached levels directly: no image decode and no
+// glGenerateMipmap at startup. When no block format is available the texture falls back to RGBA8.
+
+// Directory the KTX2 files are written to (created on demand).
+extern const char* TEXTURE_CACHE_DIR;
+
+// Load an image file through the cache. flipVertically matches loadImageToTexture() (true) or the model loader (false).
+// Returns the GL texture name, 0 on failure. The texture is left unbound.
+unsigned loadTextureCached(const char* filePath, bool flipVertically = true);
+
+// Same as loadTextureCached but for encoded image bytes already in memory (embedded GLB textures).
+// cacheKey names the cache entry; a hash of the bytes is appended so a changed asset never hits a stale file.
+unsigned loadTextureCachedFromMemory(const unsigned char* bytes, int byteCount, const std::string& cacheKey, bool flipVertically = false);
+
+// Same as above for raw, already decoded RGBA8 pixels.
+unsigned loadTextureCachedFromPixels(const unsigned char* rgba, int width, int height, const std::string& cacheKey);
+
+// Upload a KTX2 file directly (all mip levels). Returns 0 if the file is missing, malformed or its format is unsupported here.
+unsigned loadKTX2Texture(const char* ktxPath);
+
+// The loaders above in two halves, for loading on a worker thread while the GL thread does other work.
+// readTextureSource*() is the CPU half and makes no GL calls: it reads the fresh KTX2 cache file, or decodes
+// the image on a miss. uploadTextureSource() is the GL half: it uploads the levels, or transcodes and
+// writes the cache entry. If the driver rejects a cached format, it decodes the original as a fallback.
+// loadTextureCached(path, flip) is uploadTextureSource(readTextureSource(path, flip)).
+struct TextureSource {
+    std::string label;                  // path / cache key, for log messages
+    std::string cachePath;
+    std::vector<unsigned char> ktx2;    // cache hit: the whole file
+    std::vector<unsigned char> rgba;    // decoded pixels (cache miss, or raw pixels kept for the fallback)
+    int width = 0, height = 0;
+    std::string filePath;               // what the fallback decodes: the file, or
+    std::vector<unsigned char> encoded; // the encoded bytes of a memory asset
+    bool flipVertically = false;
+};
+TextureSource readTextureSource(const char* filePath, bool flipVertically = true);
+TextureSource readTextureSourceFromMemory(const unsigned char* bytes, int byteCount, const std::string& cacheKey, bool flipVertically = false);
+TextureSource readTextureSourceFromPixels(const unsigned char* rgba, int width, int height, const std::string& cacheKey);
+unsigned uploadTextureSource(TextureSource& source);
+// CPU half: decode the original into rgba (a cache hit has none; for a caller that needs the pixels too).
+bool decodeTextureSource(TextureSource& source);
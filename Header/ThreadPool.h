@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed-size worker pool for data-parallel CPU loops (crowd update, culling, ...).
+// parallelFor splits [0, count) into chunks of at most `grain` items; the calling thread
+// works on chunks too and the call returns when every chunk is done.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned workerCount = 0); // 0 -> hardware_concurrency - 1
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body);
+
+    // Run a single task on a worker (fire and forget). Used for background jobs.
+    void submit(std::function<void()> task);
+
+    unsigned workerCount() const { return (unsigned)workers.size(); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::function<void()>> queue;
+    bool quit = false;
+};
+
+// Process-wide pool, created on first use.
+ThreadPool& workerPool();
@@ -9,11 +9,24 @@
 #include <vector>
 
 #include "shader.hpp"
+#include "Culling.h"
+
+#define MAX_BONE_INFLUENCE 4
 
 struct Vertex {
     glm::vec3 Position;
     glm::vec3 Normal;
     glm::vec2 TexCoords;
+    // skinning: palette indices (-1 = unused slot) and their weights
+    int   BoneIDs[MAX_BONE_INFLUENCE];
+    float Weights[MAX_BONE_INFLUENCE];
+};
+
+// One level of detail: a range of the mesh's index buffer (all levels share the vertex buffer).
+struct MeshLod {
+    unsigned int indexOffset;
+    unsigned int indexCount;
+    float        error;   // simplification error relative to the mesh bounds (0 for the full mesh)
 };
 
 struct Texture {
@@ -26,19 +39,37 @@ class Mesh {
 public:
     // mesh data
     std::vector<Vertex>       vertices;
-    std::vector<unsigned int> indices;
+    std::vector<unsigned int> indices;   // every LOD level back to back, level 0 first
+    std::vector<MeshLod>      lods;      // at least one entry (level 0 = full mesh)
     std::vector<Texture>      textures;
-    unsigned int              VAO;
+    unsigned int              VAO = 0;
     glm::vec3                 diffuseColor; // fallback material color
+    Bounds                    bounds;       // bind-pose bounds in mesh space (for culling)
+
+    // lods empty = a single level spanning all indices. uploadNow = false leaves the GL buffers to upload()
+    // (the mesh can then be built on a worker thread).
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+         const glm::vec3& diffuseColor = glm::vec3(1.0f), std::vector<MeshLod> lods = std::vector<MeshLod>(), bool uploadNow = true);
+
+    // Create the VAO / buffers if they do not exist yet (GL thread).
+    void upload();
+    // Delete the VAO / buffers (GL thread). Copies of a Mesh share them, so this is explicit, not a destructor.
+    void release();
+
+    void Draw(Shader& shader, int lod = 0);
 
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, const glm::vec3& diffuseColor = glm::vec3(1.0f));
+    // Draw instanceCount copies; instanceVBO holds one vec4 per instance (attribute 5, see crowd.vert).
+    void DrawInstanced(Shader& shader, unsigned int instanceVBO, int instanceCount, int lod = 0);
 
-    void Draw(Shader& shader);
+    int lodCount() const { return (int)lods.size(); }
 
 private:
-    unsigned int VBO, EBO;
+    unsigned int VBO = 0, EBO = 0;
+    unsigned int boundInstanceVBO = 0; // instance buffer currently wired into the VAO
 
     void setupMesh();
+    void bindMaterial(Shader& shader);
+    const MeshLod& lodRange(int lod) const;
 };
 
 #endif
\ No newline at end of file
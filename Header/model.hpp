@@ -15,14 +15,28 @@
 
 #include "mesh.hpp"
 #include "shader.hpp"
+#include "TextureCache.h"
+#include "Animation.h"
+#include "MeshLod.h"
 
+#include <algorithm>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <map>
 
 unsigned int TextureFromFile(const char* path, const std::string& directory, bool gamma = false);
+unsigned int TextureFromEmbedded(const aiTexture* texture, const std::string& cacheKey);
+// the two above in halves: read / decode (any thread), then upload + sampler state (GL thread)
+TextureSource TextureSourceFromFile(const char* path, const std::string& directory);
+TextureSource TextureSourceFromEmbedded(const aiTexture* texture, const std::string& cacheKey);
+unsigned int TextureFromSource(TextureSource& source);
+
+// Deferred: the constructor imports (Assimp, LOD chains, skeleton, texture decode) without a GL call, so it
+// can run on a worker thread; upload() then creates the mesh buffers and textures on the GL thread.
+enum class ModelLoad { Immediate, Deferred };
 
 class Model
 {
@@ -31,19 +45,62 @@ public:
     std::vector<Texture> textures_loaded;	// stores all the textures loaded so far
     std::vector<Mesh>    meshes;
     std::string directory;
+    std::string sourcePath;  // file the model was loaded from (also keys its cached textures)
+    Bounds bounds;           // union of the mesh bounds (bind pose, model space)
     bool gammaCorrection;
 
+    // skinning / animation data (empty for static models)
+    std::map<std::string, BoneInfo> boneInfoMap;
+    int boneCounter = 0;
+    Skeleton skeleton;
+    std::vector<AnimationClip> animations;
+
+    bool hasSkeleton() const { return boneCounter > 0; }
+
     // constructor, expects a filepath to a 3D model.
     Model(const std::string& path, bool gamma = false) : gammaCorrection(gamma)
     {
         loadModel(path);
     }
 
-    // draws the model, and thus all its meshes
-    void Draw(Shader& shader)
+    Model(const std::string& path, ModelLoad load, bool gamma = false) : gammaCorrection(gamma), deferred(load == ModelLoad::Deferred)
     {
-        for (unsigned int i = 0; i < meshes.size(); i++)
-            meshes[i].Draw(shader);
+        loadModel(path);
+    }
+
+    // GL half of a deferred load (no-op once done)
+    void upload()
+    {
+        for (Mesh& mesh : meshes) mesh.upload();
+        for (PendingTexture& pending : pendingTextures)
+        {
+            const unsigned int id = TextureFromSource(pending.source);
+            for (Texture& t : textures_loaded)
+                if (t.path == pending.path) t.id = id;
+            for (Mesh& mesh : meshes)
+                for (Texture& t : mesh.textures)
+                    if (t.path == pending.path) t.id = id;
+        }
+        pendingTextures.clear();
+        deferred = false;
+    }
+
+    // draws the model, and thus all its meshes (lod clamps per mesh, 0 = full detail); textured meshes
+    // first, then the plain-colour ones, so the shader switches variant (USE_TEX) at most once per draw
+    void Draw(Shader& shader, int lod = 0)
+    {
+        for (Mesh& mesh : meshes)
+            if (!mesh.textures.empty()) mesh.Draw(shader, lod);
+        for (Mesh& mesh : meshes)
+            if (mesh.textures.empty()) mesh.Draw(shader, lod);
+    }
+
+    // number of LOD levels of the most detailed chain (meshes with fewer levels clamp)
+    int lodCount() const
+    {
+        int count = 1;
+        for (const Mesh& mesh : meshes) count = std::max(count, mesh.lodCount());
+        return count;
     }
 
 private:
@@ -51,7 +108,7 @@ private:
     void loadModel(const std::string& path)
     {
         Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_LimitBoneWeights);
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         {
             std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
@@ -59,9 +116,60 @@ private:
         }
         // retrieve the directory path of the filepath
         directory = path.substr(0, path.find_last_of('/'));
+        sourcePath = path;
+
+        // LOD chains come from the model cache when it is newer than the file, otherwise they are built here
+        lodCacheValid = loadLodCache(path, lodChains);
+        lodChainsBuilt = false;
+        if (!lodCacheValid) lodChains.clear();
 
         // process ASSIMP's root node recursively
         processNode(scene->mRootNode, scene);
+
+        if (lodChainsBuilt) {
+            lodChains.resize(meshes.size());
+            saveLodCache(path, lodChains);
+        }
+        lodChains.clear();
+
+        for (unsigned int i = 0; i < meshes.size(); i++)
+            bounds = i == 0 ? meshes[i].bounds : mergeBounds(bounds, meshes[i].bounds);
+
+        // node hierarchy + clips are copied out so playback does not need the aiScene
+        buildSkeleton(scene, boneInfoMap, skeleton);
+        importAnimations(scene, skeleton, animations);
+    }
+
+    // deferred load: textures decoded but not uploaded yet (ids are patched in by upload())
+    struct PendingTexture {
+        std::string path;
+        TextureSource source;
+    };
+    bool deferred = false;
+    std::vector<PendingTexture> pendingTextures;
+
+    // LOD chain bookkeeping while importing (one chain per mesh, in processNode order)
+    std::vector<MeshLodChain> lodChains;
+    bool lodCacheValid = false;
+    bool lodChainsBuilt = false;
+
+    // cached chain for mesh #meshIndex if it still matches the imported data, else a freshly simplified one
+    MeshLodChain lodChainFor(size_t meshIndex, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+    {
+        if (lodCacheValid && meshIndex < lodChains.size()) {
+            const MeshLodChain& cached = lodChains[meshIndex];
+            bool matches = !cached.lods.empty() && cached.lods[0].indexOffset == 0 && cached.lods[0].indexCount == indices.size();
+            for (size_t i = 0; matches && i < cached.indices.size(); i++)
+                matches = cached.indices[i] < vertices.size();
+            if (matches) return cached;
+        }
+        // cache unusable from here on: rebuild every remaining mesh and rewrite the file
+        lodCacheValid = false;
+        lodChainsBuilt = true;
+        MeshLodChain chain = buildLodChain(vertices, indices);
+        if (lodChains.size() <= meshIndex) lodChains.resize(meshIndex + 1);
+        lodChains[meshIndex] = chain;
+        return chain;
     }
 
     // processes a node in a recursive fashion.
@@ -116,6 +224,13 @@ private:
             else
                 vertex.TexCoords = glm::vec2(0.0f, 0.0f);
 
+            // no bone influences until extractBoneWeights fills them
+            for (int b = 0; b < MAX_BONE_INFLUENCE; b++)
+            {
+                vertex.BoneIDs[b] = -1;
+                vertex.Weights[b] = 0.0f;
+            }
+
             vertices.push_back(vertex);
         }
         // indices
@@ -125,6 +240,10 @@ private:
             for (unsigned int j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);
         }
+        // bone weights (palette indices are shared across all meshes of the model)
+        if (mesh->HasBones())
+            extractBoneWeights(vertices, mesh, boneInfoMap, boneCounter);
+
         // material
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
@@ -136,17 +255,20 @@ private:
         glm::vec3 matDiffuse(diffColor.r, diffColor.g, diffColor.b);
 
         // load diffuse maps (shader expects sampler names like "uDiffMap1", "uSpecMap1" etc.)
-        std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "uDiffMap");
+        std::vector<Texture> diffuseMaps = loadMaterialTextures(material, scene, aiTextureType_DIFFUSE, "uDiffMap");
         textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-        std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "uSpecMap");
+        std::vector<Texture> specularMaps = loadMaterialTextures(material, scene, aiTextureType_SPECULAR, "uSpecMap");
         textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
 
+        // simplified levels share the vertex buffer; all levels go into one index buffer
+        MeshLodChain chain = lodChainFor(meshes.size(), vertices, indices);
+
         // return a mesh object created from the extracted mesh data, include material color
-        return Mesh(vertices, indices, textures, matDiffuse);
+        return Mesh(vertices, chain.indices, textures, matDiffuse, chain.lods, !deferred);
     }
 
-    // load textures of a given type
-    std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName)
+    // load textures of a given type (external files or textures embedded in the GLB, both through the KTX2 cache)
+    std::vector<Texture> loadMaterialTextures(aiMaterial* mat, const aiScene* scene, aiTextureType type, const std::string& typeName)
     {
         std::vector<Texture> textures;
         for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
@@ -166,7 +288,18 @@ private:
             if (!skip)
             {
                 Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
+                const aiTexture* embedded = scene->GetEmbeddedTexture(str.C_Str());
+                if (deferred)
+                {
+                    texture.id = 0;
+                    pendingTextures.push_back({ str.C_Str(), embedded ? TextureSourceFromEmbedded(embedded, sourcePath + "_" + str.C_Str())
+                                                                      : TextureSourceFromFile(str.C_Str(), this->directory) });
+                }
+                else
+                {
+                    texture.id = embedded ? TextureFromEmbedded(embedded, sourcePath + "_" + str.C_Str())
+                                          : TextureFromFile(str.C_Str(), this->directory);
+                }
                 texture.type = typeName;
                 texture.path = str.C_Str();
                 textures.push_back(texture);
@@ -178,43 +311,59 @@ private:
 };
 
 
-unsigned int TextureFromFile(const char* path, const std::string& directory, bool gamma)
+unsigned int TextureFromFile(const char* path, const std::string& directory, bool /*gamma*/)
 {
-    std::string filename = std::string(path);
-    filename = directory + '/' + filename;
+    TextureSource source = TextureSourceFromFile(path, directory);
+    return TextureFromSource(source);
+}
+
+unsigned int TextureFromEmbedded(const aiTexture* texture, const std::string& cacheKey)
+{
+    TextureSource source = TextureSourceFromEmbedded(texture, cacheKey);
+    return TextureFromSource(source);
+}
+
+TextureSource TextureSourceFromFile(const char* path, const std::string& directory)
+{
+    // decoded, mip-mapped and block-compressed once, then uploaded straight from Resources/cache
+    std::string filename = directory + '/' + std::string(path);
+    return readTextureSource(filename.c_str(), false);
+}
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+// GLB files carry their textures inside the binary chunk ("*0", "*1", ...).
+// mHeight == 0 means mWidth bytes of an encoded image (png/jpg), otherwise raw BGRA texels.
+TextureSource TextureSourceFromEmbedded(const aiTexture* texture, const std::string& cacheKey)
+{
+    if (texture->mHeight == 0)
+        return readTextureSourceFromMemory(reinterpret_cast<const unsigned char*>(texture->pcData), (int)texture->mWidth, cacheKey, false);
 
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
+    std::vector<unsigned char> rgba((size_t)texture->mWidth * texture->mHeight * 4);
+    for (size_t i = 0; i < (size_t)texture->mWidth * texture->mHeight; i++)
     {
-        GLenum format = GL_RGB;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
+        rgba[i * 4 + 0] = texture->pcData[i].r;
+        rgba[i * 4 + 1] = texture->pcData[i].g;
+        rgba[i * 4 + 2] = texture->pcData[i].b;
+        rgba[i * 4 + 3] = texture->pcData[i].a;
     }
-    else
+    return readTextureSourceFromPixels(rgba.data(), (int)texture->mWidth, (int)texture->mHeight, cacheKey);
+}
+
+unsigned int TextureFromSource(TextureSource& source)
+{
+    unsigned int textureID = uploadTextureSource(source);
+    if (!textureID)
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        std::cout << "Texture failed to load: " << source.label << std::endl;
+        return 0;
     }
 
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
     return textureID;
 }
 
@@ -5,22 +5,93 @@
 
 #include <glm/glm.hpp>
 
+#include <functional>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compile-time feature switches. Each feature set a Shader is used with gets its own program, compiled
+// from the same files with the matching #defines, so the GLSL uses #ifdef instead of branching on uniforms.
+enum ShaderFeature : unsigned {
+    SHADER_USE_TEX           = 1u << 0, // basic.frag: diffuse texture instead of uMatColor
+    SHADER_SKINNED           = 1u << 1, // basic.vert / crowd.vert: apply the bone palette
+    SHADER_LIGHT_DIRECTIONAL = 1u << 2, // map3d.frag: sun light instead of the point light
+    SHADER_FLIP_X            = 1u << 3, // map3d.vert: mirror U
+    SHADER_TILED_LIGHTS      = 1u << 4, // map3d.frag: add the lights of this screen tile (Lighting.h)
+    SHADER_SHADOWS           = 1u << 5, // map3d.frag: sun light is shadowed by the avatar (Shadow.h)
+    SHADER_HQ_FILTER         = 1u << 6, // bloom passes: wide 13-tap / tent filters instead of 4 taps (PostProcess.h)
+};
+
+// "#define USE_TEX\n#define SKINNED\n..." for a feature mask
+std::string shaderFeatureDefines(unsigned features);
 
 class Shader
 {
 public:
-    unsigned int ID;
+    unsigned int ID = 0; // program of the active variant
 
     Shader() = default;
     Shader(const char* vertexPath, const char* fragmentPath);
+    ~Shader();
+    // variant slots are registered for hot reload by address
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
 
     void use();
+
+    // Switch to the variant for this feature set (compiled on first use, then cached) and bind it.
+    // Uniforms set through the set* functions below are carried over to the new program: each variant keeps
+    // its uniform locations and which value it last received, so a switch uploads only what changed since.
+    void setFeatures(unsigned features);
+    void setFeature(ShaderFeature feature, bool enabled);
+    unsigned features() const { return activeFeatures; }
+    // Build a variant ahead of time (at load, so the first frame that needs it does not stall).
+    void prepareFeatures(unsigned features) { variant(features); }
+
+    // Runs for every program this shader creates (variants, hot reloads) and for the ones it already has;
+    // e.g. bindBoneBlock.
+    void onProgramCreated(std::function<void(unsigned)> callback);
+
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
     void setFloat(const std::string& name, float value) const;
     void setVec3(const std::string& name, float x, float y, float z) const;
+    void setMat3(const std::string& name, const glm::mat3& mat) const;
     void setMat4(const std::string& name, const glm::mat4& mat) const;
+
+private:
+    enum UniformType { UNIFORM_INT, UNIFORM_FLOAT, UNIFORM_VEC3, UNIFORM_MAT3, UNIFORM_MAT4 };
+    struct UniformValue {
+        std::string name;
+        UniformType type = UNIFORM_INT;
+        int i = 0;
+        float f[16] = {};
+        unsigned version = 0; // bumped by every set
+    };
+    // what one variant's program holds; reset when hot reload replaces the program
+    struct VariantUniforms {
+        unsigned program = 0;
+        std::vector<GLint> locations;   // per uniform index, -2 = not looked up yet
+        std::vector<unsigned> applied;  // version of each uniform in the program, 0 = never written
+    };
+
+    unsigned variant(unsigned features);
+    size_t uniformSlot(const std::string& name, UniformType type) const; // index in uniforms, version bumped
+    VariantUniforms& activeUniforms() const;
+    void applyUniform(VariantUniforms& state, size_t index) const;
+    void replayUniforms() const;
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    unsigned activeFeatures = 0;
+    std::unordered_map<unsigned, unsigned> variants; // feature mask -> program (0 = failed to build)
+    std::function<void(unsigned)> programCallback;
+    // last value written to each uniform, replayed when the variant changes
+    mutable std::vector<UniformValue> uniforms;
+    mutable std::unordered_map<std::string, size_t> uniformIndex;
+    mutable std::unordered_map<unsigned, VariantUniforms> variantUniforms; // by feature mask
+    mutable VariantUniforms* active = nullptr;
+    mutable unsigned uniformVersion = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,348 @@
+#include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <assimp/scene.h>
+
+#include "../Header/Animation.h"
+
+static unsigned boneUBO = 0;
+
+// assimp matrices are row-major, glm is column-major
+static glm::mat4 toGlm(const aiMatrix4x4& m)
+{
+    glm::mat4 r;
+    r[0][0] = m.a1; r[1][0] = m.a2; r[2][0] = m.a3; r[3][0] = m.a4;
+    r[0][1] = m.b1; r[1][1] = m.b2; r[2][1] = m.b3; r[3][1] = m.b4;
+    r[0][2] = m.c1; r[1][2] = m.c2; r[2][2] = m.c3; r[3][2] = m.c4;
+    r[0][3] = m.d1; r[1][3] = m.d2; r[2][3] = m.d3; r[3][3] = m.d4;
+    return r;
+}
+
+// ---------------------------------------------------------------------------------------------
+// import
+// ---------------------------------------------------------------------------------------------
+
+void extractBoneWeights(std::vector<Vertex>& vertices, const aiMesh* mesh, std::map<std::string, BoneInfo>& boneInfoMap, int& boneCounter)
+{
+    for (unsigned b = 0; b < mesh->mNumBones; ++b) {
+        const aiBone* bone = mesh->mBones[b];
+        std::string name = bone->mName.C_Str();
+
+        int boneId;
+        auto it = boneInfoMap.find(name);
+        if (it == boneInfoMap.end()) {
+            if (boneCounter >= MAX_BONES) {
+                std::cout << "Animation: bone limit (" << MAX_BONES << ") reached, ignoring " << name << std::endl;
+                continue;
+            }
+            BoneInfo info;
+            info.id = boneCounter++;
+            info.offset = toGlm(bone->mOffsetMatrix);
+            boneInfoMap[name] = info;
+            boneId = info.id;
+        } else {
+            boneId = it->second.id;
+        }
+
+        for (unsigned w = 0; w < bone->mNumWeights; ++w) {
+            unsigned vertexId = bone->mWeights[w].mVertexId;
+            float weight = bone->mWeights[w].mWeight;
+            if (vertexId >= vertices.size() || weight <= 0.0f) continue;
+
+            // fill a free slot, otherwise replace the weakest influence if this one is stronger
+            Vertex& v = vertices[vertexId];
+            int slot = -1;
+            for (int i = 0; i < MAX_BONE_INFLUENCE; ++i) {
+                if (v.BoneIDs[i] < 0) { slot = i; break; }
+            }
+            if (slot < 0) {
+                int weakest = 0;
+                for (int i = 1; i < MAX_BONE_INFLUENCE; ++i)
+                    if (v.Weights[i] < v.Weights[weakest]) weakest = i;
+                if (v.Weights[weakest] < weight) slot = weakest;
+            }
+            if (slot >= 0) {
+                v.BoneIDs[slot] = boneId;
+                v.Weights[slot] = weight;
+            }
+        }
+    }
+
+    // renormalize so dropped influences do not shrink the mesh
+    for (Vertex& v : vertices) {
+        float sum = 0.0f;
+        for (int i = 0; i < MAX_BONE_INFLUENCE; ++i) if (v.BoneIDs[i] >= 0) sum += v.Weights[i];
+        if (sum > 0.0f)
+            for (int i = 0; i < MAX_BONE_INFLUENCE; ++i) v.Weights[i] /= sum;
+    }
+}
+
+static void flattenNode(const aiNode* node, int parent, const std::map<std::string, BoneInfo>& boneInfoMap, Skeleton& out)
+{
+    int index = (int)out.names.size();
+    std::string name = node->mName.C_Str();
+    out.names.push_back(name);
+    out.parent.push_back(parent);
+    out.bindLocal.push_back(toGlm(node->mTransformation));
+
+    auto it = boneInfoMap.find(name);
+    out.boneIndex.push_back(it != boneInfoMap.end() ? it->second.id : -1);
+    out.boneOffset.push_back(it != boneInfoMap.end() ? it->second.offset : glm::mat4(1.0f));
+
+    for (unsigned i = 0; i < node->mNumChildren; ++i)
+        flattenNode(node->mChildren[i], index, boneInfoMap, out);
+}
+
+void buildSkeleton(const aiScene* scene, const std::map<std::string, BoneInfo>& boneInfoMap, Skeleton& out)
+{
+    out = Skeleton();
+    if (!scene || !scene->mRootNode) return;
+    flattenNode(scene->mRootNode, -1, boneInfoMap, out);
+    out.globalInverse = glm::inverse(toGlm(scene->mRootNode->mTransformation));
+    out.boneCount = (int)boneInfoMap.size();
+}
+
+void importAnimations(const aiScene* scene, const Skeleton& skeleton, std::vector<AnimationClip>& out)
+{
+    out.clear();
+    if (!scene) return;
+
+    std::map<std::string, int> nodeByName;
+    for (size_t i = 0; i < skeleton.names.size(); ++i) nodeByName[skeleton.names[i]] = (int)i;
+
+    for (unsigned a = 0; a < scene->mNumAnimations; ++a) {
+        const aiAnimation* anim = scene->mAnimations[a];
+        AnimationClip clip;
+        clip.name = anim->mName.C_Str();
+        clip.duration = (float)anim->mDuration;
+        clip.ticksPerSecond = anim->mTicksPerSecond > 0.0 ? (float)anim->mTicksPerSecond : 25.0f;
+        clip.channelOfNode.assign(skeleton.names.size(), -1);
+
+        for (unsigned c = 0; c < anim->mNumChannels; ++c) {
+            const aiNodeAnim* ch = anim->mChannels[c];
+            auto it = nodeByName.find(ch->mNodeName.C_Str());
+            if (it == nodeByName.end()) continue;
+
+            AnimationChannel channel;
+            channel.node = it->second;
+            for (unsigned k = 0; k < ch->mNumPositionKeys; ++k) {
+                const aiVectorKey& key = ch->mPositionKeys[k];
+                channel.positions.push_back({ (float)key.mTime, glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z) });
+            }
+            for (unsigned k = 0; k < ch->mNumRotationKeys; ++k) {
+                const aiQuatKey& key = ch->mRotationKeys[k];
+                channel.rotations.push_back({ (float)key.mTime, glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z) });
+            }
+            for (unsigned k = 0; k < ch->mNumScalingKeys; ++k) {
+                const aiVectorKey& key = ch->mScalingKeys[k];
+                channel.scales.push_back({ (float)key.mTime, glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z) });
+            }
+            clip.channelOfNode[channel.node] = (int)clip.channels.size();
+            clip.channels.push_back(std::move(channel));
+        }
+        std::cout << "Animation: imported clip \"" << clip.name << "\" (" << clip.channels.size() << " channels)" << std::endl;
+        out.push_back(std::move(clip));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// sampling
+// ---------------------------------------------------------------------------------------------
+
+// index of the last key with key.time <= t (keys are sorted by time)
+template <typename Key>
+static size_t findKey(const std::vector<Key>& keys, float t)
+{
+    auto it = std::upper_bound(keys.begin(), keys.end(), t, [](float value, const Key& k) { return value < k.time; });
+    if (it == keys.begin()) return 0;
+    return (size_t)(it - keys.begin()) - 1;
+}
+
+static glm::vec3 sampleVector(const std::vector<VectorKey>& keys, float t, const glm::vec3& fallback)
+{
+    if (keys.empty()) return fallback;
+    if (keys.size() == 1) return keys[0].value;
+    size_t i = findKey(keys, t);
+    if (i + 1 >= keys.size()) return keys.back().value;
+    float span = keys[i + 1].time - keys[i].time;
+    float f = span > 0.0f ? glm::clamp((t - keys[i].time) / span, 0.0f, 1.0f) : 0.0f;
+    return glm::mix(keys[i].value, keys[i + 1].value, f);
+}
+
+static glm::quat sampleRotation(const std::vector<RotationKey>& keys, float t)
+{
+    if (keys.empty()) return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    if (keys.size() == 1) return keys[0].value;
+    size_t i = findKey(keys, t);
+    if (i + 1 >= keys.size()) return keys.back().value;
+    float span = keys[i + 1].time - keys[i].time;
+    float f = span > 0.0f ? glm::clamp((t - keys[i].time) / span, 0.0f, 1.0f) : 0.0f;
+    return glm::normalize(glm::slerp(keys[i].value, keys[i + 1].value, f));
+}
+
+void resetAnimator(Animator& animator, const Skeleton* skeleton, const AnimationClip* clip)
+{
+    animator.skeleton = skeleton;
+    animator.clip = clip;
+    animator.time = 0.0f;
+    animator.front = 0;
+    size_t bones = skeleton ? (size_t)std::max(skeleton->boneCount, 1) : 1;
+    animator.palettes[0].assign(bones, glm::mat4(1.0f));
+    animator.palettes[1].assign(bones, glm::mat4(1.0f));
+    animator.globals.assign(skeleton ? skeleton->names.size() : 0, glm::mat4(1.0f));
+}
+
+void advanceAnimator(Animator& animator, float dt)
+{
+    const Skeleton* sk = animator.skeleton;
+    if (!sk || sk->names.empty()) return;
+
+    const AnimationClip* clip = animator.clip;
+    if (clip && clip->duration > 0.0f) {
+        animator.time += dt * clip->ticksPerSecond * animator.speed;
+        animator.time = std::fmod(animator.time, clip->duration);
+        if (animator.time < 0.0f) animator.time += clip->duration;
+    }
+
+    std::vector<glm::mat4>& globals = animator.globals;
+    std::vector<glm::mat4>& palette = animator.palettes[animator.front ^ 1];
+    const float t = animator.time;
+
+    for (size_t i = 0; i < sk->names.size(); ++i) {
+        glm::mat4 local = sk->bindLocal[i];
+        int channel = clip ? clip->channelOfNode[i] : -1;
+        if (channel >= 0) {
+            const AnimationChannel& ch = clip->channels[channel];
+            glm::vec3 p = sampleVector(ch.positions, t, glm::vec3(0.0f));
+            glm::quat r = sampleRotation(ch.rotations, t);
+            glm::vec3 s = sampleVector(ch.scales, t, glm::vec3(1.0f));
+            local = glm::translate(glm::mat4(1.0f), p) * glm::mat4_cast(r) * glm::scale(glm::mat4(1.0f), s);
+        }
+        // parents come first, so their global transform is already final
+        globals[i] = sk->parent[i] >= 0 ? globals[sk->parent[i]] * local : local;
+
+        int bone = sk->boneIndex[i];
+        if (bone >= 0 && bone < (int)palette.size())
+            palette[bone] = sk->globalInverse * globals[i] * sk->boneOffset[i];
+    }
+}
+
+glm::vec3 skinPosition(const Vertex& v, const std::vector<glm::mat4>& palette)
+{
+    glm::mat4 skin(0.0f);
+    float total = 0.0f;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; ++i) {
+        int id = v.BoneIDs[i];
+        if (id < 0 || id >= (int)palette.size()) continue;
+        skin = skin + palette[id] * v.Weights[i];
+        total += v.Weights[i];
+    }
+    if (total <= 0.0f) return v.Position;
+    return glm::vec3(skin * glm::vec4(v.Position, 1.0f));
+}
+
+// ---------------------------------------------------------------------------------------------
+// worker thread
+// ---------------------------------------------------------------------------------------------
+
+AnimationWorker::~AnimationWorker()
+{
+    stop();
+}
+
+void AnimationWorker::start()
+{
+    if (thread.joinable()) return;
+    quit = false;
+    thread = std::thread(&AnimationWorker::run, this);
+}
+
+void AnimationWorker::stop()
+{
+    if (!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+void AnimationWorker::kick(const std::vector<Animator*>& animators, float dt)
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs = animators;
+        jobDt = dt;
+        pending = true;
+    }
+    cv.notify_all();
+}
+
+void AnimationWorker::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !pending; });
+    // the back buffers are complete: publish them
+    for (Animator* a : jobs) a->front ^= 1;
+    jobs.clear();
+}
+
+void AnimationWorker::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return pending || quit; });
+        if (quit) return;
+
+        std::vector<Animator*> batch = jobs;
+        float dt = jobDt;
+        lock.unlock();
+        for (Animator* a : batch) advanceAnimator(*a, dt);
+        lock.lock();
+
+        pending = false;
+        cv.notify_all();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// GPU palette
+// ---------------------------------------------------------------------------------------------
+
+void initBoneBuffer()
+{
+    glGenBuffers(1, &boneUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, boneUBO);
+    glBufferData(GL_UNIFORM_BUFFER, MAX_BONES * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BONE_BLOCK_BINDING, boneUBO);
+}
+
+// GLSL 330 has no layout(binding=...) for blocks, so every program using BoneBlock is wired up here
+void bindBoneBlock(unsigned program)
+{
+    GLuint blockIndex = glGetUniformBlockIndex(program, "BoneBlock");
+    if (blockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, blockIndex, BONE_BLOCK_BINDING);
+}
+
+void uploadBonePalette(const std::vector<glm::mat4>& palette)
+{
+    if (!boneUBO || palette.empty()) return;
+    size_t count = std::min(palette.size(), (size_t)MAX_BONES);
+    glBindBuffer(GL_UNIFORM_BUFFER, boneUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, count * sizeof(glm::mat4), glm::value_ptr(palette[0]));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void shutdownBoneBuffer()
+{
+    if (boneUBO) { glDeleteBuffers(1, &boneUBO); boneUBO = 0; }
+}
@@ -0,0 +1,358 @@
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../Header/Benchmark.h"
+#include "../Header/Animation.h"
+#include "../Header/Crowd.h"
+#include "../Header/NavGrid.h"
+#include "../Header/SceneState.h"
+#include "../Header/PostProcess.h"
+#include "../Header/Session.h"
+#include "../Header/ShaderCache.h"
+#include "../Header/Shadow.h"
+#include "../Header/ThreadPool.h"
+
+static const int benchAgentCounts[] = { 1000, 10000, 100000 };
+static const float benchMapHalf = 10.0f;
+
+static double nowMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// camera above the map edge looking at the center, so most of the crowd is inside the frustum
+static void benchCamera(glm::vec3& eye, glm::mat4& view, glm::mat4& projection)
+{
+    eye = glm::vec3(0.0f, 6.0f, -14.0f);
+    view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.005f, 100.0f);
+}
+
+static void benchmarkCrowdCpu()
+{
+    const int frames = 200;
+    const float dt = 1.0f / 75.0f;
+    glm::vec3 eye;
+    glm::mat4 view, projection;
+    benchCamera(eye, view, projection);
+    const RenderSettings settings;
+
+    std::printf("crowd (cpu, %u worker threads + main)\n", workerPool().workerCount());
+    for (int count : benchAgentCounts) {
+        initCrowd(count, benchMapHalf);
+        updateCrowd(dt); // warm up the pool
+
+        double start = nowMs();
+        for (int f = 0; f < frames; ++f) updateCrowd(dt);
+        double simMs = nowMs() - start;
+
+        start = nowMs();
+        for (int f = 0; f < frames; ++f) cullCrowd(view, projection, eye, 0.75f, 0.75f, 1.5f, glm::radians(45.0f), 1080.0f, settings.crowdMaxDistance);
+        double cullMs = nowMs() - start;
+
+        std::printf("  %6d agents: simulate %8.0f agents/ms (%.3f ms/frame), cull+LOD %8.0f agents/ms (%.3f ms/frame), visible %d\n",
+            count,
+            double(count) * frames / simMs, simMs / frames,
+            double(count) * frames / cullMs, cullMs / frames,
+            crowdStats().visible);
+    }
+}
+
+// Synthetic grids (random rectangles, ~30% blocked, fixed seed) at the map's grid size and larger:
+// collision queries, then A* vs JPS between the same random pairs of walkable cells.
+static void benchmarkNavigation()
+{
+    const int queries = 1000000, pairs = 50;
+    std::printf("navigation grid\n");
+    for (int size : { 512, 1024, 2048 }) {
+        std::mt19937 rng(1234);
+        NavGrid grid(size, size, benchMapHalf);
+        std::uniform_int_distribution<int> cellDist(0, size - 1), extentDist(1, size / 24);
+        const int rects = size * size * 3 / 10 / ((size / 48) * (size / 48) + 1);
+        for (int r = 0; r < rects; ++r) {
+            const int x0 = cellDist(rng), z0 = cellDist(rng), w = extentDist(rng), h = extentDist(rng);
+            for (int z = z0; z < std::min(size, z0 + h); ++z)
+                for (int x = x0; x < std::min(size, x0 + w); ++x) grid.setBlocked(x, z, true);
+        }
+        double start = nowMs();
+        grid.rebuildBlocks();
+        const double blocksMs = nowMs() - start;
+
+        std::uniform_real_distribution<float> worldDist(-benchMapHalf, benchMapHalf), stepDist(-0.5f, 0.5f);
+        std::vector<glm::vec2> points(queries);
+        for (glm::vec2& p : points) p = glm::vec2(worldDist(rng), worldDist(rng));
+
+        int hits = 0;
+        start = nowMs();
+        for (const glm::vec2& p : points) hits += grid.walkable(p);
+        const double pointMs = nowMs() - start;
+        start = nowMs();
+        for (const glm::vec2& p : points) hits += grid.circleFree(p, NAV_AVATAR_RADIUS);
+        const double circleMs = nowMs() - start;
+        start = nowMs();
+        for (const glm::vec2& p : points) hits += grid.segmentFree(p, p + glm::vec2(stepDist(rng), stepDist(rng)));
+        const double segmentMs = nowMs() - start;
+
+        std::printf("  %4d x %4d (%.0f%% blocked, blocks %.2f ms): point %.1f, circle %.1f, segment %.1f Mq/s (%d)\n",
+            size, size, grid.blockedFraction() * 100.0f, blocksMs,
+            queries / pointMs / 1000.0, queries / circleMs / 1000.0, queries / segmentMs / 1000.0, hits);
+
+        // same pairs for both searches
+        std::vector<std::pair<glm::ivec2, glm::ivec2>> ends;
+        while ((int)ends.size() < pairs) {
+            const glm::ivec2 a(cellDist(rng), cellDist(rng)), b(cellDist(rng), cellDist(rng));
+            if (!grid.blocked(a.x, a.y) && !grid.blocked(b.x, b.y)) ends.push_back({ a, b });
+        }
+        for (NavSearch search : { NAV_SEARCH_ASTAR, NAV_SEARCH_JPS }) {
+            findNavPath(grid, ends[0].first, ends[0].second, search); // size the scratch
+            double totalMs = 0.0;
+            long long expanded = 0;
+            int found = 0;
+            for (const auto& e : ends) {
+                NavSearchStats st;
+                found += !findNavPath(grid, e.first, e.second, search, &st).empty();
+                totalMs += st.ms;
+                expanded += st.expanded;
+            }
+            std::printf("    %-4s %d/%d paths, %.3f ms/path, %lld expanded/path\n",
+                search == NAV_SEARCH_JPS ? "JPS" : "A*", found, pairs, totalMs / pairs, expanded / pairs);
+        }
+    }
+}
+
+// Session file with a long measured route (5000 points): encode / decode, then the startup path (read the file
+// and decode it) against SESSION_RESTORE_BUDGET_MS. Returns false over budget.
+static bool benchmarkSession()
+{
+    const int iterations = 200;
+    SceneState scene;
+    for (int i = 0; i < 5000; ++i) scene.measurement.points.push_back({ float(i % 1920), float(i / 1920) * 40.0f });
+    scene.measurement.distancePixels = 123456.0f;
+
+    double start = nowMs();
+    std::vector<uint8_t> bytes;
+    for (int i = 0; i < iterations; ++i) bytes = encodeSession(scene);
+    const double encodeMs = (nowMs() - start) / iterations;
+
+    SceneState decoded;
+    start = nowMs();
+    for (int i = 0; i < iterations; ++i) decodeSession(bytes.data(), bytes.size(), decoded);
+    const double decodeMs = (nowMs() - start) / iterations;
+
+    const char* path = "Resources/cache/bench-session.bin";
+    std::error_code ec;
+    std::filesystem::create_directories("Resources/cache", ec);
+    start = nowMs();
+    const bool written = writeSessionFile(path, bytes);
+    const double writeMs = nowMs() - start;
+
+    double restoreMs = 0.0;
+    bool restored = written;
+    for (int i = 0; i < 20 && restored; ++i) {
+        SceneState fresh;
+        start = nowMs();
+        restored = restoreSession(fresh, path) && fresh.measurement.points == scene.measurement.points;
+        restoreMs = std::max(restoreMs, nowMs() - start);
+    }
+    std::filesystem::remove(path, ec);
+
+    const bool ok = restored && restoreMs <= SESSION_RESTORE_BUDGET_MS;
+    std::printf("session file (%zu bytes)\n", bytes.size());
+    std::printf("  encode %.3f ms, decode %.3f ms, write %.3f ms, restore %.3f ms (budget %.1f ms): %s\n",
+        encodeMs, decodeMs, writeMs, restoreMs, SESSION_RESTORE_BUDGET_MS,
+        !restored ? "FAIL (round trip)" : ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// Hidden 1280x720 window for the render benchmarks; nullptr if there is no usable GL context.
+static GLFWwindow* openBenchContext()
+{
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "bench", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "bench: no GL context, skipping render benchmark" << std::endl;
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    if (glewInit() != GLEW_OK) {
+        std::cout << "bench: GLEW init failed, skipping render benchmark" << std::endl;
+        glfwDestroyWindow(window);
+        return nullptr;
+    }
+    glViewport(0, 0, 1280, 720);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    return window;
+}
+
+// The crowd shader with a fixed light and the proxy prism as every crowd LOD (the render benchmarks).
+// The proxy's GL objects go with it; shutdownCrowd() first.
+struct BenchCrowd {
+    Shader shader{ "crowd.vert", "basic.frag" };
+    Mesh proxy = buildCrowdProxyMesh(glm::vec3(-0.25f, -0.75f, -0.25f), glm::vec3(0.25f, 0.75f, 0.25f), glm::vec3(0.8f, 0.2f, 0.2f));
+
+    BenchCrowd()
+    {
+        shader.onProgramCreated(bindBoneBlock);
+        shader.use();
+        shader.setVec3("uLightPos", 0.0f, 5.0f, 0.0f);
+        shader.setVec3("uLightColor", 1.0f, 1.0f, 1.0f);
+        shader.setFloat("uLightIntensity", 0.4f);
+        shader.setFloat("uAmbientFactor", 0.55f);
+        setCrowdMeshes({ &proxy }, 1, &proxy);
+    }
+    ~BenchCrowd() { proxy.release(); }
+    BenchCrowd(const BenchCrowd&) = delete;
+    BenchCrowd& operator=(const BenchCrowd&) = delete;
+};
+
+// Instanced draws of the proxy mesh in a hidden window; measures submission + GPU time (glFinish per frame).
+static void benchmarkCrowdGpu()
+{
+    BenchCrowd crowd;
+    Shader& crowdShader = crowd.shader;
+
+    glm::vec3 eye;
+    glm::mat4 view, projection;
+    benchCamera(eye, view, projection);
+    RenderSettings settings;
+    settings.crowdMaxDistance = 100.0f;
+
+    const int frames = 60;
+    std::printf("crowd (render, %s)\n", (const char*)glGetString(GL_RENDERER));
+    for (int count : benchAgentCounts) {
+        initCrowd(count, benchMapHalf);
+        cullCrowd(view, projection, eye, 0.75f, 0.75f, 1.5f, glm::radians(45.0f), 720.0f, settings.crowdMaxDistance);
+        drawCrowd(crowdShader, glm::mat4(1.0f), 0.75f, view, projection);
+        glFinish();
+
+        double start = nowMs();
+        for (int f = 0; f < frames; ++f) {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawCrowd(crowdShader, glm::mat4(1.0f), 0.75f, view, projection);
+            glFinish();
+        }
+        double drawMs = nowMs() - start;
+        int visible = crowdStats().visible;
+
+        std::printf("  %6d agents: %d drawn, render %8.0f agents/ms (%.3f ms/frame)\n",
+            count, visible, double(visible) * frames / drawMs, drawMs / frames);
+    }
+
+    shutdownCrowd();
+}
+
+// Shadow pass per frame: a moving caster redraws the map every frame, a still one reuses it.
+static void benchmarkShadows()
+{
+    RenderSettings settings;
+    const int frames = 120;
+    const int sizes[] = { 1024, 2048, 4096 };
+
+    initShadows(settings);
+    Mesh caster = buildCrowdProxyMesh(glm::vec3(-0.25f, -0.75f, -0.25f), glm::vec3(0.25f, 0.75f, 0.25f), glm::vec3(0.8f, 0.8f, 0.8f));
+    const Bounds casterBounds = boundsFromMinMax(glm::vec3(-0.25f, 0.0f, -0.25f), glm::vec3(0.25f, 1.5f, 0.25f));
+    const glm::vec3 lightDir = glm::normalize(glm::vec3(0.3f, -1.0f, 0.2f));
+
+    std::printf("shadow map (caster pass, glFinish per frame)\n");
+    for (int size : sizes) {
+        settings.shadowMapSize = size;
+        double ms[2] = {};
+        for (int moving = 1; moving >= 0; --moving) {
+            double start = nowMs();
+            for (int f = 0; f < frames; ++f) {
+                beginShadowFrame();
+                ShadowCasterKey key;
+                key.model = glm::translate(glm::mat4(1.0f), glm::vec3(moving ? f * 0.01f : 0.0f, 0.75f, 0.0f));
+                if (beginShadowPass(lightDir, transformBounds(casterBounds, key.model), key, settings)) {
+                    shadowCasterShader().setMat4("uM", key.model);
+                    caster.Draw(shadowCasterShader());
+                    endShadowPass(1280, 720);
+                }
+                glFinish();
+            }
+            ms[moving] = (nowMs() - start) / frames;
+        }
+        std::printf("  %4d px: moving caster %.3f ms/frame, still caster %.3f ms/frame\n", size, ms[1], ms[0]);
+    }
+
+    caster.release();
+    shutdownShadows();
+}
+
+// The crowd scene through each anti-aliasing mode (bloom off, so only the AA cost differs).
+static void benchmarkAntiAliasing()
+{
+    BenchCrowd crowd;
+    Shader& crowdShader = crowd.shader;
+
+    glm::vec3 eye;
+    glm::mat4 view, projection;
+    benchCamera(eye, view, projection);
+    RenderSettings settings;
+    settings.crowdMaxDistance = 100.0f;
+    settings.bloomQuality = 0;
+
+    initPostProcess();
+    initCrowd(10000, benchMapHalf);
+    cullCrowd(view, projection, eye, 0.75f, 0.75f, 1.5f, glm::radians(45.0f), 720.0f, settings.crowdMaxDistance);
+
+    struct Config { int mode; int samples; };
+    const Config configs[] = { { AA_OFF, 0 }, { AA_MSAA, 2 }, { AA_MSAA, 4 }, { AA_MSAA, 8 }, { AA_FXAA, 0 } };
+    const int frames = 60;
+    std::printf("anti-aliasing (1280x720, %d agents drawn, glFinish per frame)\n", crowdStats().visible);
+    for (const Config& c : configs) {
+        settings.antiAliasMode = c.mode;
+        settings.msaaSamples = c.samples;
+        double ms = 0.0;
+        for (int pass = 0; pass < 2; ++pass) { // first pass builds the targets
+            double start = nowMs();
+            for (int f = 0; f < frames; ++f) {
+                beginScenePass(1280, 720, settings);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                glEnable(GL_DEPTH_TEST);
+                drawCrowd(crowdShader, glm::mat4(1.0f), 0.75f, view, projection);
+                endScenePass();
+                glFinish();
+            }
+            ms = (nowMs() - start) / frames;
+        }
+        if (c.mode == AA_MSAA) std::printf("  MSAA %dx: %.3f ms/frame\n", c.samples, ms);
+        else std::printf("  %-7s: %.3f ms/frame\n", antiAliasModeName(c.mode), ms);
+    }
+
+    shutdownPostProcess();
+    shutdownCrowd();
+}
+
+int runBenchmarks()
+{
+    benchmarkCrowdCpu();
+    benchmarkNavigation();
+    const bool sessionOk = benchmarkSession();
+    if (glfwInit()) {
+        if (GLFWwindow* window = openBenchContext()) {
+            initBoneBuffer();
+            benchmarkCrowdGpu();
+            benchmarkShadows();
+            benchmarkAntiAliasing();
+            shutdownBoneBuffer();
+            shutdownShaderCache();
+            glfwDestroyWindow(window);
+        }
+        glfwTerminate();
+    }
+    return sessionOk ? 0 : 1;
+}
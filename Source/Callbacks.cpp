@@ -3,7 +3,13 @@
 #include "../Header/Callbacks.h"
 #include "../Header/Util.h"
 #include "../Header/Globals.h"
+#include "../Header/SceneState.h"
 #include "../Header/SupermanGlobals.h"
+#include "../Header/PostProcess.h"
+#include "../Header/Profiler.h"
+#include "../Header/InputReplay.h"
+#include "../Header/InputQueue.h"
+#include "../Header/CameraPath.h"
 #include <cmath> // for sqrtf
 #include <vector>
 #include <utility>
@@ -34,7 +40,59 @@ static void disableMouseCapture(GLFWwindow* window)
     if (cursor) glfwSetCursor(window, cursor);
 }
 
-void center_callback(GLFWwindow* window, int button, int action, int mods) {
+// Overview on / off (R key or the top pin). The camera flies between the walking view and the measuring
+// camera (CameraPath.h) instead of jumping; the map window switches right away.
+static void toggleOverview(GLFWwindow* window, SceneState& scene)
+{
+    if (cameraFlythroughActive()) return; // the fly-through owns the camera, P ends it first
+
+    const CameraPose current{ scene.view.cameraPos, scene.view.cameraYaw, scene.view.cameraPitch };
+    if (!scene.view.overviewMode) {
+        // save map view + walking camera (unless a transition back is still on its way: the saved view is
+        // still the walking one, the current pose is somewhere in the air)
+        if (!cameraPathActive()) {
+            scene.saved.mapOffsetX = scene.view.mapOffsetX;
+            scene.saved.mapOffsetY = scene.view.mapOffsetY;
+            scene.saved.mapTexScale = scene.view.mapTexScale;
+
+            scene.saved.cameraPos = scene.view.cameraPos;
+            scene.saved.cameraFront = scene.view.cameraFront;
+            scene.saved.cameraYaw = scene.view.cameraYaw;
+            scene.saved.cameraPitch = scene.view.cameraPitch;
+        }
+
+        // disable mouse-look so user cannot rotate the overview camera
+        disableMouseCapture(window);
+
+        // enter overview: full-map, measuring camera looking at the map center (origin)
+        scene.view.mapTexScale = 1.0f;
+        scene.view.mapOffsetX = 0.0f;
+        scene.view.mapOffsetY = 0.0f;
+        scene.view.overviewMode = true;
+
+        const glm::vec3 measurePos(scene.camera.measureX, scene.camera.measureY, scene.camera.measureZ);
+        const glm::vec3 front = glm::normalize(glm::vec3(0.0f, 0.0f, 0.0f) - measurePos);
+        scene.camera.measureYaw = glm::degrees(atan2(front.z, front.x));
+        scene.camera.measurePitch = glm::degrees(asin(glm::clamp(front.y, -1.0f, 1.0f)));
+        startCameraTransition(current, CameraPose{ measurePos, scene.camera.measureYaw, scene.camera.measurePitch });
+    } else {
+        // restore map view
+        scene.view.mapOffsetX = scene.saved.mapOffsetX;
+        scene.view.mapOffsetY = scene.saved.mapOffsetY;
+        scene.view.mapTexScale = scene.saved.mapTexScale;
+        scene.view.overviewMode = false;
+
+        // fly back to the saved walking camera
+        startCameraTransition(current, CameraPose{ scene.saved.cameraPos, scene.saved.cameraYaw, scene.saved.cameraPitch });
+    }
+
+    // keep pin visual in sync with overview state
+    scene.view.pinShowsStanding = scene.view.overviewMode;
+}
+
+void center_callback(GLFWwindow* window, int button, int action, int mods, double cursorX, double cursorY) {
+    SceneState& scene = sceneOf(window);
+
     // Right-click toggles mouse-capture / look-around on press (toggle behavior)
     if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS) {
         if (!g_mouseCaptured) enableMouseCapture(window);
@@ -45,14 +103,13 @@ void center_callback(GLFWwindow* window, int button, int action, int mods) {
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
         glfwSetCursor(window, cursorPressed);
 
-        double xpos_win, ypos_win;
-        glfwGetCursorPos(window, &xpos_win, &ypos_win);
+        double xpos_win = cursorX, ypos_win = cursorY;
 
         // convert window coords to framebuffer coords (handles HiDPI)
         int fbW = 0, fbH = 0;
         int winW = 0, winH = 0;
         glfwGetFramebufferSize(window, &fbW, &fbH);
-        glfwGetWindowSize(window, &winW, &winH);
+        inputWindowSize(window, &winW, &winH);
         if (winW == 0) winW = 1;
         if (winH == 0) winH = 1;
         float scaleX = (float)fbW / (float)winW;
@@ -73,60 +130,15 @@ void center_callback(GLFWwindow* window, int button, int action, int mods) {
             ypos <= pinMarginPx + pinPxH;
 
         if (insidePin) {
-            // Toggle overview exactly like pressing R: save/restore view
-            if (!overviewMode) {
-                // save map view
-                saved_mapOffsetX = mapOffsetX;
-                saved_mapOffsetY = mapOffsetY;
-                saved_mapTexScale = mapTexScale;
-
-                // save camera state
-                saved_cameraPos = cameraPos;
-                saved_cameraFront = cameraFront;
-                saved_cameraYaw = cameraYaw;
-                saved_cameraPitch = cameraPitch;
-
-                // disable mouse-look so user cannot rotate the overview camera
-                disableMouseCapture(window);
-
-                // enter overview: move camera to center, full-map, using globals for measuring camera
-                mapTexScale = 1.0f;
-                mapOffsetX = 0.0f;
-                mapOffsetY = 0.0f;
-                overviewMode = true;
-
-                // Use explicit measuring camera globals for position
-                cameraPos = glm::vec3(measureCamX, measureCamY, measureCamZ);
-                // Point at map center (origin) to ensure the map is visible
-                cameraFront = glm::normalize(glm::vec3(0.0f, 0.0f, 0.0f) - cameraPos);
-                // update yaw/pitch and keep measuring globals in sync
-                cameraYaw = glm::degrees(atan2(cameraFront.z, cameraFront.x));
-                cameraPitch = glm::degrees(asin(glm::clamp(cameraFront.y, -1.0f, 1.0f)));
-                measureCamYaw = cameraYaw;
-                measureCamPitch = cameraPitch;
-            } else {
-                // restore map view
-                mapOffsetX = saved_mapOffsetX;
-                mapOffsetY = saved_mapOffsetY;
-                mapTexScale = saved_mapTexScale;
-                overviewMode = false;
-
-                // restore camera state
-                cameraPos = saved_cameraPos;
-                cameraFront = saved_cameraFront;
-                cameraYaw = saved_cameraYaw;
-                cameraPitch = saved_cameraPitch;
-            }
-
-            // set pin visual to reflect overview state
-            pinShowsStanding = overviewMode;
+            // Toggle overview exactly like pressing R
+            toggleOverview(window, scene);
 
             // consume click
             return;
         }
 
-        // If in overview mode, clicks on the map add measurement points
-        if (overviewMode) {
+        // If in overview mode, clicks on the map add measurement points (not while the camera is still flying in)
+        if (scene.view.overviewMode && !cameraPathActive()) {
             if (fbW > 0 && fbH > 0) {
                 // compute normalized device coords (NDC)
                 float ndcX = (xpos / float(fbW)) * 2.0f - 1.0f;
@@ -135,7 +147,7 @@ void center_callback(GLFWwindow* window, int button, int action, int mods) {
                 // Recreate projection and view matrices (must match main's)
                 glm::mat4 projection = glm::perspective(glm::radians(45.0f),
                     (float)screenWidth / (float)screenHeight, 0.005f, 100.0f);
-                glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+                glm::mat4 view = glm::lookAt(scene.view.cameraPos, scene.view.cameraPos + scene.view.cameraFront, scene.view.cameraUp);
 
                 // inverse of proj * view to unproject clip-space coords
                 glm::mat4 invPV = glm::inverse(projection * view);
@@ -180,9 +192,9 @@ void center_callback(GLFWwindow* window, int button, int action, int mods) {
             // If click is on an existing measurement point, delete it and update the total.
             const float hitRadius = 12.0f; // pixels, tolerance for clicking a point
             int hitIndex = -1;
-            for (size_t i = 0; i < measurementPoints.size(); ++i) {
-                float dx = measurementPoints[i].first - xpos;
-                float dy = measurementPoints[i].second - ypos;
+            for (size_t i = 0; i < scene.measurement.points.size(); ++i) {
+                float dx = scene.measurement.points[i].first - xpos;
+                float dy = scene.measurement.points[i].second - ypos;
                 float dist2 = dx*dx + dy*dy;
                 if (dist2 <= hitRadius * hitRadius) {
                     hitIndex = (int)i;
@@ -191,28 +203,28 @@ void center_callback(GLFWwindow* window, int button, int action, int mods) {
             }
 
             if (hitIndex >= 0) {
-                measurementPoints.erase(measurementPoints.begin() + hitIndex);
+                scene.measurement.points.erase(scene.measurement.points.begin() + hitIndex);
 
                 // recompute total distance as sum of present segments
-                measurementDistancePixels = 0.0f;
-                for (size_t i = 1; i < measurementPoints.size(); ++i) {
-                    float dx = measurementPoints[i].first - measurementPoints[i-1].first;
-                    float dy = measurementPoints[i].second - measurementPoints[i-1].second;
-                    measurementDistancePixels += sqrtf(dx*dx + dy*dy);
+                scene.measurement.distancePixels = 0.0f;
+                for (size_t i = 1; i < scene.measurement.points.size(); ++i) {
+                    float dx = scene.measurement.points[i].first - scene.measurement.points[i-1].first;
+                    float dy = scene.measurement.points[i].second - scene.measurement.points[i-1].second;
+                    scene.measurement.distancePixels += sqrtf(dx*dx + dy*dy);
                 }
                 return;
             }
 
             // record the clicked pixel in framebuffer coords (not near existing point)
-            measurementPoints.emplace_back(xpos, ypos);
-            size_t n = measurementPoints.size();
+            scene.measurement.points.emplace_back(xpos, ypos);
+            size_t n = scene.measurement.points.size();
             if (n >= 2) {
-                auto &p0 = measurementPoints[n-2];
-                auto &p1 = measurementPoints[n-1];
+                auto &p0 = scene.measurement.points[n-2];
+                auto &p1 = scene.measurement.points[n-1];
                 float dx = p1.first - p0.first;
                 float dy = p1.second - p0.second;
                 float seg = sqrtf(dx*dx + dy*dy);
-                measurementDistancePixels += seg;
+                scene.measurement.distancePixels += seg;
             }
             return;
         }
@@ -224,6 +236,8 @@ void center_callback(GLFWwindow* window, int button, int action, int mods) {
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    SceneState& scene = sceneOf(window);
+
     // ESC to close
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, GLFW_TRUE);
@@ -239,103 +253,133 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
     // R toggles overview mode (on key press)
     if (key == GLFW_KEY_R && action == GLFW_PRESS) {
-        if (!overviewMode) {
-            // enter overview: save current view and switch to full texture view
-            saved_mapOffsetX = mapOffsetX;
-            saved_mapOffsetY = mapOffsetY;
-            saved_mapTexScale = mapTexScale;
-
-            // save camera state
-            saved_cameraPos = cameraPos;
-            saved_cameraFront = cameraFront;
-            saved_cameraYaw = cameraYaw;
-            saved_cameraPitch = cameraPitch;
-
-            // disable mouse-look while in overview
-            disableMouseCapture(window);
-
-            mapTexScale = 1.0f;
-            mapOffsetX = 0.0f;
-            mapOffsetY = 0.0f;
-            overviewMode = true;
-
-            // put overview camera behind the map center so it looks toward the plane
-            cameraPos = glm::vec3(0.0f, cameraYMeasuring, -overviewCameraBack);
-            cameraYaw = -90.0f;
-            cameraPitch = -80.0f;
-            {
-                float yr = glm::radians(cameraYaw);
-                float pr = glm::radians(cameraPitch);
-                glm::vec3 f;
-                f.x = cos(yr) * cos(pr);
-                f.y = sin(pr);
-                f.z = sin(yr) * cos(pr);
-                cameraFront = glm::normalize(f);
-            }
-        } else {
-            // exit overview: restore saved view
-            mapOffsetX = saved_mapOffsetX;
-            mapOffsetY = saved_mapOffsetY;
-            mapTexScale = saved_mapTexScale;
-            overviewMode = false;
-
-            // restore camera state
-            cameraPos = saved_cameraPos;
-            cameraFront = saved_cameraFront;
-            cameraYaw = saved_cameraYaw;
-            cameraPitch = saved_cameraPitch;
-        }
-        // keep pin visual in sync with overview state
-        pinShowsStanding = overviewMode;
+        toggleOverview(window, scene);
         return;
     }
 
-    // F-keys: toggle depth/culling/winding (act only on key press)
+    // F-keys: toggle depth/culling/winding (act only on key press; the frame applies them to GL)
     if (action == GLFW_PRESS) {
         switch (key) {
         case GLFW_KEY_F1:
-            depthTestEnabled = !depthTestEnabled;
-            if (depthTestEnabled) glEnable(GL_DEPTH_TEST);
-            else glDisable(GL_DEPTH_TEST);
-            std::cout << (depthTestEnabled ? "DEPTH TEST ENABLED" : "DEPTH TEST DISABLED") << std::endl;
+            scene.render.depthTestEnabled = !scene.render.depthTestEnabled;
+            std::cout << (scene.render.depthTestEnabled ? "DEPTH TEST ENABLED" : "DEPTH TEST DISABLED") << std::endl;
             break;
 
         case GLFW_KEY_F2:
-            faceCullingEnabled = !faceCullingEnabled;
-            if (faceCullingEnabled) glEnable(GL_CULL_FACE);
-            else glDisable(GL_CULL_FACE);
-            std::cout << (faceCullingEnabled ? "FACE CULLING ENABLED" : "FACE CULLING DISABLED") << std::endl;
+            scene.render.faceCullingEnabled = !scene.render.faceCullingEnabled;
+            std::cout << (scene.render.faceCullingEnabled ? "FACE CULLING ENABLED" : "FACE CULLING DISABLED") << std::endl;
             break;
 
         case GLFW_KEY_F3:
-            cullBackFaces = !cullBackFaces;
-            glCullFace(cullBackFaces ? GL_BACK : GL_FRONT);
-            std::cout << (cullBackFaces ? "CULLING BACK" : "CULLING FRONT") << std::endl;
+            scene.render.cullBackFaces = !scene.render.cullBackFaces;
+            std::cout << (scene.render.cullBackFaces ? "CULLING BACK" : "CULLING FRONT") << std::endl;
             break;
 
         case GLFW_KEY_F4:
-            isCCWWinding = !isCCWWinding;
-            glFrontFace(isCCWWinding ? GL_CCW : GL_CW);
-            std::cout << (isCCWWinding ? "CCW WINDING" : "CW WINDING") << std::endl;
+            scene.render.isCCWWinding = !scene.render.isCCWWinding;
+            std::cout << (scene.render.isCCWWinding ? "CCW WINDING" : "CW WINDING") << std::endl;
+            break;
+
+        case GLFW_KEY_F5:
+            scene.render.showCullStats = !scene.render.showCullStats;
+            break;
+
+        case GLFW_KEY_F6:
+            scene.render.bloomQuality = (scene.render.bloomQuality + 1) % 3;
+            std::cout << "BLOOM " << (scene.render.bloomQuality == 0 ? "OFF" : scene.render.bloomQuality == 1 ? "FAST" : "HIGH") << std::endl;
+            break;
+
+        case GLFW_KEY_F7:
+            scene.render.antiAliasMode = (scene.render.antiAliasMode + 1) % AA_MODE_COUNT;
+            std::cout << "ANTI-ALIASING " << antiAliasModeName(scene.render.antiAliasMode);
+            if (scene.render.antiAliasMode == AA_MSAA) std::cout << " " << scene.render.msaaSamples << "x";
+            std::cout << std::endl;
+            break;
+
+        case GLFW_KEY_F8:
+            scene.render.msaaSamples = scene.render.msaaSamples >= 8 ? 2 : scene.render.msaaSamples * 2;
+            std::cout << "MSAA " << scene.render.msaaSamples << "x" << std::endl;
+            break;
+
+        case GLFW_KEY_F10:
+            scene.render.showProfiler = !scene.render.showProfiler;
+            break;
+
+        case GLFW_KEY_F11:
+            requestProfilerTrace();
+            break;
+
+        case GLFW_KEY_F12:
+            scene.render.latencyMode = !scene.render.latencyMode;
+            resetInputLatencyStats();
+            std::cout << (scene.render.latencyMode ? "LATENCY MODE ENABLED" : "LATENCY MODE DISABLED") << std::endl;
             break;
 
-        // M = make model small: set desiredModelHeight (used for lift) and request a reload
+        case GLFW_KEY_F9:
+            scene.render.dynamicResolution = !scene.render.dynamicResolution;
+            std::cout << (scene.render.dynamicResolution ? "DYNAMIC RESOLUTION ENABLED" : "DYNAMIC RESOLUTION DISABLED") << std::endl;
+            break;
+
+        // M = make model small: set scene.model.desiredHeight (used for lift) and request a reload
         case GLFW_KEY_M:
             // User request: desiredHeight should become 0.4f while loadActiveModel should be called with 0.3f
-            desiredModelHeight = modelHeightMini;
-            requestModelLoadHeight = modelLoadHeightMini;
-            requestReloadModel = true;
+            scene.model.desiredHeight = modelHeightMini;
+            scene.model.loadHeight = modelLoadHeightMini;
+            scene.model.reloadRequested = true;
             std::cout << "REQUEST: SUPERMAN MINI - reload scheduled" << std::endl;
             break;
 
         // B = make model big again (restore defaults)
         case GLFW_KEY_B:
-            desiredModelHeight = modelHeightBig;
-            requestModelLoadHeight = modelLoadHeightBig;
-            requestReloadModel = true;
+            scene.model.desiredHeight = modelHeightBig;
+            scene.model.loadHeight = modelLoadHeightBig;
+            scene.model.reloadRequested = true;
             std::cout << "REQUEST: SUPERMAN BIG - reload scheduled" << std::endl;
             break;
 
+        // G = toggle crowd mode (agents are (re)spawned by Main)
+        case GLFW_KEY_G:
+            scene.render.crowdEnabled = !scene.render.crowdEnabled;
+            std::cout << (scene.render.crowdEnabled ? "CROWD ENABLED" : "CROWD DISABLED") << std::endl;
+            break;
+
+        case GLFW_KEY_L:
+            scene.render.mapLightsEnabled = !scene.render.mapLightsEnabled;
+            std::cout << (scene.render.mapLightsEnabled ? "MAP LIGHTS ENABLED" : "MAP LIGHTS DISABLED") << std::endl;
+            break;
+
+        case GLFW_KEY_K:
+            scene.render.shadowsEnabled = !scene.render.shadowsEnabled;
+            std::cout << (scene.render.shadowsEnabled ? "SHADOWS ENABLED" : "SHADOWS DISABLED") << std::endl;
+            break;
+
+        // P plays the scripted fly-through (walking view only); P again flies back early
+        case GLFW_KEY_P:
+            if (cameraFlythroughActive()) {
+                cancelCameraPath();
+            } else if (!scene.view.overviewMode) {
+                disableMouseCapture(window);
+                const CameraPose current{ scene.view.cameraPos, scene.view.cameraYaw, scene.view.cameraPitch };
+                if (startCameraFlythrough(CAMERA_FLYTHROUGH_PATH, current)) std::cout << "FLY-THROUGH" << std::endl;
+            }
+            break;
+
+        case GLFW_KEY_N:
+            scene.render.showMinimap = !scene.render.showMinimap;
+            std::cout << (scene.render.showMinimap ? "MINIMAP ENABLED" : "MINIMAP DISABLED") << std::endl;
+            break;
+
+        // T = avatar walks the measurement route (or stops); [ / ] = slower / faster
+        case GLFW_KEY_T:
+            scene.autopilot.toggleRequested = true;
+            break;
+
+        case GLFW_KEY_LEFT_BRACKET:
+        case GLFW_KEY_RIGHT_BRACKET:
+            scene.autopilot.speed = glm::clamp(scene.autopilot.speed * (key == GLFW_KEY_RIGHT_BRACKET ? 1.25f : 0.8f), 0.25f, 12.0f);
+            std::cout << "AUTOPILOT SPEED " << scene.autopilot.speed << std::endl;
+            break;
+
         default:
             break;
         }
@@ -344,6 +388,8 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 // Mouse movement callback for look-around
 void mouse_move_callback(GLFWwindow* window, double xpos, double ypos) {
+    SceneState& scene = sceneOf(window);
+
     // only affect camera when cursor is captured/disabled
     if (!g_mouseCaptured) {
         g_firstMouse = true; // ensure re-init when next capture happens
@@ -364,109 +410,34 @@ void mouse_move_callback(GLFWwindow* window, double xpos, double ypos) {
     xoffset *= g_mouseSensitivity;
     yoffset *= g_mouseSensitivity;
 
-    cameraYaw += xoffset;
-    cameraPitch += yoffset;
+    scene.view.cameraYaw += xoffset;
+    scene.view.cameraPitch += yoffset;
 
     // constrain pitch
-    if (cameraPitch > 89.0f) cameraPitch = 89.0f;
-    if (cameraPitch < -89.0f) cameraPitch = -89.0f;
+    if (scene.view.cameraPitch > 89.0f) scene.view.cameraPitch = 89.0f;
+    if (scene.view.cameraPitch < -89.0f) scene.view.cameraPitch = -89.0f;
 
     // update camera front vector from yaw/pitch (spherical)
-    float yawRad = glm::radians(cameraYaw);
-    float pitchRad = glm::radians(cameraPitch);
-
-    glm::vec3 front;
-    front.x = cos(yawRad) * cos(pitchRad);
-    front.y = sin(pitchRad);
-    front.z = sin(yawRad) * cos(pitchRad);
-    cameraFront = glm::normalize(front);
+    resetCameraFront(scene.view);
 }
 
 // Scroll callback: adjust camera vertical eye height
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    SceneState& scene = sceneOf(window);
+
     const float scrollSpeed = 0.5f; // meters per scroll tick, tune to taste
     const float minY = 0.01f;       // minimum eye height above plane (meters)
-    const float maxY = cameraYMeasuring; // use overview height as upper bound
+    const float maxY = scene.camera.yMeasuring; // use overview height as upper bound
 
     // Adjust walking-eye-height target
-    cameraYWalking += static_cast<float>(yoffset) * scrollSpeed;
+    scene.view.cameraYWalking += static_cast<float>(yoffset) * scrollSpeed;
 
     // Clamp the target
-    if (cameraYWalking < minY) cameraYWalking = minY;
-    if (cameraYWalking > maxY) cameraYWalking = maxY;
-
-    if (!overviewMode) {
-        cameraPos.y = cameraYWalking;
-    }
-}
-
+    if (scene.view.cameraYWalking < minY) scene.view.cameraYWalking = minY;
+    if (scene.view.cameraYWalking > maxY) scene.view.cameraYWalking = maxY;
 
-//      DEPRICATED :2D
-// This moves the texture sub-rectangle (mapOffsetX/Y) so the standing man stays visually centered.
-void updateMovement(GLFWwindow* window, float dt) {
-    // Use a direction vector so combinations (e.g., A+W) work and normalize for constant speed
-    float dirX = 0.0f, dirY = 0.0f;
-
-    // WASD drives player/camera movement now (no map panning)
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) dirY += 1.0f;
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) dirY -= 1.0f;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) dirX -= 1.0f;
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) dirX += 1.0f;
-
-    bool movingRightish = dirX > 0.0f; // true when input has rightward component
-    bool movingLeftish  = dirX < 0.0f; // true when input has leftward component
-    bool movingUpish    = dirY > 0.0f;
-    bool movingDownish  = dirY < 0.0f;
-
-    // We no longer modify mapOffset/mapTexScale/distancePixels here.
-    // Keep only animation / facing state so the standing-man sprite (if shown) animates.
-    if (dirX != 0.0f || dirY != 0.0f) {
-        // normalize so diagonal speed equals cardinal speed (used for animation direction)
-        float len = sqrtf(dirX * dirX + dirY * dirY);
-        if (len != 0.0f) {
-            dirX /= len;
-            dirY /= len;
-        }
-    }
-
-    // update facing/animation only
-    if (movingRightish) {
-        standingManState = 1; // rightish
-        standingManAnimTimer += dt;
-        if (standingManAnimTimer >= 0.5f) {
-            standingManAnimTimer -= 0.5f;
-            standingManAnimFrame ^= 1;
-        }
-    } else if (movingLeftish) {
-        standingManState = 2; // leftish
-        standingManAnimTimer += dt;
-        if (standingManAnimTimer >= 0.5f) {
-            standingManAnimTimer -= 0.5f;
-            standingManAnimFrame ^= 1;
-        }
-    } else if (movingUpish) {
-        standingManState = 3; // up
-        standingManAnimTimer += dt;
-        if (standingManAnimTimer >= 0.5f) {
-            standingManAnimTimer -= 0.5f;
-            standingManAnimFrame ^= 1;
-        }
-    } else if (movingDownish) {
-        standingManState = 4; // down
-        standingManAnimTimer += dt;
-        if (standingManAnimTimer >= 0.5f) {
-            standingManAnimTimer -= 0.5f;
-            standingManAnimFrame ^= 1;
-        }
-    } else {
-        // no movement -> idle/default
-        standingManState = 0;
-        standingManAnimTimer = 0.0f;
-        standingManAnimFrame = 0;
+    if (!scene.view.overviewMode) {
+        scene.view.cameraPos.y = scene.view.cameraYWalking;
     }
 }
 
-void updateMapMovement(GLFWwindow* window, float dt) {
-    // Forward to updateMovement which now only handles animation state
-    updateMovement(window, dt);
-}
\ No newline at end of file
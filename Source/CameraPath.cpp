@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "../Header/CameraPath.h"
+
+static std::vector<glm::vec3> bakedPositions;
+static std::vector<glm::quat> bakedOrientations;
+static float duration = 0.0f;
+static float playTime = 0.0f;
+static bool playing = false;
+static bool flythrough = false;
+static CameraPose returnPose;   // where a fly-through started (cancel flies back there)
+static CameraPose currentPose;  // last pose handed out
+
+static CameraLens lens;
+static std::vector<std::function<void(const std::vector<CameraPathRegion>&)>> prefetchHooks;
+
+glm::quat cameraOrientation(float yawDeg, float pitchDeg)
+{
+    const float yaw = glm::radians(yawDeg), pitch = glm::radians(pitchDeg);
+    const glm::vec3 front = glm::normalize(glm::vec3(cos(yaw) * cos(pitch), sin(pitch), sin(yaw) * cos(pitch)));
+    glm::vec3 right = glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f));
+    if (glm::length(right) < 1e-4f) right = glm::cross(front, glm::vec3(0.0f, 0.0f, 1.0f)); // looking straight up / down
+    right = glm::normalize(right);
+    const glm::vec3 up = glm::cross(right, front);
+    return glm::normalize(glm::quat_cast(glm::mat3(right, up, -front)));
+}
+
+CameraPose cameraPoseAt(const glm::vec3& position, const glm::quat& orientation)
+{
+    const glm::vec3 front = orientation * glm::vec3(0.0f, 0.0f, -1.0f);
+    CameraPose pose;
+    pose.position = position;
+    pose.yawDeg = glm::degrees(atan2(front.z, front.x));
+    pose.pitchDeg = glm::degrees(asin(glm::clamp(front.y, -1.0f, 1.0f)));
+    return pose;
+}
+
+static glm::quat slerpShortest(const glm::quat& a, glm::quat b, float t)
+{
+    if (glm::dot(a, b) < 0.0f) b = glm::quat(-b.w, -b.x, -b.y, -b.z);
+    return glm::slerp(a, b, t);
+}
+
+static glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float u)
+{
+    const float u2 = u * u, u3 = u2 * u;
+    return 0.5f * (2.0f * p1 + (p2 - p0) * u + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * u3);
+}
+
+static void samplePath(const std::vector<CameraPathKey>& keys, float t, glm::vec3& position, glm::quat& orientation)
+{
+    size_t i = 0;
+    while (i + 2 < keys.size() && t >= keys[i + 1].time) ++i;
+    const CameraPathKey& a = keys[i];
+    const CameraPathKey& b = keys[i + 1];
+    const float u = glm::clamp((t - a.time) / std::max(b.time - a.time, 1e-6f), 0.0f, 1.0f);
+
+    // end segments reuse their end key as the missing neighbour
+    const glm::vec3& p0 = keys[i > 0 ? i - 1 : i].position;
+    const glm::vec3& p3 = keys[std::min(i + 2, keys.size() - 1)].position;
+    position = catmullRom(p0, a.position, b.position, p3, u);
+    orientation = slerpShortest(a.orientation, b.orientation, u);
+}
+
+// plane (y = 0) footprint of the frustum at this pose
+static CameraPathRegion visibleRegion(const glm::vec3& position, const glm::quat& orientation, float time)
+{
+    const glm::vec3 forward = orientation * glm::vec3(0.0f, 0.0f, -1.0f);
+    const glm::vec3 right = orientation * glm::vec3(1.0f, 0.0f, 0.0f);
+    const glm::vec3 up = orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+    const float tanY = tan(lens.fovY * 0.5f), tanX = tanY * lens.aspect;
+
+    CameraPathRegion region;
+    region.time = time;
+    region.min = region.max = glm::vec2(position.x, position.z);
+    for (float sx : { -1.0f, 1.0f }) {
+        for (float sy : { -1.0f, 1.0f }) {
+            const glm::vec3 dir = glm::normalize(forward + right * (sx * tanX) + up * (sy * tanY));
+            float reach = lens.maxDistance;
+            if (dir.y < -1e-4f && position.y > 0.0f) reach = std::min(reach, position.y / -dir.y); // ray hits the plane
+            const glm::vec3 hit = position + dir * reach;
+            region.min = glm::min(region.min, glm::vec2(hit.x, hit.z));
+            region.max = glm::max(region.max, glm::vec2(hit.x, hit.z));
+        }
+    }
+    return region;
+}
+
+// eased: smoothstep over the whole path (transitions start and stop gently)
+static void bake(const std::vector<CameraPathKey>& keys, bool eased)
+{
+    duration = std::max(keys.back().time, 1e-3f);
+    const int count = std::max(2, (int)std::ceil(duration * CAMERA_PATH_BAKE_HZ) + 1);
+    bakedPositions.resize(count);
+    bakedOrientations.resize(count);
+    for (int i = 0; i < count; ++i) {
+        float s = (float)i / (float)(count - 1);
+        if (eased) s = s * s * (3.0f - 2.0f * s);
+        samplePath(keys, s * duration, bakedPositions[i], bakedOrientations[i]);
+    }
+    playTime = 0.0f;
+    playing = true;
+    currentPose = cameraPoseAt(bakedPositions[0], bakedOrientations[0]);
+
+    if (prefetchHooks.empty()) return;
+    std::vector<CameraPathRegion> regions;
+    for (float t = 0.0f;; t += CAMERA_PATH_PREFETCH_STEP) {
+        const float tc = std::min(t, duration);
+        const int i = (int)std::lround(tc / duration * (count - 1));
+        regions.push_back(visibleRegion(bakedPositions[i], bakedOrientations[i], tc));
+        if (tc >= duration) break;
+    }
+    for (const auto& hook : prefetchHooks) hook(regions);
+}
+
+void startCameraTransition(const CameraPose& from, const CameraPose& to)
+{
+    std::vector<CameraPathKey> keys(3);
+    keys[0].position = from.position;
+    keys[0].orientation = cameraOrientation(from.yawDeg, from.pitchDeg);
+    keys[2].time = CAMERA_TRANSITION_SECONDS;
+    keys[2].position = to.position;
+    keys[2].orientation = cameraOrientation(to.yawDeg, to.pitchDeg);
+
+    // halfway, lifted by a fraction of the distance: an arc instead of a straight dive
+    keys[1].time = CAMERA_TRANSITION_SECONDS * 0.5f;
+    keys[1].position = glm::mix(from.position, to.position, 0.5f) +
+                       glm::vec3(0.0f, 0.15f * glm::length(to.position - from.position), 0.0f);
+    keys[1].orientation = slerpShortest(keys[0].orientation, keys[2].orientation, 0.5f);
+
+    flythrough = false;
+    bake(keys, true);
+}
+
+bool startCameraFlythrough(const char* path, const CameraPose& from)
+{
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "Camera path: cannot open " << path << std::endl;
+        return false;
+    }
+
+    // lead-in from the current pose, the file's keys, then back
+    std::vector<CameraPathKey> keys(1);
+    keys[0].position = from.position;
+    keys[0].orientation = cameraOrientation(from.yawDeg, from.pitchDeg);
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(file, line)) {
+        lineNo++;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream in(line);
+        float t, x, y, z, yaw, pitch;
+        if (!(in >> t)) continue; // blank / comment
+        if (!(in >> x >> y >> z >> yaw >> pitch)) {
+            std::cout << "Camera path: " << path << ":" << lineNo << ": expected time x y z yaw pitch" << std::endl;
+            continue;
+        }
+        CameraPathKey key;
+        key.time = t + CAMERA_TRANSITION_SECONDS;
+        if (key.time <= keys.back().time) {
+            std::cout << "Camera path: " << path << ":" << lineNo << ": time must increase, key skipped" << std::endl;
+            continue;
+        }
+        key.position = glm::vec3(x, y, z);
+        key.orientation = cameraOrientation(yaw, pitch);
+        keys.push_back(key);
+    }
+    if (keys.size() < 3) {
+        std::cout << "Camera path: " << path << " needs at least two keys" << std::endl;
+        return false;
+    }
+
+    CameraPathKey back = keys[0];
+    back.time = keys.back().time + CAMERA_TRANSITION_SECONDS;
+    keys.push_back(back);
+
+    flythrough = true;
+    returnPose = from;
+    bake(keys, false);
+    return true;
+}
+
+void cancelCameraPath()
+{
+    if (!playing) return;
+    if (flythrough) startCameraTransition(currentPose, returnPose);
+    else playing = false;
+}
+
+bool cameraPathActive()
+{
+    return playing;
+}
+
+bool cameraFlythroughActive()
+{
+    return playing && flythrough;
+}
+
+bool updateCameraPath(float dt, CameraPose& pose)
+{
+    if (!playing) return false;
+
+    playTime = std::min(playTime + dt, duration);
+    const float f = playTime / duration * (float)(bakedPositions.size() - 1);
+    const size_t i = std::min((size_t)f, bakedPositions.size() - 2);
+    const float u = f - (float)i;
+    currentPose = cameraPoseAt(glm::mix(bakedPositions[i], bakedPositions[i + 1], u),
+                               slerpShortest(bakedOrientations[i], bakedOrientations[i + 1], u));
+    pose = currentPose;
+
+    if (playTime >= duration) playing = false; // this frame lands exactly on the last key
+    return true;
+}
+
+void setCameraPathLens(const CameraLens& newLens)
+{
+    lens = newLens;
+}
+
+void addCameraPathPrefetch(std::function<void(const std::vector<CameraPathRegion>&)> hook)
+{
+    prefetchHooks.push_back(std::move(hook));
+}
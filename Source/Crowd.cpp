@@ -0,0 +1,321 @@
+#include <GL/glew.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CROWD_SSE2 1
+#endif
+
+#include <glm/gtc/constants.hpp>
+
+#include "../Header/Crowd.h"
+#include "../Header/Culling.h"
+#include "../Header/Globals.h"
+#include "../Header/ThreadPool.h"
+
+// SoA agent state. Arrays are padded to a multiple of 4 so the SIMD loop never needs a tail;
+// padding agents have zero speed and are never drawn.
+static int agentCount = 0;
+static size_t paddedCount = 0;
+static float crowdHalf = 10.0f;
+static std::vector<float> posX, posZ, dirX, dirZ, speed, yaw;
+static std::vector<unsigned char> lodLevel; // last LOD per agent (hysteresis state)
+
+// per-chunk cull output, concatenated into the instance arrays after the parallel pass
+static const size_t CULL_GRAIN = 4096;
+static std::vector<std::vector<glm::vec4>> chunkInstances[CROWD_LOD_LEVELS];
+static std::vector<glm::vec4> lodInstances[CROWD_LOD_LEVELS]; // x, z, sin(yaw), cos(yaw)
+
+// below this many pixels an agent is drawn as the proxy prism (left again above PX * (1 + hysteresis))
+static const float CROWD_PROXY_PX = 12.0f;
+static const float CROWD_PROXY_HYSTERESIS = 0.25f;
+
+static std::vector<Mesh*> modelMeshes;
+static int modelLodCount = 1;
+static Mesh* proxyMesh = nullptr;
+static unsigned instanceVBO[CROWD_LOD_LEVELS] = {};
+
+static CrowdStats stats;
+
+static double msSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void initCrowd(int count, float mapHalf, unsigned seed)
+{
+    agentCount = std::max(count, 0);
+    paddedCount = (size_t(agentCount) + 3) & ~size_t(3);
+    crowdHalf = mapHalf;
+
+    posX.assign(paddedCount, 0.0f);
+    posZ.assign(paddedCount, 0.0f);
+    dirX.assign(paddedCount, 0.0f);
+    dirZ.assign(paddedCount, 0.0f);
+    speed.assign(paddedCount, 0.0f);
+    yaw.assign(paddedCount, 0.0f);
+    lodLevel.assign(paddedCount, 0);
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(-mapHalf, mapHalf);
+    std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+    std::uniform_real_distribution<float> pace(0.3f, 1.0f);
+
+    for (int i = 0; i < agentCount; ++i) {
+        posX[i] = pos(rng);
+        posZ[i] = pos(rng);
+        yaw[i] = angle(rng);
+        // same heading convention as the avatar: facing yaw moves along (-cos, sin)
+        dirX[i] = -std::cos(yaw[i]);
+        dirZ[i] = std::sin(yaw[i]);
+        speed[i] = pace(rng);
+    }
+
+    stats = CrowdStats();
+    stats.agents = agentCount;
+}
+
+int crowdSize()
+{
+    return agentCount;
+}
+
+// Advance agents [begin, end) and bounce them off the plane edges. begin/end are multiples of 4.
+static void simulateRange(size_t begin, size_t end, float dt)
+{
+    size_t i = begin;
+#ifdef CROWD_SSE2
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vmax = _mm_set1_ps(crowdHalf);
+    const __m128 vmin = _mm_set1_ps(-crowdHalf);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 step = _mm_mul_ps(_mm_loadu_ps(&speed[i]), vdt);
+        __m128 dx = _mm_loadu_ps(&dirX[i]);
+        __m128 dz = _mm_loadu_ps(&dirZ[i]);
+        __m128 x = _mm_add_ps(_mm_loadu_ps(&posX[i]), _mm_mul_ps(dx, step));
+        __m128 z = _mm_add_ps(_mm_loadu_ps(&posZ[i]), _mm_mul_ps(dz, step));
+
+        // lanes that left the plane flip the matching direction component
+        __m128 outX = _mm_or_ps(_mm_cmplt_ps(x, vmin), _mm_cmpgt_ps(x, vmax));
+        __m128 outZ = _mm_or_ps(_mm_cmplt_ps(z, vmin), _mm_cmpgt_ps(z, vmax));
+        dx = _mm_xor_ps(dx, _mm_and_ps(outX, signBit));
+        dz = _mm_xor_ps(dz, _mm_and_ps(outZ, signBit));
+        x = _mm_min_ps(_mm_max_ps(x, vmin), vmax);
+        z = _mm_min_ps(_mm_max_ps(z, vmin), vmax);
+
+        _mm_storeu_ps(&posX[i], x);
+        _mm_storeu_ps(&posZ[i], z);
+        _mm_storeu_ps(&dirX[i], dx);
+        _mm_storeu_ps(&dirZ[i], dz);
+
+        // heading only changes on a bounce, which is rare: fix those lanes up in scalar code
+        int bounced = _mm_movemask_ps(_mm_or_ps(outX, outZ));
+        while (bounced) {
+            int lane = 0;
+            while (!(bounced & (1 << lane))) ++lane;
+            bounced &= ~(1 << lane);
+            yaw[i + lane] = std::atan2(dirZ[i + lane], -dirX[i + lane]);
+        }
+    }
+#endif
+    for (; i < end; ++i) {
+        float x = posX[i] + dirX[i] * speed[i] * dt;
+        float z = posZ[i] + dirZ[i] * speed[i] * dt;
+        bool bounced = false;
+        if (x < -crowdHalf || x > crowdHalf) { dirX[i] = -dirX[i]; bounced = true; }
+        if (z < -crowdHalf || z > crowdHalf) { dirZ[i] = -dirZ[i]; bounced = true; }
+        posX[i] = glm::clamp(x, -crowdHalf, crowdHalf);
+        posZ[i] = glm::clamp(z, -crowdHalf, crowdHalf);
+        if (bounced) yaw[i] = std::atan2(dirZ[i], -dirX[i]);
+    }
+}
+
+void updateCrowd(float dt)
+{
+    auto start = std::chrono::steady_clock::now();
+    // grain is a multiple of 4 so every chunk starts on a SIMD boundary
+    workerPool().parallelFor(paddedCount, 8192, [dt](size_t begin, size_t end) {
+        simulateRange(begin, end, dt);
+    });
+    stats.simulateMs = msSince(start);
+}
+
+void cullCrowd(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos,
+               float lift, float radius, float height, float fovY, float viewportHeightPx, float maxDistance)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    const Frustum frustum = extractFrustum(projection * view);
+    const int levels = std::max(1, std::min(modelLodCount, MESH_LOD_MAX));
+    const size_t chunks = (size_t(agentCount) + CULL_GRAIN - 1) / CULL_GRAIN;
+
+    for (int l = 0; l < CROWD_LOD_LEVELS; ++l) {
+        if (chunkInstances[l].size() < chunks) chunkInstances[l].resize(chunks);
+        for (size_t c = 0; c < chunks; ++c) chunkInstances[l][c].clear();
+    }
+
+    workerPool().parallelFor(size_t(agentCount), CULL_GRAIN, [&](size_t begin, size_t end) {
+        const size_t chunk = begin / CULL_GRAIN;
+
+        // frustum + distance test four agents at a time
+        SphereSoA spheres;
+        spheres.x = posX.data();
+        spheres.z = posZ.data();
+        spheres.yConst = lift;
+        spheres.radiusConst = radius;
+        unsigned char visible[CULL_GRAIN];
+        cullSpheres(frustum, cameraPos, maxDistance, spheres, begin, end, visible);
+
+        int culled = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (!visible[i - begin]) { culled++; continue; }
+            float dx = posX[i] - cameraPos.x;
+            float dy = lift - cameraPos.y;
+            float dz = posZ[i] - cameraPos.z;
+            float d2 = dx * dx + dy * dy + dz * dz;
+
+            // model LOD from projected size; the proxy takes over once the agent is a few pixels tall
+            float px = projectedHeightPx(height, std::sqrt(d2), fovY, viewportHeightPx);
+            int previous = lodLevel[i];
+            int level;
+            if (previous == CROWD_PROXY_LEVEL)
+                level = px > CROWD_PROXY_PX * (1.0f + CROWD_PROXY_HYSTERESIS) ? selectLodLevel(px, levels - 1, levels) : CROWD_PROXY_LEVEL;
+            else
+                level = px < CROWD_PROXY_PX ? CROWD_PROXY_LEVEL : selectLodLevel(px, previous, levels);
+            lodLevel[i] = (unsigned char)level;
+
+            chunkInstances[level][chunk].push_back(glm::vec4(posX[i], posZ[i], std::sin(yaw[i]), std::cos(yaw[i])));
+        }
+        recordCulling(CULL_CROWD, int(end - begin), culled);
+    });
+
+    stats.visible = 0;
+    for (int l = 0; l < CROWD_LOD_LEVELS; ++l) {
+        lodInstances[l].clear();
+        for (size_t c = 0; c < chunks; ++c)
+            lodInstances[l].insert(lodInstances[l].end(), chunkInstances[l][c].begin(), chunkInstances[l][c].end());
+        stats.perLod[l] = (int)lodInstances[l].size();
+        stats.visible += stats.perLod[l];
+    }
+    stats.agents = agentCount;
+    stats.cullMs = msSince(start);
+}
+
+const CrowdStats& crowdStats()
+{
+    return stats;
+}
+
+void setCrowdMeshes(const std::vector<Mesh*>& meshes, int lodCount, Mesh* proxy)
+{
+    modelMeshes = meshes;
+    modelLodCount = std::max(1, std::min(lodCount, MESH_LOD_MAX));
+    proxyMesh = proxy;
+}
+
+Mesh buildCrowdProxyMesh(const glm::vec3& bbMin, const glm::vec3& bbMax, const glm::vec3& color)
+{
+    const int sides = 8;
+    glm::vec3 center = (bbMin + bbMax) * 0.5f;
+    float rx = (bbMax.x - bbMin.x) * 0.5f;
+    float rz = (bbMax.z - bbMin.z) * 0.5f;
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+
+    auto addVertex = [&](const glm::vec3& p, const glm::vec3& n) {
+        Vertex v;
+        v.Position = p;
+        v.Normal = n;
+        v.TexCoords = glm::vec2(0.0f);
+        for (int k = 0; k < MAX_BONE_INFLUENCE; ++k) { v.BoneIDs[k] = -1; v.Weights[k] = 0.0f; }
+        vertices.push_back(v);
+        return (unsigned int)vertices.size() - 1;
+    };
+
+    // side walls (flat shaded, two triangles per side)
+    for (int s = 0; s < sides; ++s) {
+        float a0 = glm::two_pi<float>() * s / sides;
+        float a1 = glm::two_pi<float>() * (s + 1) / sides;
+        float am = (a0 + a1) * 0.5f;
+        glm::vec3 n(std::cos(am), 0.0f, std::sin(am));
+        glm::vec3 p0(center.x + std::cos(a0) * rx, bbMin.y, center.z + std::sin(a0) * rz);
+        glm::vec3 p1(center.x + std::cos(a1) * rx, bbMin.y, center.z + std::sin(a1) * rz);
+
+        unsigned int b0 = addVertex(p0, n);
+        unsigned int b1 = addVertex(p1, n);
+        unsigned int t1 = addVertex(glm::vec3(p1.x, bbMax.y, p1.z), n);
+        unsigned int t0 = addVertex(glm::vec3(p0.x, bbMax.y, p0.z), n);
+        indices.insert(indices.end(), { b0, t1, b1, b0, t0, t1 });
+    }
+
+    // top and bottom caps
+    unsigned int topCenter = addVertex(glm::vec3(center.x, bbMax.y, center.z), glm::vec3(0.0f, 1.0f, 0.0f));
+    unsigned int bottomCenter = addVertex(glm::vec3(center.x, bbMin.y, center.z), glm::vec3(0.0f, -1.0f, 0.0f));
+    for (int s = 0; s < sides; ++s) {
+        float a0 = glm::two_pi<float>() * s / sides;
+        float a1 = glm::two_pi<float>() * (s + 1) / sides;
+        glm::vec3 e0(center.x + std::cos(a0) * rx, 0.0f, center.z + std::sin(a0) * rz);
+        glm::vec3 e1(center.x + std::cos(a1) * rx, 0.0f, center.z + std::sin(a1) * rz);
+
+        unsigned int t0 = addVertex(glm::vec3(e0.x, bbMax.y, e0.z), glm::vec3(0.0f, 1.0f, 0.0f));
+        unsigned int t1 = addVertex(glm::vec3(e1.x, bbMax.y, e1.z), glm::vec3(0.0f, 1.0f, 0.0f));
+        indices.insert(indices.end(), { topCenter, t1, t0 });
+
+        unsigned int d0 = addVertex(glm::vec3(e0.x, bbMin.y, e0.z), glm::vec3(0.0f, -1.0f, 0.0f));
+        unsigned int d1 = addVertex(glm::vec3(e1.x, bbMin.y, e1.z), glm::vec3(0.0f, -1.0f, 0.0f));
+        indices.insert(indices.end(), { bottomCenter, d0, d1 });
+    }
+
+    return Mesh(vertices, indices, std::vector<Texture>(), color);
+}
+
+void drawCrowd(Shader& shader, const glm::mat4& baseModel, float lift, const glm::mat4& view, const glm::mat4& projection)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    shader.use();
+    shader.setMat4("uBase", baseModel);
+    shader.setMat4("uV", view);
+    shader.setMat4("uP", projection);
+    shader.setFloat("uLift", lift);
+
+    for (int l = 0; l < CROWD_LOD_LEVELS; ++l) {
+        const std::vector<glm::vec4>& instances = lodInstances[l];
+        if (instances.empty()) continue;
+        if (l == CROWD_PROXY_LEVEL ? !proxyMesh : modelMeshes.empty()) continue;
+
+        if (!instanceVBO[l]) glGenBuffers(1, &instanceVBO[l]);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO[l]);
+        // orphan + refill: the previous frame's draws may still be reading the old storage
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(glm::vec4), instances.data());
+
+        if (l == CROWD_PROXY_LEVEL) {
+            proxyMesh->DrawInstanced(shader, instanceVBO[l], (int)instances.size());
+        } else {
+            for (Mesh* mesh : modelMeshes)
+                mesh->DrawInstanced(shader, instanceVBO[l], (int)instances.size(), l);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    stats.drawMs = msSince(start);
+}
+
+void shutdownCrowd()
+{
+    for (int l = 0; l < CROWD_LOD_LEVELS; ++l) {
+        if (instanceVBO[l]) glDeleteBuffers(1, &instanceVBO[l]);
+        instanceVBO[l] = 0;
+        lodInstances[l].clear();
+        chunkInstances[l].clear();
+    }
+    modelMeshes.clear();
+    proxyMesh = nullptr;
+}
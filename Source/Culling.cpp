@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CULLING_SSE2 1
+#endif
+
+#include "../Header/Culling.h"
+
+// Gribb/Hartmann plane extraction (OpenGL clip space, -w <= z <= w).
+Frustum extractFrustum(const glm::mat4& m)
+{
+    // rows of the combined matrix (glm is column-major: m[col][row])
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum f;
+    f.planes[0] = row3 + row0; // left
+    f.planes[1] = row3 - row0; // right
+    f.planes[2] = row3 + row1; // bottom
+    f.planes[3] = row3 - row1; // top
+    f.planes[4] = row3 + row2; // near
+    f.planes[5] = row3 - row2; // far
+
+    for (glm::vec4& p : f.planes) {
+        float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        if (len > 0.0f) p = p / len;
+    }
+    return f;
+}
+
+bool sphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius)
+{
+    for (const glm::vec4& p : frustum.planes) {
+        if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius) return false;
+    }
+    return true;
+}
+
+Bounds boundsFromMinMax(const glm::vec3& min, const glm::vec3& max)
+{
+    Bounds b;
+    b.min = min;
+    b.max = max;
+    b.center = (min + max) * 0.5f;
+    b.radius = glm::length(max - min) * 0.5f;
+    return b;
+}
+
+Bounds mergeBounds(const Bounds& a, const Bounds& b)
+{
+    return boundsFromMinMax(glm::min(a.min, b.min), glm::max(a.max, b.max));
+}
+
+Bounds transformBounds(const Bounds& local, const glm::mat4& model)
+{
+    float sx = glm::length(glm::vec3(model[0]));
+    float sy = glm::length(glm::vec3(model[1]));
+    float sz = glm::length(glm::vec3(model[2]));
+
+    Bounds w;
+    w.center = glm::vec3(model * glm::vec4(local.center, 1.0f));
+    w.radius = local.radius * std::max(sx, std::max(sy, sz));
+    w.min = w.center - glm::vec3(w.radius);
+    w.max = w.center + glm::vec3(w.radius);
+    return w;
+}
+
+void cullSpheres(const Frustum& frustum, const glm::vec3& eye, float maxDistance,
+                 const SphereSoA& s, size_t begin, size_t end, unsigned char* visible)
+{
+    size_t i = begin;
+#ifdef CULLING_SSE2
+    const __m128 ex = _mm_set1_ps(eye.x), ey = _mm_set1_ps(eye.y), ez = _mm_set1_ps(eye.z);
+    const __m128 maxD = _mm_set1_ps(maxDistance);
+    __m128 px[6], py[6], pz[6], pw[6];
+    for (int p = 0; p < 6; ++p) {
+        px[p] = _mm_set1_ps(frustum.planes[p].x);
+        py[p] = _mm_set1_ps(frustum.planes[p].y);
+        pz[p] = _mm_set1_ps(frustum.planes[p].z);
+        pw[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(s.x + i);
+        __m128 z = _mm_loadu_ps(s.z + i);
+        __m128 y = s.y ? _mm_loadu_ps(s.y + i) : _mm_set1_ps(s.yConst);
+        __m128 r = s.radius ? _mm_loadu_ps(s.radius + i) : _mm_set1_ps(s.radiusConst);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+
+        // outside any plane -> culled
+        __m128 out = _mm_setzero_ps();
+        for (int p = 0; p < 6; ++p) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], x), _mm_mul_ps(py[p], y)),
+                                  _mm_add_ps(_mm_mul_ps(pz[p], z), pw[p]));
+            out = _mm_or_ps(out, _mm_cmplt_ps(d, negR));
+        }
+
+        // near side farther than maxDistance -> culled
+        __m128 dx = _mm_sub_ps(x, ex), dy = _mm_sub_ps(y, ey), dz = _mm_sub_ps(z, ez);
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 reach = _mm_add_ps(maxD, r);
+        out = _mm_or_ps(out, _mm_cmpgt_ps(d2, _mm_mul_ps(reach, reach)));
+
+        int mask = _mm_movemask_ps(out);
+        for (int lane = 0; lane < 4; ++lane)
+            visible[i + lane - begin] = (mask & (1 << lane)) ? 0 : 1;
+    }
+#endif
+    for (; i < end; ++i) {
+        glm::vec3 c(s.x[i], s.y ? s.y[i] : s.yConst, s.z[i]);
+        float r = s.radius ? s.radius[i] : s.radiusConst;
+        glm::vec3 d = c - eye;
+        float reach = maxDistance + r;
+        bool in = glm::dot(d, d) <= reach * reach && sphereInFrustum(frustum, c, r);
+        visible[i - begin] = in ? 1 : 0;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// per-frame stage
+
+static Frustum frameFrustum;
+static glm::vec3 frameEye(0.0f);
+static float frameMaxDistance = 1e30f;
+static CullStats frameStats;
+static std::atomic<int> pendingTested[CULL_CATEGORY_COUNT];
+static std::atomic<int> pendingCulled[CULL_CATEGORY_COUNT];
+
+void beginCullFrame(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye, float maxDistance)
+{
+    frameFrustum = extractFrustum(projection * view);
+    frameEye = eye;
+    frameMaxDistance = maxDistance;
+    for (int c = 0; c < CULL_CATEGORY_COUNT; ++c) {
+        pendingTested[c] = 0;
+        pendingCulled[c] = 0;
+    }
+}
+
+void recordCulling(CullCategory category, int tested, int culled)
+{
+    pendingTested[category] += tested;
+    pendingCulled[category] += culled;
+}
+
+bool cullObject(const Bounds& b, CullCategory category)
+{
+    glm::vec3 d = b.center - frameEye;
+    float reach = frameMaxDistance + b.radius;
+    bool visible = glm::dot(d, d) <= reach * reach && sphereInFrustum(frameFrustum, b.center, b.radius);
+    recordCulling(category, 1, visible ? 0 : 1);
+    return visible;
+}
+
+size_t cullBatch(const SphereSoA& spheres, size_t count, unsigned char* visible, CullCategory category)
+{
+    cullSpheres(frameFrustum, frameEye, frameMaxDistance, spheres, 0, count, visible);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) kept += visible[i];
+    recordCulling(category, (int)count, (int)(count - kept));
+    return kept;
+}
+
+const CullStats& cullStats()
+{
+    // snapshot of everything recorded since beginCullFrame
+    for (int c = 0; c < CULL_CATEGORY_COUNT; ++c) {
+        frameStats.tested[c] = pendingTested[c];
+        frameStats.culled[c] = pendingCulled[c];
+    }
+    return frameStats;
+}
+
+const char* cullCategoryName(CullCategory category)
+{
+    switch (category) {
+    case CULL_MAP:    return "map";
+    case CULL_AVATAR: return "avatar";
+    case CULL_PINS:   return "pins";
+    case CULL_CROWD:  return "crowd";
+    default:          return "?";
+    }
+}
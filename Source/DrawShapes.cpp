@@ -7,9 +7,6 @@ extern unsigned personalInformationTexture;
 extern unsigned mapTexture;
 extern unsigned pinTexture;
 
-// read-only global used to decide which texture to draw for the top-left pin
-extern bool pinShowsStanding;
-
 extern unsigned standingManTexture;
 extern unsigned standingManTextureRight;
 extern unsigned standingManTextureRightAlt;
@@ -25,13 +22,6 @@ extern float lowerOpacity;
 extern float fullOpacity;
 
 
-extern float mapOffsetX;
-extern float mapOffsetY;
-extern float mapTexScale;
-
-extern int standingManState;
-extern int standingManAnimFrame;
-
 void setupShader(unsigned int shader,
     int texture,
     float x,
@@ -62,8 +52,8 @@ void drawRect(unsigned int rectShader, unsigned int VAOrect) {
 }
 
 // Legacy 2D fullscreen map draw (keeps compatibility with any code still calling drawMap)
-void drawMap(unsigned int rectShader, unsigned int VAOmap) {
-    setupShader(rectShader, 0, 0.0f, 0.0f, 1.0f, fullOpacity, mapOffsetX, mapOffsetY, mapTexScale);
+void drawMap(unsigned int rectShader, unsigned int VAOmap, const ViewState& view) {
+    setupShader(rectShader, 0, 0.0f, 0.0f, 1.0f, fullOpacity, view.mapOffsetX, view.mapOffsetY, view.mapTexScale);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, mapTexture);
@@ -71,15 +61,15 @@ void drawMap(unsigned int rectShader, unsigned int VAOmap) {
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 }
 
-// New: draw the 3D map plane. Caller must set uM/uV/uP and uTexOffset/uTexScale before calling.
-// This function binds the map texture and issues the draw call.
-void drawMap3D(unsigned int mapShader, unsigned int VAOmap) {
+// New: draw the 3D map plane. Caller must set uM/uV/uP before calling.
+// This function sets the texture pan/scale, binds the map texture and issues the draw call.
+void drawMap3D(unsigned int mapShader, unsigned int VAOmap, const ViewState& view) {
     glUseProgram(mapShader);
     // ensure the shader samples texture unit 0
     glUniform1i(glGetUniformLocation(mapShader, "uTex0"), 0);
-    // texture pan/scale uniforms may already be set by caller; setting again is harmless
-    glUniform2f(glGetUniformLocation(mapShader, "uTexOffset"), mapOffsetX, mapOffsetY);
-    glUniform1f(glGetUniformLocation(mapShader, "uTexScale"), mapTexScale);
+    // texture pan/scale
+    glUniform2f(glGetUniformLocation(mapShader, "uTexOffset"), view.mapOffsetX, view.mapOffsetY);
+    glUniform1f(glGetUniformLocation(mapShader, "uTexScale"), view.mapTexScale);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, mapTexture);
@@ -88,27 +78,27 @@ void drawMap3D(unsigned int mapShader, unsigned int VAOmap) {
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 }
 
-void drawStandinMan(unsigned int rectShader, unsigned int VAOstandingMan) {
+void drawStandinMan(unsigned int rectShader, unsigned int VAOstandingMan, const AvatarState& avatar) {
     setupShader(rectShader);
 
     glActiveTexture(GL_TEXTURE0);
-    if (standingManState == 1) {
-        if (standingManAnimFrame == 0) {
+    if (avatar.spriteState == 1) {
+        if (avatar.spriteFrame == 0) {
             glBindTexture(GL_TEXTURE_2D, standingManTextureRight);
         }
         else {
             glBindTexture(GL_TEXTURE_2D, standingManTextureRightAlt);
         }
-    } else if (standingManState == 2) { 
-        if (standingManAnimFrame == 0) glBindTexture(GL_TEXTURE_2D, standingManTextureLeft);
+    } else if (avatar.spriteState == 2) { 
+        if (avatar.spriteFrame == 0) glBindTexture(GL_TEXTURE_2D, standingManTextureLeft);
         else                           glBindTexture(GL_TEXTURE_2D, standingManTextureLeftAlt);
-    } else if (standingManState == 3) {
+    } else if (avatar.spriteState == 3) {
         // moving up
-        if (standingManAnimFrame == 0) glBindTexture(GL_TEXTURE_2D, standingManTextureUp);
+        if (avatar.spriteFrame == 0) glBindTexture(GL_TEXTURE_2D, standingManTextureUp);
         else                           glBindTexture(GL_TEXTURE_2D, standingManTextureUpAlt);
-    } else if (standingManState == 4) {
+    } else if (avatar.spriteState == 4) {
         // moving down
-        if (standingManAnimFrame == 0) glBindTexture(GL_TEXTURE_2D, standingManTextureDown);
+        if (avatar.spriteFrame == 0) glBindTexture(GL_TEXTURE_2D, standingManTextureDown);
         else                           glBindTexture(GL_TEXTURE_2D, standingManTextureDownAlt);
     } else {
         glBindTexture(GL_TEXTURE_2D, standingManTexture); // default/idle
@@ -119,12 +109,12 @@ void drawStandinMan(unsigned int rectShader, unsigned int VAOstandingMan) {
 }
 
 
-void drawTopPin(unsigned int rectShader, unsigned int VAOtopPin, unsigned int VAOtopPinWide) {
+void drawTopPin(unsigned int rectShader, unsigned int VAOtopPin, unsigned int VAOtopPinWide, const ViewState& view) {
     setupShader(rectShader);
 
     glActiveTexture(GL_TEXTURE0);
     // bind either the pin icon or the standing-man texture depending on toggle
-    if (pinShowsStanding) {
+    if (view.pinShowsStanding) {
         glBindTexture(GL_TEXTURE_2D, standingManTexture);
         glBindVertexArray(VAOtopPinWide); // use wider VAO for standing-man
     }
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <chrono>
+
+#include "../Header/InputQueue.h"
+#include "../Header/Callbacks.h"
+
+static SpscRing<InputEvent, INPUT_QUEUE_CAPACITY> ring;
+static std::atomic<uint64_t> droppedEvents{ 0 };
+
+// consumer side
+static int64_t oldestDrainedUs = -1;   // oldest event handled this frame (-1 = none)
+static double frameLatencyMs[INPUT_LATENCY_HISTORY];
+static int latencyCount = 0, latencyNext = 0;
+static InputLatencyStats stats;
+
+int64_t inputClockUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool pushInputEvent(InputEvent event)
+{
+    event.arrivedUs = inputClockUs();
+    if (ring.push(event)) return true;
+    droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void drainInputEvents(GLFWwindow* window)
+{
+    InputEvent e;
+    while (ring.pop(e)) {
+        switch (e.type) {
+        case INPUT_EVENT_KEY:    key_callback(window, e.code, e.scancode, e.action, e.mods); break;
+        case INPUT_EVENT_BUTTON: center_callback(window, e.code, e.action, e.mods, e.x, e.y); break;
+        case INPUT_EVENT_CURSOR: mouse_move_callback(window, e.x, e.y); break;
+        case INPUT_EVENT_SCROLL: scroll_callback(window, e.x, e.y); break;
+        default: break;
+        }
+        if (oldestDrainedUs < 0 || e.arrivedUs < oldestDrainedUs) oldestDrainedUs = e.arrivedUs;
+        stats.events++;
+    }
+}
+
+void notePolledInputChange(int64_t arrivedUs)
+{
+    if (oldestDrainedUs < 0 || arrivedUs < oldestDrainedUs) oldestDrainedUs = arrivedUs;
+    stats.events++;
+}
+
+bool inputPendingPresent()
+{
+    return oldestDrainedUs >= 0;
+}
+
+void resetInputLatencyStats()
+{
+    latencyCount = latencyNext = 0;
+    stats.lastMs = stats.avgMs = stats.maxMs = 0.0;
+}
+
+void inputEventsPresented()
+{
+    stats.dropped = droppedEvents.load(std::memory_order_relaxed);
+    if (oldestDrainedUs < 0) return;
+
+    const double ms = (inputClockUs() - oldestDrainedUs) / 1000.0;
+    oldestDrainedUs = -1;
+    frameLatencyMs[latencyNext] = ms;
+    latencyNext = (latencyNext + 1) % INPUT_LATENCY_HISTORY;
+    latencyCount = std::min(latencyCount + 1, INPUT_LATENCY_HISTORY);
+
+    double sum = 0.0, peak = 0.0;
+    for (int i = 0; i < latencyCount; ++i) {
+        sum += frameLatencyMs[i];
+        peak = std::max(peak, frameLatencyMs[i]);
+    }
+    stats.lastMs = ms;
+    stats.avgMs = sum / latencyCount;
+    stats.maxMs = peak;
+}
+
+const InputLatencyStats& inputLatencyStats()
+{
+    return stats;
+}
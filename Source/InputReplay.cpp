@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "../Header/InputReplay.h"
+#include "../Header/InputQueue.h"
+
+#define INPUT_LOG_VERSION 2
+
+enum InputRecordType : uint8_t {
+    REC_FRAME = 1,   // f32 dt, u16 polled key bits, i16 x4 sticks (move x / y, look x / y; version 2)
+    REC_KEY,         // i16 key, i32 scancode, u8 action, u8 mods
+    REC_BUTTON,      // u8 button, u8 action, u8 mods, f64 x, f64 y (cursor at the click)
+    REC_CURSOR,      // f64 x, f64 y
+    REC_SCROLL       // f64 x, f64 y
+};
+
+// keys the movement code polls with inputKeyDown; their state goes into every FRAME record
+static const int polledKeys[] = {
+    GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D,
+    GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_RIGHT
+};
+static const int polledKeyCount = sizeof(polledKeys) / sizeof(polledKeys[0]);
+
+// gamepad buttons -> the keyboard shortcut they press
+static const struct { int button; int key; } padButtonKeys[] = {
+    { GLFW_GAMEPAD_BUTTON_START, GLFW_KEY_R },                 // overview
+    { GLFW_GAMEPAD_BUTTON_Y, GLFW_KEY_T },                     // walk the route
+    { GLFW_GAMEPAD_BUTTON_X, GLFW_KEY_P },                     // fly-through
+    { GLFW_GAMEPAD_BUTTON_BACK, GLFW_KEY_N },                  // minimap
+    { GLFW_GAMEPAD_BUTTON_LEFT_BUMPER, GLFW_KEY_LEFT_BRACKET }, // route speed
+    { GLFW_GAMEPAD_BUTTON_RIGHT_BUMPER, GLFW_KEY_RIGHT_BRACKET }
+};
+static const struct { int button; int key; } padDpadKeys[] = {
+    { GLFW_GAMEPAD_BUTTON_DPAD_UP, GLFW_KEY_UP }, { GLFW_GAMEPAD_BUTTON_DPAD_DOWN, GLFW_KEY_DOWN },
+    { GLFW_GAMEPAD_BUTTON_DPAD_LEFT, GLFW_KEY_LEFT }, { GLFW_GAMEPAD_BUTTON_DPAD_RIGHT, GLFW_KEY_RIGHT }
+};
+
+static InputSessionMode mode = INPUT_LIVE;
+static std::chrono::steady_clock::time_point sessionStart;
+
+// record
+static FILE* logFile = nullptr;
+static int framesSinceFlush = 0;
+
+// replay
+static std::vector<uint8_t> replayData;
+static size_t replayPos = 0;
+static bool replayDone = false;
+static bool dispatching = false;       // true while feeding logged events (live ones are dropped otherwise)
+static uint16_t replayKeys = 0;
+static double replayCursorX = 0.0, replayCursorY = 0.0;
+static int recordedWinW = 0, recordedWinH = 0;
+static uint32_t replayVersion = INPUT_LOG_VERSION;
+
+// gamepad
+static GamepadInput framePad;                 // this frame's (recorded) sticks
+static unsigned char padButtons[GLFW_GAMEPAD_BUTTON_DPAD_LEFT + 1] = {}; // last seen, for press / release edges
+static bool padWasConnected = false;
+
+// replay frame timing (wall clock between frame starts)
+static std::vector<float> replayFrameMs;
+static std::chrono::steady_clock::time_point lastFrameStart;
+static bool haveLastFrame = false;
+
+static uint32_t sessionMicros()
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sessionStart).count();
+    return (uint32_t)us;
+}
+
+// ---- writing ----
+
+template <typename T>
+static void put(const T& value)
+{
+    std::fwrite(&value, sizeof(T), 1, logFile);
+}
+
+static void beginRecord(InputRecordType type)
+{
+    put((uint8_t)type);
+    put(sessionMicros());
+}
+
+// ---- reading ----
+
+template <typename T>
+static bool get(T& value)
+{
+    if (replayPos + sizeof(T) > replayData.size()) {
+        replayPos = replayData.size();
+        return false;
+    }
+    std::memcpy(&value, &replayData[replayPos], sizeof(T));
+    replayPos += sizeof(T);
+    return true;
+}
+
+static int keyBit(int key)
+{
+    for (int i = 0; i < polledKeyCount; ++i)
+        if (polledKeys[i] == key) return i;
+    return -1;
+}
+
+// ---- gamepad ----
+
+static float quantizeAxis(float v)
+{
+    return (float)(int16_t)std::lround(std::max(-1.0f, std::min(1.0f, v)) * 32767.0f) / 32767.0f;
+}
+
+// radial dead zone, rescaled so the stick still reaches 1 at the edge
+static void applyDeadzone(float& x, float& y)
+{
+    const float len = std::sqrt(x * x + y * y);
+    if (len <= GAMEPAD_DEADZONE) { x = y = 0.0f; return; }
+    const float scale = std::min(1.0f, (len - GAMEPAD_DEADZONE) / (1.0f - GAMEPAD_DEADZONE)) / len;
+    x = quantizeAxis(x * scale);
+    y = quantizeAxis(y * scale);
+}
+
+static void recordingKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// Live read; button edges go out as key events (so they are recorded and replayed like the keyboard).
+static GamepadInput readGamepad(GLFWwindow* window)
+{
+    GamepadInput pad;
+    GLFWgamepadstate state;
+    int jid = GLFW_JOYSTICK_1;
+    for (; jid <= GLFW_JOYSTICK_LAST; ++jid)
+        if (glfwJoystickIsGamepad(jid) && glfwGetGamepadState(jid, &state)) break;
+    if (jid > GLFW_JOYSTICK_LAST) {
+        if (padWasConnected) std::cout << "Input: gamepad disconnected" << std::endl;
+        padWasConnected = false;
+        std::memset(padButtons, 0, sizeof(padButtons));
+        return pad;
+    }
+    if (!padWasConnected) std::cout << "Input: gamepad " << glfwGetGamepadName(jid) << std::endl;
+    padWasConnected = true;
+
+    pad.connected = true;
+    pad.moveX = state.axes[GLFW_GAMEPAD_AXIS_LEFT_X];
+    pad.moveY = -state.axes[GLFW_GAMEPAD_AXIS_LEFT_Y]; // GLFW: down is +
+    pad.lookX = state.axes[GLFW_GAMEPAD_AXIS_RIGHT_X];
+    pad.lookY = -state.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y];
+    applyDeadzone(pad.moveX, pad.moveY);
+    applyDeadzone(pad.lookX, pad.lookY);
+
+    for (const auto& b : padButtonKeys) {
+        if (state.buttons[b.button] == padButtons[b.button]) continue;
+        padButtons[b.button] = state.buttons[b.button];
+        recordingKeyCallback(window, b.key, 0, state.buttons[b.button] ? GLFW_PRESS : GLFW_RELEASE, 0);
+    }
+    for (const auto& d : padDpadKeys) padButtons[d.button] = state.buttons[d.button];
+    return pad;
+}
+
+static bool dpadDown(int key)
+{
+    if (!padWasConnected) return false;
+    for (const auto& d : padDpadKeys)
+        if (d.key == key) return padButtons[d.button] == GLFW_PRESS;
+    return false;
+}
+
+// ---- callbacks: log, then queue for the frame (live events are dropped during a replay) ----
+
+static void recordingKeyCallback(GLFWwindow* /*window*/, int key, int scancode, int action, int mods)
+{
+    if (mode == INPUT_REPLAY && !dispatching) return;
+    if (mode == INPUT_RECORD) {
+        beginRecord(REC_KEY);
+        put((int16_t)key); put((int32_t)scancode); put((uint8_t)action); put((uint8_t)mods);
+    }
+    InputEvent e;
+    e.type = INPUT_EVENT_KEY;
+    e.code = (int16_t)key; e.scancode = scancode; e.action = (uint8_t)action; e.mods = (uint8_t)mods;
+    pushInputEvent(e);
+}
+
+static void recordingButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    if (mode == INPUT_REPLAY && !dispatching) return;
+    double x = 0.0, y = 0.0;
+    inputCursorPos(window, &x, &y); // the recorded one during a replay
+    if (mode == INPUT_RECORD) {
+        beginRecord(REC_BUTTON);
+        put((uint8_t)button); put((uint8_t)action); put((uint8_t)mods); put(x); put(y);
+    }
+    InputEvent e;
+    e.type = INPUT_EVENT_BUTTON;
+    e.code = (int16_t)button; e.action = (uint8_t)action; e.mods = (uint8_t)mods; e.x = x; e.y = y;
+    pushInputEvent(e);
+}
+
+static void recordingCursorCallback(GLFWwindow* /*window*/, double x, double y)
+{
+    if (mode == INPUT_REPLAY && !dispatching) return;
+    if (mode == INPUT_RECORD) {
+        beginRecord(REC_CURSOR);
+        put(x); put(y);
+    }
+    InputEvent e;
+    e.type = INPUT_EVENT_CURSOR;
+    e.x = x; e.y = y;
+    pushInputEvent(e);
+}
+
+static void recordingScrollCallback(GLFWwindow* /*window*/, double x, double y)
+{
+    if (mode == INPUT_REPLAY && !dispatching) return;
+    if (mode == INPUT_RECORD) {
+        beginRecord(REC_SCROLL);
+        put(x); put(y);
+    }
+    InputEvent e;
+    e.type = INPUT_EVENT_SCROLL;
+    e.x = x; e.y = y;
+    pushInputEvent(e);
+}
+
+// ---- session ----
+
+bool startInputRecording(const char* path)
+{
+    logFile = std::fopen(path, "wb");
+    if (!logFile) {
+        std::cout << "Input: cannot open " << path << " for recording" << std::endl;
+        return false;
+    }
+    std::setvbuf(logFile, nullptr, _IOFBF, 1 << 16);
+    mode = INPUT_RECORD;
+    sessionStart = std::chrono::steady_clock::now();
+    std::cout << "Input: recording to " << path << std::endl;
+    return true;
+}
+
+bool openInputReplay(const char* path, int& framebufferW, int& framebufferH)
+{
+    FILE* f = std::fopen(path, "rb");
+    if (!f) {
+        std::cout << "Input: cannot open " << path << " for replay" << std::endl;
+        return false;
+    }
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    replayData.resize(size > 0 ? (size_t)size : 0);
+    size_t got = replayData.empty() ? 0 : std::fread(replayData.data(), 1, replayData.size(), f);
+    std::fclose(f);
+    replayData.resize(got);
+
+    char magic[4] = {};
+    uint32_t version = 0;
+    int32_t fbW = 0, fbH = 0, winW = 0, winH = 0;
+    replayPos = 0;
+    for (char& c : magic) get(c);
+    if (std::memcmp(magic, "KINP", 4) != 0 || !get(version) || version < 1 || version > INPUT_LOG_VERSION ||
+        !get(fbW) || !get(fbH) || !get(winW) || !get(winH)) {
+        std::cout << "Input: " << path << " is not an input log (or a different version)" << std::endl;
+        replayData.clear();
+        return false;
+    }
+    replayVersion = version;
+    framebufferW = fbW;
+    framebufferH = fbH;
+    recordedWinW = winW;
+    recordedWinH = winH;
+    mode = INPUT_REPLAY;
+    sessionStart = std::chrono::steady_clock::now();
+    std::cout << "Input: replaying " << path << " (" << fbW << " x " << fbH << ")" << std::endl;
+    return true;
+}
+
+InputSessionMode inputSessionMode()
+{
+    return mode;
+}
+
+void installInputCallbacks(GLFWwindow* window)
+{
+    glfwSetKeyCallback(window, recordingKeyCallback);
+    glfwSetMouseButtonCallback(window, recordingButtonCallback);
+    glfwSetCursorPosCallback(window, recordingCursorCallback);
+    glfwSetScrollCallback(window, recordingScrollCallback);
+
+    if (mode == INPUT_RECORD) {
+        int fbW = 0, fbH = 0, winW = 0, winH = 0;
+        glfwGetFramebufferSize(window, &fbW, &fbH);
+        glfwGetWindowSize(window, &winW, &winH);
+        std::fwrite("KINP", 1, 4, logFile);
+        put((uint32_t)INPUT_LOG_VERSION);
+        put((int32_t)fbW); put((int32_t)fbH); put((int32_t)winW); put((int32_t)winH);
+    }
+}
+
+// Feed the logged events up to the next FRAME record.
+static void dispatchLoggedEvents(GLFWwindow* window)
+{
+    dispatching = true;
+    while (replayPos < replayData.size() && replayData[replayPos] != REC_FRAME) {
+        uint8_t type = 0;
+        uint32_t us = 0;
+        get(type);
+        get(us);
+        switch (type) {
+        case REC_KEY: {
+            int16_t key = 0; int32_t scancode = 0; uint8_t action = 0, mods = 0;
+            get(key); get(scancode); get(action); get(mods);
+            recordingKeyCallback(window, key, scancode, action, mods);
+            break;
+        }
+        case REC_BUTTON: {
+            uint8_t button = 0, action = 0, mods = 0;
+            get(button); get(action); get(mods); get(replayCursorX); get(replayCursorY);
+            recordingButtonCallback(window, button, action, mods);
+            break;
+        }
+        case REC_CURSOR: {
+            get(replayCursorX); get(replayCursorY);
+            recordingCursorCallback(window, replayCursorX, replayCursorY);
+            break;
+        }
+        case REC_SCROLL: {
+            double x = 0.0, y = 0.0;
+            get(x); get(y);
+            recordingScrollCallback(window, x, y);
+            break;
+        }
+        default:
+            std::cout << "Input: corrupt record (type " << (int)type << "), replay stopped" << std::endl;
+            replayPos = replayData.size();
+            break;
+        }
+    }
+    dispatching = false;
+}
+
+float inputBeginFrame(GLFWwindow* window, float measuredDt)
+{
+    if (mode != INPUT_REPLAY) framePad = readGamepad(window);
+    if (mode == INPUT_RECORD) {
+        uint16_t keys = 0;
+        for (int i = 0; i < polledKeyCount; ++i)
+            if (inputKeyDown(window, polledKeys[i])) keys |= (uint16_t)(1u << i);
+        beginRecord(REC_FRAME);
+        put(measuredDt); put(keys);
+        for (float axis : { framePad.moveX, framePad.moveY, framePad.lookX, framePad.lookY })
+            put((int16_t)std::lround(axis * 32767.0f));
+        // a kiosk may be switched off rather than closed: keep the log at most ~1 s behind
+        if (++framesSinceFlush >= 75) {
+            std::fflush(logFile);
+            framesSinceFlush = 0;
+        }
+        return measuredDt;
+    }
+    if (mode != INPUT_REPLAY) return measuredDt;
+
+    auto now = std::chrono::steady_clock::now();
+    if (haveLastFrame) replayFrameMs.push_back(std::chrono::duration<float, std::milli>(now - lastFrameStart).count());
+    lastFrameStart = now;
+    haveLastFrame = true;
+
+    // next FRAME record (inputPollEvents normally stopped right in front of it)
+    dispatchLoggedEvents(window);
+    uint8_t type = 0;
+    uint32_t us = 0;
+    float dt = 0.0f;
+    if (!get(type) || type != REC_FRAME || !get(us) || !get(dt) || !get(replayKeys)) {
+        replayDone = true;
+        replayKeys = 0;
+        framePad = GamepadInput();
+        return 0.0f;
+    }
+    framePad = GamepadInput();
+    if (replayVersion >= 2) {
+        int16_t axes[4] = {};
+        for (int16_t& a : axes) get(a);
+        framePad.moveX = axes[0] / 32767.0f;
+        framePad.moveY = axes[1] / 32767.0f;
+        framePad.lookX = axes[2] / 32767.0f;
+        framePad.lookY = axes[3] / 32767.0f;
+        framePad.connected = axes[0] || axes[1] || axes[2] || axes[3];
+    }
+    return dt;
+}
+
+void inputPollEvents(GLFWwindow* window)
+{
+    glfwPollEvents(); // keeps the window responsive; during a replay the wrappers drop these events
+    if (mode != INPUT_REPLAY || replayDone) return;
+    dispatchLoggedEvents(window);
+    if (replayPos >= replayData.size()) replayDone = true;
+}
+
+bool inputKeyDown(GLFWwindow* window, int key)
+{
+    if (mode == INPUT_REPLAY) {
+        int bit = keyBit(key);
+        if (bit >= 0) return (replayKeys >> bit) & 1u;
+    }
+    return glfwGetKey(window, key) == GLFW_PRESS || dpadDown(key);
+}
+
+void inputCursorPos(GLFWwindow* window, double* x, double* y)
+{
+    if (mode == INPUT_REPLAY) {
+        *x = replayCursorX;
+        *y = replayCursorY;
+        return;
+    }
+    glfwGetCursorPos(window, x, y);
+}
+
+void inputWindowSize(GLFWwindow* window, int* width, int* height)
+{
+    if (mode == INPUT_REPLAY && recordedWinW > 0 && recordedWinH > 0) {
+        *width = recordedWinW;
+        *height = recordedWinH;
+        return;
+    }
+    glfwGetWindowSize(window, width, height);
+}
+
+const GamepadInput& inputGamepad()
+{
+    return framePad;
+}
+
+GamepadInput inputSampleGamepad(GLFWwindow* window)
+{
+    if (mode == INPUT_REPLAY) return framePad;
+    return readGamepad(window);
+}
+
+bool inputReplayFinished()
+{
+    return mode == INPUT_REPLAY && replayDone;
+}
+
+void finishInputSession()
+{
+    if (mode == INPUT_RECORD && logFile) {
+        std::fclose(logFile);
+        logFile = nullptr;
+        std::cout << "Input: recording closed" << std::endl;
+    }
+    if (mode == INPUT_REPLAY && !replayFrameMs.empty()) {
+        std::vector<float> sorted = replayFrameMs;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (float ms : sorted) sum += ms;
+        auto pct = [&](double p) { return sorted[(size_t)(p * (sorted.size() - 1))]; };
+        std::printf("replay: %zu frames, avg %.3f ms, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f ms\n",
+                    sorted.size(), sum / sorted.size(), pct(0.50), pct(0.95), pct(0.99), sorted.back());
+    }
+    mode = INPUT_LIVE;
+}
@@ -0,0 +1,260 @@
+#include <GL/glew.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../Header/Lighting.h"
+#include "../Header/ThreadPool.h"
+
+// one texture buffer = GL buffer + texture view of it
+struct LightBuffer {
+    GLuint buffer = 0;
+    GLuint texture = 0;
+};
+
+// screen rectangle a light touches, in tiles (inclusive)
+struct TileRect {
+    int x0, y0, x1, y1;
+};
+
+static std::vector<PointLight> staticLights;
+static std::vector<PointLight> frameLights;
+
+static std::vector<PointLight> visibleLights;
+static std::vector<TileRect>   visibleRects;
+static std::vector<int>        tileCounts;   // per tile, up to MAX_LIGHTS_PER_TILE
+static std::vector<int>        tileSlots;    // tileCount * MAX_LIGHTS_PER_TILE, filled per row
+static std::vector<int>        tileTable;    // (offset, count) per tile
+static std::vector<int>        lightIndices; // compact
+static std::vector<glm::vec4>  lightTexels;  // 2 per light
+
+static LightBuffer lightData, tileData, indexData;
+static GLuint sceneLightUBO = 0;
+static int tilesX = 0, tilesY = 0;
+static LightingStats stats;
+
+static void createLightBuffer(LightBuffer& b)
+{
+    glGenBuffers(1, &b.buffer);
+    glGenTextures(1, &b.texture);
+}
+
+static void uploadLightBuffer(LightBuffer& b, GLenum format, const void* data, size_t bytes)
+{
+    // orphan + refill, the previous frame may still be reading the old storage
+    glBindBuffer(GL_TEXTURE_BUFFER, b.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(bytes, 16), nullptr, GL_STREAM_DRAW);
+    if (bytes) glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    glBindTexture(GL_TEXTURE_BUFFER, b.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, b.buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void initLighting()
+{
+    createLightBuffer(lightData);
+    createLightBuffer(tileData);
+    createLightBuffer(indexData);
+
+    glGenBuffers(1, &sceneLightUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneLightUBO);
+    glBufferData(GL_UNIFORM_BUFFER, 3 * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, SCENE_LIGHT_BLOCK_BINDING, sceneLightUBO);
+}
+
+void shutdownLighting()
+{
+    for (LightBuffer* b : { &lightData, &tileData, &indexData }) {
+        if (b->texture) { glDeleteTextures(1, &b->texture); b->texture = 0; }
+        if (b->buffer) { glDeleteBuffers(1, &b->buffer); b->buffer = 0; }
+    }
+    if (sceneLightUBO) { glDeleteBuffers(1, &sceneLightUBO); sceneLightUBO = 0; }
+    staticLights.clear();
+    frameLights.clear();
+}
+
+void placeStreetLights(float mapHalf, float spacing, unsigned seed)
+{
+    staticLights.clear();
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+    std::uniform_real_distribution<float> warmth(0.0f, 1.0f);
+
+    for (float z = -mapHalf + spacing * 0.5f; z < mapHalf; z += spacing) {
+        for (float x = -mapHalf + spacing * 0.5f; x < mapHalf; x += spacing) {
+            PointLight l;
+            l.position = glm::vec3(x + jitter(rng) * spacing, 0.35f, z + jitter(rng) * spacing);
+            l.radius = spacing * 0.9f;
+            // sodium orange .. warm white
+            float w = warmth(rng);
+            l.color = glm::mix(glm::vec3(1.0f, 0.62f, 0.28f), glm::vec3(1.0f, 0.9f, 0.75f), w);
+            l.intensity = 0.8f;
+            staticLights.push_back(l);
+            if ((int)staticLights.size() >= MAX_SCENE_LIGHTS) return;
+        }
+    }
+}
+
+void beginLightFrame()
+{
+    frameLights.clear();
+}
+
+void addLight(const PointLight& light)
+{
+    frameLights.push_back(light);
+}
+
+// Conservative screen rectangle of a view-space sphere. false = off screen / behind the camera.
+static bool sphereTileRect(const glm::vec3& c, float r, const glm::mat4& projection, int viewportW, int viewportH, TileRect& out)
+{
+    const float zNear = projection[3][2] / (projection[2][2] - 1.0f);
+    if (-c.z + r < zNear) return false; // entirely in front of the near plane
+
+    float ndcMinX = -1.0f, ndcMaxX = 1.0f, ndcMinY = -1.0f, ndcMaxY = 1.0f;
+    const float dNear = -c.z - r;
+    if (dNear > zNear) {
+        // x/d is monotonic in d on each side, so the extremes sit at the near or far depth of the sphere
+        const float dFar = -c.z + r;
+        const float px = projection[0][0], py = projection[1][1];
+        ndcMinX = px * std::min((c.x - r) / dNear, (c.x - r) / dFar);
+        ndcMaxX = px * std::max((c.x + r) / dNear, (c.x + r) / dFar);
+        ndcMinY = py * std::min((c.y - r) / dNear, (c.y - r) / dFar);
+        ndcMaxY = py * std::max((c.y + r) / dNear, (c.y + r) / dFar);
+    }
+    // else: the sphere crosses the near plane, it may cover any part of the screen
+
+    if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f) return false;
+
+    // gl_FragCoord convention: pixel (0,0) bottom-left
+    auto toTile = [](float ndc, int size, int tiles) {
+        int px = (int)((glm::clamp(ndc, -1.0f, 1.0f) * 0.5f + 0.5f) * size);
+        return glm::clamp(px / LIGHT_TILE_SIZE, 0, tiles - 1);
+    };
+    out.x0 = toTile(ndcMinX, viewportW, tilesX);
+    out.x1 = toTile(ndcMaxX, viewportW, tilesX);
+    out.y0 = toTile(ndcMinY, viewportH, tilesY);
+    out.y1 = toTile(ndcMaxY, viewportH, tilesY);
+    return true;
+}
+
+void buildLightTiles(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos,
+                     int viewportW, int viewportH, float maxDistance)
+{
+    auto start = std::chrono::steady_clock::now();
+    stats = LightingStats();
+    if (viewportW <= 0 || viewportH <= 0) return;
+
+    tilesX = (viewportW + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    tilesY = (viewportH + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    const int tileCount = tilesX * tilesY;
+
+    // 1) distance + screen rect per light (serial: a few thousand lights at most)
+    visibleLights.clear();
+    visibleRects.clear();
+    stats.lights = (int)(staticLights.size() + frameLights.size());
+    for (const std::vector<PointLight>* list : { &staticLights, &frameLights }) {
+        for (const PointLight& l : *list) {
+            if ((int)visibleLights.size() >= MAX_SCENE_LIGHTS) break;
+            if (glm::length(l.position - cameraPos) - l.radius > maxDistance) continue;
+            glm::vec3 c = glm::vec3(view * glm::vec4(l.position, 1.0f));
+            TileRect rect;
+            if (!sphereTileRect(c, l.radius, projection, viewportW, viewportH, rect)) continue;
+            visibleLights.push_back(l);
+            visibleRects.push_back(rect);
+        }
+    }
+    stats.visible = (int)visibleLights.size();
+
+    // 2) bin: each tile row is independent, so rows go to the workers
+    tileCounts.assign(tileCount, 0);
+    tileSlots.resize((size_t)tileCount * MAX_LIGHTS_PER_TILE);
+    workerPool().parallelFor((size_t)tilesY, 4, [&](size_t begin, size_t end) {
+        for (size_t ty = begin; ty < end; ++ty) {
+            int* counts = &tileCounts[ty * tilesX];
+            int* slots = &tileSlots[ty * tilesX * MAX_LIGHTS_PER_TILE];
+            for (int li = 0; li < (int)visibleRects.size(); ++li) {
+                const TileRect& r = visibleRects[li];
+                if ((int)ty < r.y0 || (int)ty > r.y1) continue;
+                for (int tx = r.x0; tx <= r.x1; ++tx) {
+                    int& n = counts[tx];
+                    if (n < MAX_LIGHTS_PER_TILE) slots[tx * MAX_LIGHTS_PER_TILE + n++] = li;
+                }
+            }
+        }
+    });
+
+    // 3) compact into (offset, count) + one index list
+    tileTable.resize((size_t)tileCount * 2);
+    lightIndices.clear();
+    for (int t = 0; t < tileCount; ++t) {
+        int n = tileCounts[t];
+        tileTable[t * 2 + 0] = (int)lightIndices.size();
+        tileTable[t * 2 + 1] = n;
+        lightIndices.insert(lightIndices.end(), &tileSlots[(size_t)t * MAX_LIGHTS_PER_TILE], &tileSlots[(size_t)t * MAX_LIGHTS_PER_TILE] + n);
+        stats.maxPerTile = std::max(stats.maxPerTile, n);
+        if (n == MAX_LIGHTS_PER_TILE) stats.saturatedTiles++;
+    }
+
+    lightTexels.resize(visibleLights.size() * 2);
+    for (size_t i = 0; i < visibleLights.size(); ++i) {
+        const PointLight& l = visibleLights[i];
+        lightTexels[i * 2 + 0] = glm::vec4(l.position, l.radius);
+        lightTexels[i * 2 + 1] = glm::vec4(l.color * l.intensity, 0.0f);
+    }
+
+    uploadLightBuffer(lightData, GL_RGBA32F, lightTexels.data(), lightTexels.size() * sizeof(glm::vec4));
+    uploadLightBuffer(tileData, GL_RG32I, tileTable.data(), tileTable.size() * sizeof(int));
+    uploadLightBuffer(indexData, GL_R32I, lightIndices.data(), lightIndices.size() * sizeof(int));
+
+    stats.binMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void bindLightTiles(unsigned program)
+{
+    glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, lightData.texture);
+    glActiveTexture(GL_TEXTURE0 + LIGHT_TILE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, tileData.texture);
+    glActiveTexture(GL_TEXTURE0 + LIGHT_INDEX_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, indexData.texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUniform1i(glGetUniformLocation(program, "uLights"), LIGHT_DATA_UNIT);
+    glUniform1i(glGetUniformLocation(program, "uTileLights"), LIGHT_TILE_UNIT);
+    glUniform1i(glGetUniformLocation(program, "uLightIndex"), LIGHT_INDEX_UNIT);
+    glUniform1i(glGetUniformLocation(program, "uTileSize"), LIGHT_TILE_SIZE);
+    glUniform1i(glGetUniformLocation(program, "uTilesX"), tilesX);
+}
+
+const LightingStats& lightingStats()
+{
+    return stats;
+}
+
+void bindSceneLightBlock(unsigned program)
+{
+    GLuint blockIndex = glGetUniformBlockIndex(program, "SceneLightBlock");
+    if (blockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, blockIndex, SCENE_LIGHT_BLOCK_BINDING);
+}
+
+void uploadSceneLight(const SceneLightState& light)
+{
+    if (!sceneLightUBO) return;
+    // std140: (position, radius), (color, intensity), (direction, unused)
+    const glm::vec4 block[3] = {
+        glm::vec4(light.pos, light.radius),
+        glm::vec4(light.color, light.intensity),
+        glm::vec4(light.dir, 0.0f)
+    };
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneLightUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), glm::value_ptr(block[0]));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -6,6 +6,10 @@
 #include <utility>
 #include <cfloat>
 #include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <future>
+#include <memory>
 #include "../Header/stb_easy_font.h"
 
 #include "../Header/Util.h"
@@ -14,7 +18,9 @@
 #include "../Header/CreateVAOs.h"
 #include "../Header/Text.h"
 #include "../Header/OverlayDraw.h"
+#include "../Header/TextureCache.h"
 #include "../Header/Globals.h" 
+#include "../Header/SceneState.h"
 #include "../Header/SupermanGlobals.h" 
 
 #include <glm/glm.hpp>
@@ -23,6 +29,28 @@
 
 #include "../Header/model.hpp"
 #include "../Header/Measurement3D.h"
+#include "../Header/Animation.h"
+#include "../Header/Crowd.h"
+#include "../Header/Benchmark.h"
+#include "../Header/Culling.h"
+#include "../Header/ShaderCache.h"
+#include "../Header/ShaderReload.h"
+#include "../Header/Lighting.h"
+#include "../Header/Shadow.h"
+#include "../Header/PostProcess.h"
+#include "../Header/Profiler.h"
+#include "../Header/InputReplay.h"
+#include "../Header/Simulation.h"
+#include "../Header/InputQueue.h"
+#include "../Header/Minimap.h"
+#include "../Header/CameraPath.h"
+#include "../Header/NavGrid.h"
+#include "../Header/RouteTrack.h"
+#include "../Header/Session.h"
+#include "../Header/Startup.h"
+
+// camera, avatar, measurements, toggles: written by the callbacks (through the window user pointer)
+static SceneState scene;
 
 // runtime model switching support
 static Model* activeModel = nullptr;
@@ -34,89 +62,93 @@ static float activeModelScale = 1.0f;
 static float activeModelYawOffsetDeg = 0.0f;
 static float activeModelPitchOffsetDeg = 0.0f;
 
-// helper: load model and compute center/scale similar to previous code
-static void loadActiveModel(const std::string& filepath, const float desiredHeight = 1.5f)
+// skeletal playback for the active model (palettes sampled on animationWorker)
+static Animator activeAnimator;
+static AnimationWorker animationWorker;
+
+// crowd mode: far LOD stand-in for the active model, rebuilt with it
+static Mesh* crowdProxyMesh = nullptr;
+static float activeModelRadius = 1.0f; // bounding sphere radius after scaling (world units)
+static Bounds activeModelBounds;        // model-space culling bounds (posed + import bounds, padded for animation)
+static float activeModelHeight = 1.0f; // height after scaling (world units), for screen-size LOD
+static int   activeModelLod = 0;       // current LOD of the avatar (kept between frames for hysteresis)
+
+static const float CAMERA_FOV_Y = glm::radians(45.0f);
+
+// helper: make `model` the active one and compute center/scale similar to previous code
+static void activateModel(Model* model, const float desiredHeight)
 {
+    // the worker may still be sampling the old skeleton
+    animationWorker.wait();
+
     if (activeModel) {
         delete activeModel;
         activeModel = nullptr;
     }
 
-    activeModel = new Model(filepath);
-
-    // compute bounding box
-    glm::vec3 bbMin(FLT_MAX), bbMax(-FLT_MAX);
-    for (const Mesh &mesh : activeModel->meshes) {
-        for (const Vertex &v : mesh.vertices) {
-            bbMin.x = std::min(bbMin.x, v.Position.x);
-            bbMin.y = std::min(bbMin.y, v.Position.y);
-            bbMin.z = std::min(bbMin.z, v.Position.z);
-            bbMax.x = std::max(bbMax.x, v.Position.x);
-            bbMax.y = std::max(bbMax.y, v.Position.y);
-            bbMax.z = std::max(bbMax.z, v.Position.z);
+    activeModel = model;
+    activeModel->upload(); // GL half of a model imported on a worker (no-op otherwise)
+
+    // play the first clip (if the file has one); static models keep the bind pose
+    const AnimationClip* clip = activeModel->animations.empty() ? nullptr : &activeModel->animations[0];
+    resetAnimator(activeAnimator, activeModel->hasSkeleton() ? &activeModel->skeleton : nullptr, clip);
+
+    // skinned meshes are drawn through their bone palette, so measure the posed (frame 0) mesh
+    if (activeAnimator.skeleton) {
+        advanceAnimator(activeAnimator, 0.0f);
+        activeAnimator.front ^= 1;
+    }
+
+    // compute bounding box (static models already have theirs from import)
+    glm::vec3 bbMin = activeModel->bounds.min, bbMax = activeModel->bounds.max;
+    if (activeAnimator.skeleton) {
+        bbMin = glm::vec3(FLT_MAX);
+        bbMax = glm::vec3(-FLT_MAX);
+        for (const Mesh &mesh : activeModel->meshes) {
+            for (const Vertex &v : mesh.vertices) {
+                glm::vec3 p = skinPosition(v, activeAnimator.currentPalette());
+                bbMin.x = std::min(bbMin.x, p.x);
+                bbMin.y = std::min(bbMin.y, p.y);
+                bbMin.z = std::min(bbMin.z, p.z);
+                bbMax.x = std::max(bbMax.x, p.x);
+                bbMax.y = std::max(bbMax.y, p.y);
+                bbMax.z = std::max(bbMax.z, p.z);
+            }
         }
     }
 
+    // culling volume: limbs swing outside the frame-0 pose while walking, so pad skinned models
+    activeModelBounds = mergeBounds(boundsFromMinMax(bbMin, bbMax), activeModel->bounds);
+    if (activeAnimator.skeleton) activeModelBounds.radius *= 1.25f;
+
     activeModelCenter = (bbMin + bbMax) * 0.5f;
     float modelHeight = (bbMax.y - bbMin.y);
     if (modelHeight <= 0.0f) modelHeight = 1.0f;
     activeModelScale = glm::clamp(desiredHeight / modelHeight, 0.001f, 10.0f);
+    activeModelRadius = glm::length(bbMax - bbMin) * 0.5f * activeModelScale;
+    activeModelHeight = modelHeight * activeModelScale;
+    activeModelLod = 0;
+
+    // crowd LODs: the full model up close, a proxy prism in the model's first material color further out
+    std::vector<Mesh*> fullMeshes;
+    for (Mesh& mesh : activeModel->meshes) fullMeshes.push_back(&mesh);
+    if (crowdProxyMesh) crowdProxyMesh->release();
+    delete crowdProxyMesh;
+    glm::vec3 proxyColor = activeModel->meshes.empty() ? glm::vec3(0.8f) : activeModel->meshes[0].diffuseColor;
+    crowdProxyMesh = new Mesh(buildCrowdProxyMesh(bbMin, bbMax, proxyColor));
+    setCrowdMeshes(fullMeshes, activeModel->lodCount(), crowdProxyMesh);
 
     // load upright.
     activeModelYawOffsetDeg = 0.0f;
     activeModelPitchOffsetDeg = 0.0f;
     activeModelYawOffsetDeg = -90.0f;
 }
-                                                                                                    
-static void updateSupermanMovement(GLFWwindow* window,
-    glm::vec3& supermanPos,
-    float& supermanYawDeg,
-    glm::vec3& prevSupermanPos,
-    float& supermanMeters,
-    float dt,
-    float moveSpeed,
-    float turnSpeed)
-{
-    glm::vec3 inputDir(0.0f);
-
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) inputDir += glm::vec3(0.0f, 0.0f, 1.0f); // forward -> +Z
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) inputDir -= glm::vec3(0.0f, 0.0f, 1.0f); // back    -> -Z
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) inputDir += glm::vec3(1.0f, 0.0f, 0.0f); // right   -> +X
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) inputDir -= glm::vec3(1.0f, 0.0f, 0.0f); // left    -> -X
 
-    if (glm::length(inputDir) > 1e-6f) {
-        glm::vec3 moveDir = glm::normalize(glm::vec3(inputDir.x, 0.0f, inputDir.z));
-
-        // desired yaw (world-space) so Superman faces movement direction
-        float desiredYaw = glm::degrees(std::atan2(moveDir.z, moveDir.x));
-
-        // shortest angular difference
-        float diff = fmodf(desiredYaw - supermanYawDeg + 540.0f, 360.0f) - 180.0f;
-
-        // clamp turn per frame for smooth rotation
-        float maxDelta = turnSpeed * dt;
-        float appliedDelta = glm::clamp(diff, -maxDelta, maxDelta);
-        supermanYawDeg += appliedDelta;
-
-        // Move along moveDir in world-space
-        supermanPos += glm::vec3(-moveDir.x, 0.0f, moveDir.z) * moveSpeed * dt;
-
-        // Clamp to plane bounds
-        const float planeScaleLocal = 20.0f;
-        const float mapHalfLocal = planeScaleLocal * 0.5f;
-        supermanPos.x = glm::clamp(supermanPos.x, -mapHalfLocal - cameraClampMargin, mapHalfLocal + cameraClampMargin);
-        supermanPos.z = glm::clamp(supermanPos.z, -mapHalfLocal - cameraClampMargin, mapHalfLocal + cameraClampMargin);
-
-        // Accumulate traveled distance (convert world units -> meters)
-        float moved = glm::length(supermanPos - prevSupermanPos);
-        if (moved > 1e-6f) {
-            supermanMeters += moved * METERS_PER_WORLD_UNIT;
-            prevSupermanPos = supermanPos;
-        }
-    }
-    // no input: keep yaw/position unchanged
+static void loadActiveModel(const std::string& filepath, const float desiredHeight = 1.5f)
+{
+    activateModel(new Model(filepath), desiredHeight);
 }
-
+                                                                                                    
 // set model lighting and related material uniforms
 static void applyModelLighting(Shader& shader, const glm::vec3& modelWorldPos, float modelScale, const glm::vec3& cameraPos, const glm::vec3& frontDir)
 {
@@ -139,6 +171,24 @@ static void applyModelLighting(Shader& shader, const glm::vec3& modelWorldPos, f
 }
 
 
+// F1..F4 debug state. The key handlers only flip the flags; the GL state changes here, on the frame, and
+// only for flags that changed (the defaults are not forced over the state set up in main).
+static void applyDebugGlState(const RenderSettings& render)
+{
+    static RenderSettings applied;
+    if (render.depthTestEnabled != applied.depthTestEnabled) {
+        if (render.depthTestEnabled) glEnable(GL_DEPTH_TEST);
+        else glDisable(GL_DEPTH_TEST);
+    }
+    if (render.faceCullingEnabled != applied.faceCullingEnabled) {
+        if (render.faceCullingEnabled) glEnable(GL_CULL_FACE);
+        else glDisable(GL_CULL_FACE);
+    }
+    if (render.cullBackFaces != applied.cullBackFaces) glCullFace(render.cullBackFaces ? GL_BACK : GL_FRONT);
+    if (render.isCCWWinding != applied.isCCWWinding) glFrontFace(render.isCCWWinding ? GL_CCW : GL_CW);
+    applied = render;
+}
+
 void formAllVAOs()
 {
     formInformationRectVAO(VAOrect);
@@ -149,27 +199,60 @@ void formAllVAOs()
 }
 
 //uzeto sa vjezbi
-void preprocessTexture(unsigned& texture, const char* filepath) {
-    texture = loadImageToTexture(filepath); // Učitavanje teksture
+void preprocessTexture(unsigned& texture, TextureSource source) {
+    // KTX2 cache: block-compressed levels with a prebuilt mip chain (no decode / glGenerateMipmap after the first run)
+    texture = uploadTextureSource(source);
     glBindTexture(GL_TEXTURE_2D, texture); // Vezujemo se za teksturu kako bismo je podesili
 
-    glGenerateMipmap(GL_TEXTURE_2D);
-
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // S - texels x
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT); // T - texels y
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    // sample the chain uploadTextureSource set BASE/MAX_LEVEL for (the map at grazing angles)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 }
 
 
+// HUD / map textures: read (or decoded) on workers from the start of main, uploaded by setupTextures
+struct StartupTexture {
+    unsigned* texture;
+    const char* path;
+    bool navGrid = false; // the walkable grid is built from these pixels
+    std::future<TextureSource> source{}; // started by startTextureReads
+};
+static StartupTexture startupTextures[] = {
+    { &personalInformationTexture, "Resources/personal-info.png" },
+    { &mapTexture, "Resources/novi-sad-map-0.jpg", true },
+    { &pinTexture, "Resources/pin-icon1.png" },
+    { &standingManTexture, "Resources/icon_standing.png" },
+};
+
+static void startTextureReads() {
+    for (StartupTexture& t : startupTextures) {
+        const char* path = t.path;
+        const bool navGrid = t.navGrid;
+        t.source = startupAsync(path, [path, navGrid] {
+            TextureSource source = readTextureSource(path);
+            if (navGrid) {
+                // one decode for both: a cache miss still uploads its pixels, a cache hit uploads the KTX2
+                // levels and decodes only for the grid
+                std::vector<unsigned char> pixels;
+                if (source.ktx2.empty()) pixels = source.rgba;
+                else if (decodeTextureSource(source)) pixels.swap(source.rgba);
+                startNavGridBuild(std::move(pixels), source.width, source.height, 10.0f);
+            }
+            return source;
+        });
+    }
+}
+
 void setupTextures() {
     //glClearColor(0.2f, 0.8f, 0.6f, 1.0f);
-    preprocessTexture(personalInformationTexture, "Resources/personal-info.png");
-    preprocessTexture(mapTexture, "Resources/novi-sad-map-0.jpg");
-    preprocessTexture(pinTexture, "Resources/pin-icon1.png");
-
-    preprocessTexture(standingManTexture, "Resources/icon_standing.png");
+    for (StartupTexture& t : startupTextures) {
+        TextureSource source = startupWait(t.path, t.source);
+        STARTUP_PHASE("texture upload");
+        preprocessTexture(*t.texture, std::move(source));
+    }
 
     /* DEPRICATED 2D
     //running little guy
@@ -198,25 +281,79 @@ void renderDistance(GLFWwindow* window) {
     int fbW = 0, fbH = 0;
     glfwGetFramebufferSize(window, &fbW, &fbH);
 
-    if (overviewMode) {
-        float effectiveSavedScale = (saved_mapTexScale > 0.0f) ? saved_mapTexScale : 1.0f;
-        float walkingEquivalentPixels = measurementDistancePixels / effectiveSavedScale;
+    if (scene.view.overviewMode) {
+        float effectiveSavedScale = (scene.saved.mapTexScale > 0.0f) ? scene.saved.mapTexScale : 1.0f;
+        float walkingEquivalentPixels = scene.measurement.distancePixels / effectiveSavedScale;
         int meters = (int)roundf(walkingEquivalentPixels * METERS_PER_PIXEL);
-        snprintf(buf, sizeof(buf), "%dm", meters);
+        if (scene.measurement.walkRouteLength > 0.0f)
+            snprintf(buf, sizeof(buf), "%dm (walk %dm)", meters, (int)roundf(scene.measurement.walkRouteLength * METERS_PER_WORLD_UNIT));
+        else
+            snprintf(buf, sizeof(buf), "%dm", meters);
         float textWidthPx = float(stb_easy_font_width(buf)) * TEXT_SCALE;
         float margin = 8.0f;
         drawText(buf, fbW - textWidthPx - margin, margin, 1.0f, 1.0f, 1.0f);
     } else {
-        int meters = (int)roundf(supermanMeters);
-        snprintf(buf, sizeof(buf), "%dm", meters);
+        int meters = (int)roundf(scene.avatar.meters);
+        if (scene.avatar.autopilot)
+            snprintf(buf, sizeof(buf), "%dm (route %d%%)", meters, (int)(scene.avatar.autopilotProgress * 100.0f));
+        else
+            snprintf(buf, sizeof(buf), "%dm", meters);
         float textWidthPx = float(stb_easy_font_width(buf)) * TEXT_SCALE;
         float margin = 8.0f;
         drawText(buf, fbW - textWidthPx - margin, margin, 1.0f, 1.0f, 1.0f);
     }
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    beginStartup();
+
+    // --record <file> / --replay <file> [--headless]: input session log, see InputReplay.h
+    // --no-session: start from the default scene and do not save it (Session.h)
+    // --startup-trace: also write the startup phases as a Chrome trace (Startup.h)
+    // --serial-startup: run the startup jobs inline on the GL thread and write the baseline (Startup.h)
+    // --startup-check: exit after the first frame, exit code 1 if the speedup over the baseline is under its target
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* startupTracePath = nullptr;
+    bool headless = false;
+    bool noSession = false;
+    bool startupCheck = false;
+    bool startupCheckFailed = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bench") == 0) return runBenchmarks();
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayPath = argv[++i];
+        else if (std::strcmp(argv[i], "--headless") == 0) headless = true;
+        else if (std::strcmp(argv[i], "--no-session") == 0) noSession = true;
+        else if (std::strcmp(argv[i], "--startup-trace") == 0) startupTracePath = "trace_startup.json";
+        else if (std::strcmp(argv[i], "--startup-check") == 0) startupCheck = true;
+        else if (std::strcmp(argv[i], "--serial-startup") == 0) setSerialStartup(true);
+    }
+
+    int replayW = 0, replayH = 0;
+    if (replayPath && !openInputReplay(replayPath, replayW, replayH)) return 1;
+    if (!replayPath) headless = false;
+    if (recordPath && !replayPath && !startInputRecording(recordPath)) return 1;
+
+    // last session's scene, before anything reads it (model size, simulation start state, first frame)
+    const bool sessionEnabled = !noSession && inputSessionMode() == INPUT_LIVE;
+    const bool sessionRestored = sessionEnabled && restoreSession(scene);
+    if (sessionRestored)
+        std::cout << "Session: restored " << SESSION_PATH << " (" << sessionStats().bytes << " bytes) in " << sessionStats().restoreMs << " ms" << std::endl;
+
+    // the CPU side of the loads runs on workers from here on, while the GL thread opens the window and
+    // builds shaders; each result is taken right where it is uploaded. The pool runs the newest job first,
+    // so they are queued in reverse order of need, the shader sources last. The walkable grid is built from
+    // the map texture's pixels, queued by its read job. With --serial-startup each job runs here instead
+    std::future<std::unique_ptr<Model>> importedModel = startupAsync("import superman.glb", [] {
+        return std::unique_ptr<Model>(new Model("Resources\\superman.glb", ModelLoad::Deferred));
+    });
+    std::future<MeasurementGeometry> pinGeometry = startupAsync("measurement meshes", buildMeasurementGeometry);
+    startTextureReads();
+    if (!serialStartup()) prefetchShaderSources(".");
+
+    const double windowStartMs = startupClockMs();
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -224,25 +361,37 @@ int main()
 
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-    screenWidth = mode->width;
-    screenHeight = mode->height;
-    GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "3D Map (walking view)", monitor, NULL);
+    GLFWwindow* window = NULL;
+    if (headless) {
+        // replay without a display: hidden window at the recorded size (the same frames get rendered)
+        screenWidth = replayW;
+        screenHeight = replayH;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(screenWidth, screenHeight, "3D Map (replay)", NULL, NULL);
+    } else {
+        screenWidth = mode->width;
+        screenHeight = mode->height;
+        window = glfwCreateWindow(screenWidth, screenHeight, "3D Map (walking view)", monitor, NULL);
+    }
     if (window == NULL) return endProgram("Prozor nije uspeo da se kreirati.");
     glfwMakeContextCurrent(window);
+    if (headless) glfwSwapInterval(0);
+    if (replayPath && (screenWidth != replayW || screenHeight != replayH))
+        std::cout << "Input: recorded at " << replayW << " x " << replayH << ", replaying at " << screenWidth << " x " << screenHeight
+                  << " (clicks map to other pixels, use --headless for an exact replay)" << std::endl;
 
-    // Set callbacks (unchanged)
-    glfwSetMouseButtonCallback(window, center_callback);
-    glfwSetKeyCallback(window, key_callback);
-    // register mouse motion callback for look-around
-    glfwSetCursorPosCallback(window, mouse_move_callback);
-    // register scroll callback to move camera vertically
-    glfwSetScrollCallback(window, scroll_callback);
+    // Set callbacks: key / mouse button / cursor (look-around) / scroll (camera height), through the input recorder.
+    // They act on the scene registered with the window.
+    resetCameraFront(scene.view);
+    glfwSetWindowUserPointer(window, &scene);
+    installInputCallbacks(window);
 
 
     cursor = loadImageToCursor("Resources/compass-icon-left.png");
     cursorPressed = loadImageToCursor("Resources/compass-icon-right.png");
     glfwSetCursor(window, cursor);
     if (glewInit() != GLEW_OK) return endProgram("GLEW nije uspeo da se inicijalizuje.");
+    recordStartupPhase("window + GL context", windowStartMs, false);
 
     // Performance / rendering state tweaks
     glEnable(GL_DEPTH_TEST);
@@ -259,90 +408,177 @@ int main()
     // make clear color brighter sky bluergb(123, 194, 252)
     glClearColor(123 / 255.0f, 194.0f / 255.0f, 252.0f / 255.0f, 1.0f);
     setupTextures();
+    const MeasurementGeometry pinMeshes = startupWait("measurement meshes", pinGeometry);
 
     // create shaders:
+    const double glSetupStartMs = startupClockMs();
     unsigned int rectShader = createShader("rect.vert", "rect.frag");     // existing 2D overlay shader
-    unsigned int map3DShader = createShader("map3d.vert", "map3d.frag");  // new 3D map shader
+    Shader map3DShader("map3d.vert", "map3d.frag");                      // new 3D map shader (variants: sun / point light, flip)
 
     // initialize measurement 3D (shader + simple meshes)
-    initMeasurement3D();
+    initMeasurement3D(pinMeshes);
+
+    // street lights over the 20 x 20 map plane, binned per screen tile every frame
+    initLighting();
+    placeStreetLights(10.0f, scene.render.streetLightSpacing);
+    map3DShader.onProgramCreated(bindSceneLightBlock);
 
     Shader modelShader("basic.vert", "basic.frag");
+    initBoneBuffer();
+    modelShader.onProgramCreated(bindBoneBlock);
+
+    Shader crowdShader("crowd.vert", "basic.frag");
+    crowdShader.onProgramCreated(bindBoneBlock);
+    initShadows(scene.render);
+    initPostProcess();
+    initMinimap();
+
+    // variants the first frames will ask for
+    for (unsigned f : { 0u, (unsigned)SHADER_USE_TEX, (unsigned)SHADER_SKINNED, (unsigned)(SHADER_SKINNED | SHADER_USE_TEX) }) {
+        modelShader.prepareFeatures(f);
+        crowdShader.prepareFeatures(f);
+    }
+    const unsigned mapFeatures = (scene.light.directional ? SHADER_LIGHT_DIRECTIONAL : 0u) | (scene.render.mapLightsEnabled ? SHADER_TILED_LIGHTS : 0u);
+    map3DShader.prepareFeatures(mapFeatures);
+    map3DShader.prepareFeatures(mapFeatures | SHADER_SHADOWS);
+    map3DShader.prepareFeatures(mapFeatures & ~SHADER_TILED_LIGHTS); // minimap (no screen tiles of its own)
 
-    loadActiveModel("Resources\\superman.glb", requestModelLoadHeight);
+    // edit a .vert/.frag while the app runs -> recompiled and swapped in between frames
+    watchShaderProgram(&rectShader, "rect.vert", "rect.frag");
+    // (Shader objects register their variants themselves)
+    recordStartupPhase("shaders + GL setup", glSetupStartMs, false);
 
-    // previous position for distance calc
-    glm::vec3 prevSupermanPos = supermanPos;
+    std::unique_ptr<Model> startupModel = startupWait("import superman.glb", importedModel);
+    {
+        STARTUP_PHASE("model upload");
+        activateModel(startupModel.release(), scene.model.loadHeight);
+    }
+    {
+        STARTUP_PHASE("VAOs + text");
+        formAllVAOs();
+        initText();
+    }
 
-    formAllVAOs();
-    initText(); 
+    const ShaderCacheStats& sc = shaderCacheStats();
+    std::cout << "Shader cache: " << sc.requests << " requests, " << sc.shared << " shared, " << sc.fromBinary << " from binary, "
+              << sc.compiled << " compiled (" << sc.binaryRejected << " stale binaries) in " << sc.totalMs << " ms" << std::endl;
 
     // start centered on map
-    mapOffsetX = (1.0f - mapTexScale) * 0.5f;
-    mapOffsetY = (1.0f - mapTexScale) * 0.5f;
+    if (!sessionRestored) {
+        scene.view.mapOffsetX = (1.0f - scene.view.mapTexScale) * 0.5f;
+        scene.view.mapOffsetY = (1.0f - scene.view.mapTexScale) * 0.5f;
+    }
 
     bool map3DUseFullTexture = false;
 
+    // camera paths report what they will show before they start: nothing is streamed in this tree, the one
+    // lazy GPU step a new view can hit is a map variant built on first use, so build those up front
+    addCameraPathPrefetch([&](const std::vector<CameraPathRegion>&) {
+        const unsigned lightFeature = scene.light.directional ? SHADER_LIGHT_DIRECTIONAL : 0u;
+        for (unsigned f : { 0u, (unsigned)SHADER_TILED_LIGHTS })
+            for (unsigned s : { 0u, (unsigned)SHADER_SHADOWS })
+                map3DShader.prepareFeatures(lightFeature | f | s);
+    });
+
     double prevTime = glfwGetTime();
+    double frameClock = 0.0; // sum of frame dts (the recorded ones in a replay)
+
+    animationWorker.start();
+    const NavGrid* startupNavGrid = nullptr;
+    {
+        StartupPhase wait("nav grid", true, true); // not part of the old startup
+        startupNavGrid = waitNavGrid();
+    }
+    startSimulation(scene, startupNavGrid);
+    int navRoutePoints = 0;          // measurement the last route was requested for
+    float navRouteDistance = 0.0f;
+    endShaderSourcePrefetch(); // from here on the watcher's reloads must see the files
+    startShaderWatcher();
+    initProfiler();
+    const double firstFrameStartMs = startupClockMs();
 
     while (!glfwWindowShouldClose(window))
     {
         double initFrameTime = glfwGetTime();
+        profilerBeginFrame();
+
+        // 3D scene goes to the HDR target (when bloom is on)
+        beginScenePass(screenWidth, screenHeight, scene.render);
+        int sceneW = screenWidth, sceneH = screenHeight; // smaller under dynamic resolution
+        sceneViewport(sceneW, sceneH);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         double now = glfwGetTime();
-        float dt = float(now - prevTime);
+        float dt = inputBeginFrame(window, float(now - prevTime)); // the recorded dt during a replay
         prevTime = now;
+        frameClock += dt;
+
+        // queued input events: the key / mouse handlers run here, before anything reads the scene
+        // (camera paths they start see this frame's projection)
+        setCameraPathLens({ CAMERA_FOV_Y, (float)screenWidth / (float)screenHeight, scene.render.drawDistance });
+        drainInputEvents(window);
+        applyDebugGlState(scene.render);
+
+        // a camera path (overview transition, fly-through) owns the camera while it plays; walking waits
+        CameraPose pathPose;
+        scene.view.cameraOnPath = updateCameraPath(dt, pathPose);
+
+        // movement keys -> simulation thread; it steps while this frame does its other work
+        SimInput simInput = pollSimInput(window, scene.view, dt);
+        simInput.autopilotSpeed = scene.autopilot.speed;
+        advanceSimulation(dt, simInput);
+
+        // frame boundary: nothing is drawing with the old programs now
+        applyShaderReloads();
+
+        // bone palettes kicked last frame are ready now
+        animationWorker.wait();
 
         // Handle any pending model-reload requests (set by key callbacks M/B).
-        if (requestReloadModel) {
-            loadActiveModel("Resources\\superman.glb", requestModelLoadHeight);
-            requestReloadModel = false;
+        if (scene.model.reloadRequested) {
+            loadActiveModel("Resources\\superman.glb", scene.model.loadHeight);
+            scene.model.reloadRequested = false;
         }
-        // Only update movement and distance when not in overview
-        if (!overviewMode) {
-            updateMapMovement(window, dt);  
-        }       
+        // camera / avatar / walk sprite from the fixed-step simulation, blended between its last two steps
+        // (a replay waits for this frame's steps so it renders the same frames every run)
+        SimSnapshot sim = sampleSimulation(inputSessionMode() == INPUT_REPLAY);
+        scene.avatar.pos = sim.avatarPos;
+        scene.avatar.yawDeg = sim.avatarYawDeg;
+        scene.avatar.meters = sim.avatarMeters;
+        scene.avatar.spriteState = sim.spriteState;
+        scene.avatar.spriteFrame = sim.spriteFrame;
+        scene.avatar.spriteTimer = sim.spriteTimer;
+        scene.avatar.autopilot = sim.autopilot;
+        scene.avatar.autopilotProgress = sim.autopilotProgress;
 
         if (map3DUseFullTexture) {
-            mapOffsetX = 0.0f;
-            mapOffsetY = 0.0f;
-            mapTexScale = 1.0f; // sample the whole texture
+            scene.view.mapOffsetX = 0.0f;
+            scene.view.mapOffsetY = 0.0f;
+            scene.view.mapTexScale = 1.0f; // sample the whole texture
         }
 
         // if in overview mode camera is fixed
-        if (!overviewMode) {
-            float camMoveSpeed = cameraSpeed * dt;
-            float yawRad = glm::radians(cameraYaw);
-            glm::vec3 forwardXZ = glm::normalize(glm::vec3(cos(yawRad), 0.0f, sin(yawRad)));
-            glm::vec3 right = glm::normalize(glm::cross(forwardXZ, cameraUp));
-
-            // Camera movement 
-            if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)    cameraPos += forwardXZ * camMoveSpeed;
-            if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)  cameraPos -= forwardXZ * camMoveSpeed;
-            if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)  cameraPos -= right * camMoveSpeed;
-            if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) cameraPos += right * camMoveSpeed;
-
-            const float planeScale = 20.0f;
-            const float mapHalf = planeScale * 0.5f;
-            cameraPos.x = glm::clamp(cameraPos.x, -mapHalf - cameraClampMargin, mapHalf + cameraClampMargin);
-            cameraPos.z = glm::clamp(cameraPos.z, -mapHalf - cameraClampMargin, mapHalf + cameraClampMargin);
-            cameraPos.y = cameraYWalking;
+        if (scene.view.cameraOnPath) {
+            scene.view.cameraPos = pathPose.position;
+            scene.view.cameraYaw = pathPose.yawDeg;
+            scene.view.cameraPitch = pathPose.pitchDeg;
+            resetCameraFront(scene.view);
+        } else if (!scene.view.overviewMode) {
+            scene.view.cameraPos = sim.cameraPos;
         } else {
-            cameraPos = glm::vec3(measureCamX, measureCamY, measureCamZ);
-            cameraFront = glm::normalize(glm::vec3(0.0f, 0.0f, 0.0f) - cameraPos);
-            cameraYaw = glm::degrees(atan2(cameraFront.z, cameraFront.x));
-            cameraPitch = glm::degrees(asin(glm::clamp(cameraFront.y, -1.0f, 1.0f)));
-            measureCamYaw = cameraYaw;
-            measureCamPitch = cameraPitch;
+            scene.view.cameraPos = glm::vec3(scene.camera.measureX, scene.camera.measureY, scene.camera.measureZ);
+            scene.view.cameraFront = glm::normalize(glm::vec3(0.0f, 0.0f, 0.0f) - scene.view.cameraPos);
+            scene.view.cameraYaw = glm::degrees(atan2(scene.view.cameraFront.z, scene.view.cameraFront.x));
+            scene.view.cameraPitch = glm::degrees(asin(glm::clamp(scene.view.cameraFront.y, -1.0f, 1.0f)));
+            scene.camera.measureYaw = scene.view.cameraYaw;
+            scene.camera.measurePitch = scene.view.cameraPitch;
         }
 
         // compute view from camera globals
-        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+        glm::mat4 view = glm::lookAt(scene.view.cameraPos, scene.view.cameraPos + scene.view.cameraFront, scene.view.cameraUp);
 
         // --- 3D map: enable depth test and render using the 3D shader ---
         glEnable(GL_DEPTH_TEST);
-        glUseProgram(map3DShader);
 
         // model matrix for the plane
         glm::mat4 model = glm::mat4(1.0f);
@@ -350,116 +586,449 @@ int main()
         model = glm::scale(model, glm::vec3(planeScale, 1.0f, planeScale));
 
         // compute projection
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)screenWidth / (float)screenHeight, 0.005f, 100.0f);
-
-        // upload matrices
-        glUniformMatrix4fv(glGetUniformLocation(map3DShader, "uM"), 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(glGetUniformLocation(map3DShader, "uV"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(map3DShader, "uP"), 1, GL_FALSE, glm::value_ptr(projection));
-
-        // pass texture pan/scale
-        glUniform2f(glGetUniformLocation(map3DShader, "uTexOffset"), mapOffsetX, mapOffsetY);
-        glUniform1f(glGetUniformLocation(map3DShader, "uTexScale"), mapTexScale);
-
-        // Disable horizontal flip
-        int flipX = 0;
-        glUniform1i(glGetUniformLocation(map3DShader, "uFlipX"), flipX);
-
-        // Upload scene light uniforms
-        GLint locLightPos       = glGetUniformLocation(map3DShader, "uLightPos");
-        GLint locLightColor     = glGetUniformLocation(map3DShader, "uLightColor");
-        GLint locLightIntensity = glGetUniformLocation(map3DShader, "uLightIntensity");
-        GLint locLightRadius    = glGetUniformLocation(map3DShader, "uLightRadius");
-        GLint locViewPos        = glGetUniformLocation(map3DShader, "uViewPos");
-        GLint locLightDir       = glGetUniformLocation(map3DShader, "uLightDir");
-        GLint locLightDirectional = glGetUniformLocation(map3DShader, "uLightDirectional");
-
-        if (locLightPos >= 0)       glUniform3f(locLightPos, sceneLightPos.x, sceneLightPos.y, sceneLightPos.z);
-        if (locLightColor >= 0)     glUniform3f(locLightColor, sceneLightColor.r, sceneLightColor.g, sceneLightColor.b);
-        if (locLightIntensity >= 0) glUniform1f(locLightIntensity, sceneLightIntensity);
-        if (locLightRadius >= 0)    glUniform1f(locLightRadius, sceneLightRadius);
-        if (locViewPos >= 0)        glUniform3f(locViewPos, cameraPos.x, cameraPos.y, cameraPos.z);
-        if (locLightDir >= 0)      glUniform3f(locLightDir, sceneLightDir.x, sceneLightDir.y, sceneLightDir.z);
-        if (locLightDirectional >= 0) glUniform1i(locLightDirectional, sceneLightDirectional ? 1 : 0);
+        glm::mat4 projection = glm::perspective(CAMERA_FOV_Y, (float)screenWidth / (float)screenHeight, 0.005f, 100.0f);
+
+        // measurement points were clicked in the R overview camera
+        const glm::mat4 pickView = glm::lookAt(glm::vec3(scene.camera.measureX, scene.camera.measureY, scene.camera.measureZ),
+                                               glm::vec3(0.0f), scene.view.cameraUp);
+
+        // walking route between the measurement points: searched on a worker when they change, shown when done
+        if ((int)scene.measurement.points.size() != navRoutePoints || scene.measurement.distancePixels != navRouteDistance) {
+            navRoutePoints = (int)scene.measurement.points.size();
+            navRouteDistance = scene.measurement.distancePixels;
+            std::vector<glm::vec2> waypoints;
+            if (navRoutePoints >= 2) {
+                int fbW = 0, fbH = 0;
+                glfwGetFramebufferSize(window, &fbW, &fbH);
+                for (const glm::vec3& p : measurementWorldPoints(pickView, projection, fbW, fbH, planeScale, scene.measurement, scene.saved))
+                    waypoints.push_back(glm::vec2(p.x, p.z));
+            } else {
+                scene.measurement.walkRoute.clear();
+                scene.measurement.walkRouteLength = 0.0f;
+            }
+            requestNavRoute(waypoints);
+        }
+        NavRoute navRoute;
+        if (takeNavRoute(navRoute)) {
+            scene.measurement.walkRoute = std::move(navRoute.points);
+            scene.measurement.walkRouteLength = navRoute.length;
+        }
 
-        // draw the 3D map plane
-        drawMap3D(map3DShader, VAOmap);
+        // T: the avatar walks from where it stands to the first point, then along the route (from the next frame)
+        if (scene.autopilot.toggleRequested) {
+            scene.autopilot.toggleRequested = false;
+            if (scene.avatar.autopilot) {
+                setSimAutopilot(nullptr);
+                std::cout << "AUTOPILOT STOPPED" << std::endl;
+            } else if (scene.measurement.points.size() < 2) {
+                std::cout << "AUTOPILOT: place at least two measurement points first (R)" << std::endl;
+            } else {
+                std::vector<glm::vec3> routePoints(1, glm::vec3(scene.avatar.pos.x, 0.0f, scene.avatar.pos.z));
+                if (scene.measurement.walkRoute.size() >= 2) {
+                    routePoints.insert(routePoints.end(), scene.measurement.walkRoute.begin(), scene.measurement.walkRoute.end());
+                } else {
+                    int fbW = 0, fbH = 0;
+                    glfwGetFramebufferSize(window, &fbW, &fbH);
+                    const std::vector<glm::vec3> straight = measurementWorldPoints(pickView, projection, fbW, fbH, planeScale, scene.measurement, scene.saved);
+                    routePoints.insert(routePoints.end(), straight.begin(), straight.end());
+                }
+                auto track = std::make_shared<const RouteTrack>(routePoints);
+                std::cout << "AUTOPILOT: " << track->pointCount() << " points, " << (int)roundf(track->length() * METERS_PER_WORLD_UNIT) << "m" << std::endl;
+                setSimAutopilot(track);
+            }
+        }
 
-        if (!overviewMode && activeModel) {
-            modelShader.use();
+        // every 3D draw below is tested against this frustum first
+        beginCullFrame(view, projection, scene.view.cameraPos, scene.render.drawDistance);
+
+        // second view: overview minimap in the corner while walking (drawn after the main view)
+        const bool minimapShown = scene.render.showMinimap && !scene.view.overviewMode;
 
-            // update movement
-            updateSupermanMovement(window, supermanPos, supermanYawDeg, prevSupermanPos, supermanMeters, dt, supermanMoveSpeed, supermanTurnSpeed);
+        // avatar: move + animate first, its transform feeds the shadow map the plane samples
+        bool avatarVisible = false;
+        glm::mat4 mModel = glm::mat4(1.0f);
+        Bounds avatarBounds;
+        beginShadowFrame();
+        if (!scene.view.overviewMode && activeModel) {
+            // walk cycle plays at the speed the avatar actually moves (holds the pose when standing)
+            activeAnimator.speed = glm::clamp(sim.avatarSpeed / supermanMoveSpeed, 0.0f, 2.0f);
 
             // Build model matrix from current position & orientation
-            const float verticalLift = (desiredModelHeight * 0.5f + 0.05f);
+            const float verticalLift = (scene.model.desiredHeight * 0.5f + 0.05f);
 
-            glm::mat4 T = glm::translate(glm::mat4(1.0f), glm::vec3(supermanPos.x, verticalLift, supermanPos.z));
+            glm::mat4 T = glm::translate(glm::mat4(1.0f), glm::vec3(scene.avatar.pos.x, verticalLift, scene.avatar.pos.z));
 
             // Apply per-model pitch (X axis) and yaw (Y axis) offsets
             glm::mat4 Rp = glm::rotate(glm::mat4(1.0f), glm::radians(activeModelPitchOffsetDeg), glm::vec3(1.0f, 0.0f, 0.0f));
-            glm::mat4 Ry = glm::rotate(glm::mat4(1.0f), glm::radians(supermanYawDeg + activeModelYawOffsetDeg), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 Ry = glm::rotate(glm::mat4(1.0f), glm::radians(scene.avatar.yawDeg + activeModelYawOffsetDeg), glm::vec3(0.0f, 1.0f, 0.0f));
             glm::mat4 R = Ry * Rp;
 
             glm::mat4 S = glm::scale(glm::mat4(1.0f), glm::vec3(activeModelScale));
             glm::mat4 C = glm::translate(glm::mat4(1.0f), -activeModelCenter);
 
-            glm::mat4 mModel = T * R * S * C;
+            mModel = T * R * S * C;
+
+            // off-screen (or too far): movement and animation above still ran, skip the submit (and its shadow)
+            avatarBounds = transformBounds(activeModelBounds, mModel);
+            avatarVisible = cullObject(avatarBounds, CULL_AVATAR);
+
+            // one palette upload per frame, shared by both views
+            bool skinned = activeAnimator.skeleton != nullptr;
+            if ((avatarVisible || minimapShown) && skinned) uploadBonePalette(activeAnimator.currentPalette());
+
+            // shadow map: only redrawn when the avatar, its pose or the light changed
+            if (avatarVisible && scene.render.shadowsEnabled) {
+                glm::vec3 lightDir = scene.light.directional ? scene.light.dir : avatarBounds.center - scene.light.pos;
+                ShadowCasterKey key;
+                key.model = mModel;
+                key.poseTime = skinned ? activeAnimator.time : 0.0f;
+                key.lod = glm::min(activeModelLod + 1, activeModel->lodCount() - 1); // a coarser LOD is plenty for the depth pass
+                if (beginShadowPass(lightDir, avatarBounds, key, scene.render)) {
+                    PROFILE_GPU_SCOPE("shadow");
+                    Shader& caster = shadowCasterShader();
+                    caster.setFeature(SHADER_SKINNED, skinned);
+                    caster.setMat4("uM", mModel);
+                    activeModel->Draw(caster, key.lod);
+                    endShadowPass(sceneW, sceneH);
+                }
+            }
+        }
+
+        // Disable horizontal flip; the light type, flip, light tiles and shadows pick a compiled variant
+        // instead of branching per fragment
+        bool flipX = false;
+        map3DShader.setFeatures((scene.light.directional ? SHADER_LIGHT_DIRECTIONAL : 0u) | (flipX ? SHADER_FLIP_X : 0u) |
+                                (scene.render.mapLightsEnabled ? SHADER_TILED_LIGHTS : 0u) | (shadowsActive() ? SHADER_SHADOWS : 0u));
+        map3DShader.use();
+
+        // upload matrices (normal matrix once per draw, not per vertex)
+        glm::mat3 mapNormalMat = glm::transpose(glm::inverse(glm::mat3(model)));
+        // through the Shader setters: cached locations per variant (texture pan/scale is set by drawMap3D)
+        map3DShader.setMat4("uM", model);
+        map3DShader.setMat4("uV", view);
+        map3DShader.setMat4("uP", projection);
+        map3DShader.setMat3("uNormalMat", mapNormalMat);
+
+        // scene light: one upload per frame into the shared block, every view / variant reads it
+        uploadSceneLight(scene.light);
+        map3DShader.setVec3("uViewPos", scene.view.cameraPos.x, scene.view.cameraPos.y, scene.view.cameraPos.z);
+
+        // street lights + pin glows -> per-tile light lists for the map shader
+        if (scene.render.mapLightsEnabled) {
+            PROFILE_SCOPE("lights");
+            beginLightFrame();
+            const std::vector<glm::vec3>& pins = measurementPinLights();
+            for (size_t i = 0; i < pins.size(); ++i) {
+                bool last = i + 1 == pins.size();
+                addLight({ pins[i], last ? 2.0f : 1.2f, glm::vec3(1.0f, 0.1f, 0.05f), last ? 2.0f : 0.8f });
+            }
+            buildLightTiles(view, projection, scene.view.cameraPos, sceneW, sceneH, scene.render.drawDistance);
+            bindLightTiles(map3DShader.ID);
+        }
+        if (shadowsActive()) bindShadowMap(map3DShader.ID, scene.render);
+
+        // draw the 3D map plane
+        const Bounds mapBounds = boundsFromMinMax(glm::vec3(-planeScale * 0.5f, 0.0f, -planeScale * 0.5f), glm::vec3(planeScale * 0.5f, 0.0f, planeScale * 0.5f));
+        if (cullObject(mapBounds, CULL_MAP)) {
+            PROFILE_GPU_SCOPE("map");
+            drawMap3D(map3DShader.ID, VAOmap, scene.view);
+        }
+
+        if (avatarVisible) {
+            PROFILE_GPU_SCOPE("avatar");
+            modelShader.use();
 
             // compute a model-local world position (origin transformed by mModel)
             glm::vec3 modelWorldPos = glm::vec3(mModel * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
 
             // determine forward direction toward camera (XZ only) for frontal fill light
-            glm::vec3 toCamera = glm::normalize(cameraPos - modelWorldPos);
+            glm::vec3 toCamera = glm::normalize(scene.view.cameraPos - modelWorldPos);
             glm::vec3 frontDir = glm::normalize(glm::vec3(toCamera.x, 0.0f, toCamera.z));
             if (glm::length(frontDir) < 0.001f) frontDir = glm::vec3(0.0f, 0.0f, -1.0f);
 
-            applyModelLighting(modelShader, modelWorldPos, activeModelScale, cameraPos, frontDir);
+            applyModelLighting(modelShader, modelWorldPos, activeModelScale, scene.view.cameraPos, frontDir);
 
             modelShader.setMat4("uM", mModel);
+            modelShader.setMat3("uNormalMat", glm::transpose(glm::inverse(glm::mat3(mModel))));
             modelShader.setMat4("uV", view);
             modelShader.setMat4("uP", projection);
 
             modelShader.setVec3("uFrontDir", frontDir.x, frontDir.y, frontDir.z);
 
-            modelShader.setVec3("uViewPos", cameraPos.x, cameraPos.y, cameraPos.z);
+            modelShader.setVec3("uViewPos", scene.view.cameraPos.x, scene.view.cameraPos.y, scene.view.cameraPos.z);
+
+            modelShader.setFeature(SHADER_SKINNED, activeAnimator.skeleton != nullptr);
+
+            // pick the LOD from the avatar's on-screen height (hysteresis keeps it from popping)
+            float avatarPx = projectedHeightPx(activeModelHeight, glm::length(scene.view.cameraPos - modelWorldPos), CAMERA_FOV_Y, (float)screenHeight);
+            activeModelLod = selectLodLevel(avatarPx, activeModelLod, activeModel->lodCount());
 
             // draw active model
-            activeModel->Draw(modelShader);
+            activeModel->Draw(modelShader, activeModelLod);
         }
 
-        // after 3D objects i render 2D (personal info rect, topleft pin) 
+        // crowd: simulate, cull / pick LOD, then one instanced draw per mesh per LOD
+        if (scene.render.crowdEnabled && activeModel) {
+            PROFILE_GPU_SCOPE("crowd");
+            if (crowdSize() != scene.render.crowdAgentCount) initCrowd(scene.render.crowdAgentCount, planeScale * 0.5f);
+            updateCrowd(dt);
+
+            const float verticalLift = (scene.model.desiredHeight * 0.5f + 0.05f);
+            cullCrowd(view, projection, scene.view.cameraPos, verticalLift, activeModelRadius, activeModelHeight, CAMERA_FOV_Y, (float)screenHeight,
+                      scene.render.crowdMaxDistance);
+
+            glm::mat4 Rp = glm::rotate(glm::mat4(1.0f), glm::radians(activeModelPitchOffsetDeg), glm::vec3(1.0f, 0.0f, 0.0f));
+            glm::mat4 Ry = glm::rotate(glm::mat4(1.0f), glm::radians(activeModelYawOffsetDeg), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 S = glm::scale(glm::mat4(1.0f), glm::vec3(activeModelScale));
+            glm::mat4 C = glm::translate(glm::mat4(1.0f), -activeModelCenter);
+
+            // light the crowd from the camera side, anchored a little in front of the viewer
+            glm::vec3 frontDir = glm::vec3(-scene.view.cameraFront.x, 0.0f, -scene.view.cameraFront.z);
+            frontDir = glm::length(frontDir) > 0.001f ? glm::normalize(frontDir) : glm::vec3(0.0f, 0.0f, -1.0f);
+            glm::vec3 anchor = scene.view.cameraPos - frontDir * 3.0f;
+
+            crowdShader.use();
+            applyModelLighting(crowdShader, anchor, activeModelScale, scene.view.cameraPos, frontDir);
+            bool skinned = activeAnimator.skeleton != nullptr;
+            crowdShader.setFeature(SHADER_SKINNED, skinned);
+            if (skinned) uploadBonePalette(activeAnimator.currentPalette());
+
+            drawCrowd(crowdShader, Ry * Rp * S * C, verticalLift, view, projection);
+        }
+
+        // measurement overlay now rendered as 3D objects in overview (still without depth test, on top
+        // of the scene; part of the HDR scene so the lit pin blooms):
         glDisable(GL_DEPTH_TEST);
+        if (scene.view.overviewMode && !scene.measurement.points.empty()) {
+            PROFILE_GPU_SCOPE("measurements");
+            drawMeasurements3D(view, projection, planeScale, scene.measurement, scene.saved);
+        }
+
+        // bloom + composite into the back buffer; the 2D overlay below is drawn on top, unbloomed
+        endScenePass();
+
+        // minimap: redrawn only when its content changed (at a capped rate), then copied into the corner.
+        // It reuses this frame's light block, shadow map and bone palette; only its camera is set here.
+        if (minimapShown) {
+            PROFILE_GPU_SCOPE("minimap");
+            MinimapKey minimapKey;
+            if (activeModel) minimapKey.avatarModel = mModel;
+            minimapKey.measurementPoints = (int)scene.measurement.points.size();
+            minimapKey.measurementDistance = scene.measurement.distancePixels;
+            minimapKey.walkRouteLength = scene.measurement.walkRouteLength;
+            minimapKey.light = glm::vec4(scene.light.directional ? scene.light.dir : scene.light.pos, scene.light.intensity);
+            minimapKey.mapOffset = glm::vec2(scene.view.mapOffsetX, scene.view.mapOffsetY);
+            minimapKey.mapTexScale = scene.view.mapTexScale;
+            minimapKey.shadows = shadowsActive();
+
+            if (beginMinimapPass(minimapKey, frameClock)) {
+                glm::mat4 mmView, mmProjection;
+                glm::vec3 mmEye;
+                minimapCamera(planeScale * 0.5f, mmView, mmProjection, mmEye);
+                // this view's own culling (the frame's culling stage belongs to the walking view)
+                const Frustum mmFrustum = extractFrustum(mmProjection * mmView);
+                glEnable(GL_DEPTH_TEST);
+
+                if (sphereInFrustum(mmFrustum, mapBounds.center, mapBounds.radius)) {
+                    map3DShader.setFeatures((scene.light.directional ? SHADER_LIGHT_DIRECTIONAL : 0u) | (shadowsActive() ? SHADER_SHADOWS : 0u));
+                    map3DShader.use();
+                    map3DShader.setMat4("uV", mmView); // uM / uNormalMat carried over from the walking view
+                    map3DShader.setMat4("uP", mmProjection);
+                    map3DShader.setVec3("uViewPos", mmEye.x, mmEye.y, mmEye.z);
+                    if (shadowsActive()) bindShadowMap(map3DShader.ID, scene.render);
+                    drawMap3D(map3DShader.ID, VAOmap, scene.view);
+                }
+
+                if (activeModel && sphereInFrustum(mmFrustum, avatarBounds.center, avatarBounds.radius)) {
+                    modelShader.use();
+                    glm::vec3 modelWorldPos = glm::vec3(mModel * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+                    applyModelLighting(modelShader, modelWorldPos, activeModelScale, mmEye, glm::vec3(0.0f, 0.0f, -1.0f));
+                    modelShader.setMat4("uM", mModel);
+                    modelShader.setMat3("uNormalMat", glm::transpose(glm::inverse(glm::mat3(mModel))));
+                    modelShader.setMat4("uV", mmView);
+                    modelShader.setMat4("uP", mmProjection);
+                    modelShader.setFeature(SHADER_SKINNED, activeAnimator.skeleton != nullptr);
+                    activeModel->Draw(modelShader, activeModel->lodCount() - 1); // a few pixels tall up here
+                }
+
+                glDisable(GL_DEPTH_TEST);
+                if (!scene.measurement.points.empty()) {
+                    drawMeasurementsInView(mmView, mmProjection, pickView, projection, planeScale, scene.measurement, scene.saved);
+                }
+                endMinimapPass(screenWidth, screenHeight);
+            }
+            drawMinimap(screenWidth, screenHeight);
+        }
 
+        // after 3D objects i render 2D (personal info rect, topleft pin) 
+        profilerPush("hud", true);
         drawRect(rectShader, VAOrect);
 
         // DEPRICATED: 2D
-        // drawStandinMan(rectShader, VAOstandingMan);
-
-        drawTopPin(rectShader, VAOtopPin, VAOtopPinWide);
+        // drawStandinMan(rectShader, VAOstandingMan, scene.avatar);
 
-        // measurement overlay now rendered as 3D objects in overview:
-        if (overviewMode && !measurementPoints.empty()) {
-            const float planeScale = 20.0f;
-            drawMeasurements3D(view, projection, planeScale);
-        }
+        drawTopPin(rectShader, VAOtopPin, VAOtopPinWide, scene.view);
 
         // Render distance (either measurement or walking)
         renderDistance(window);
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();      
+        if (scene.render.crowdEnabled) {
+            const CrowdStats& cs = crowdStats();
+            char crowdBuf[192];
+            int len = snprintf(crowdBuf, sizeof(crowdBuf), "crowd %d  drawn %d (lod", cs.agents, cs.visible);
+            for (int l = 0; l < CROWD_LOD_LEVELS; ++l)
+                len += snprintf(crowdBuf + len, sizeof(crowdBuf) - len, "%s%d", l ? "/" : " ", cs.perLod[l]);
+            snprintf(crowdBuf + len, sizeof(crowdBuf) - len, ")  sim %.2fms cull %.2fms draw %.2fms", cs.simulateMs, cs.cullMs, cs.drawMs);
+            int fbW = 0, fbH = 0;
+            glfwGetFramebufferSize(window, &fbW, &fbH);
+            drawText(crowdBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 1, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+        }
+
+        // F5: culled / tested per category for this frame
+        if (scene.render.showCullStats) {
+            const CullStats& st = cullStats();
+            char cullBuf[192];
+            int len = snprintf(cullBuf, sizeof(cullBuf), "culled");
+            for (int c = 0; c < CULL_CATEGORY_COUNT; ++c)
+                len += snprintf(cullBuf + len, sizeof(cullBuf) - len, "  %s %d/%d", cullCategoryName((CullCategory)c), st.culled[c], st.tested[c]);
+            int fbW = 0, fbH = 0;
+            glfwGetFramebufferSize(window, &fbW, &fbH);
+            drawText(cullBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 2, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+
+            if (scene.render.mapLightsEnabled) {
+                const LightingStats& ls = lightingStats();
+                char lightBuf[160];
+                snprintf(lightBuf, sizeof(lightBuf), "lights %d/%d  max %d per tile (%d full)  bin %.2f ms",
+                         ls.visible, ls.lights, ls.maxPerTile, ls.saturatedTiles, ls.binMs);
+                drawText(lightBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 3, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+            }
+
+            if (scene.render.shadowsEnabled) {
+                const ShadowStats& ss = shadowStats();
+                char shadowBuf[160];
+                snprintf(shadowBuf, sizeof(shadowBuf), "shadow %dpx pcf %d  %d renders, %d reused  last %.2f ms",
+                         scene.render.shadowMapSize, scene.render.shadowPcfRadius, ss.renders, ss.reused, ss.lastRenderMs);
+                drawText(shadowBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 4, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+            }
+
+            // GPU cost of the anti-aliasing modes (each one is measured while it is active, F7 switches)
+            const PostProcessStats& ps = postProcessStats();
+            char aaBuf[192];
+            int aaLen = snprintf(aaBuf, sizeof(aaBuf), "aa %s", antiAliasModeName(scene.render.antiAliasMode));
+            if (scene.render.antiAliasMode == AA_MSAA) aaLen += snprintf(aaBuf + aaLen, sizeof(aaBuf) - aaLen, " %dx", scene.render.msaaSamples);
+            aaLen += snprintf(aaBuf + aaLen, sizeof(aaBuf) - aaLen, "  gpu scene %.2f post %.2f ms  |", ps.sceneMs, ps.postMs);
+            for (int m = 0; m < AA_MODE_COUNT; ++m) {
+                if (ps.modeMs[m] == 0.0) aaLen += snprintf(aaBuf + aaLen, sizeof(aaBuf) - aaLen, "  %s -", antiAliasModeName(m));
+                else aaLen += snprintf(aaBuf + aaLen, sizeof(aaBuf) - aaLen, "  %s %.2f", antiAliasModeName(m), ps.modeMs[m]);
+            }
+            drawText(aaBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 5, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+
+            char scaleBuf[160];
+            snprintf(scaleBuf, sizeof(scaleBuf), "render %dx%d (%.0f%%%s)  gpu %.2f / %.2f ms",
+                     ps.sceneWidth, ps.sceneHeight, ps.renderScale * 100.0f, scene.render.dynamicResolution ? ", dynamic" : "",
+                     ps.gpuFrameMs, scene.render.dynamicResolutionTargetMs);
+            drawText(scaleBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 6, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+
+            const InputLatencyStats& is = inputLatencyStats();
+            char inputBuf[160];
+            const SimInputStats& ss = simInputStats();
+            snprintf(inputBuf, sizeof(inputBuf), "input to present last %.1f avg %.1f max %.1f ms%s  %llu events, %llu dropped  pad %s, %d samples/frame",
+                     is.lastMs, is.avgMs, is.maxMs, scene.render.latencyMode ? " (finished)" : "", (unsigned long long)is.events,
+                     (unsigned long long)is.dropped, ss.gamepad ? "on" : "off", ss.samplesLastFrame);
+            drawText(inputBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 7, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+
+            const MinimapStats& ms = minimapStats();
+            char minimapBuf[128];
+            snprintf(minimapBuf, sizeof(minimapBuf), "minimap %s  %d renders, %d reused  last %.2f ms",
+                     scene.render.showMinimap ? "on" : "off", ms.renders, ms.reused, ms.lastRenderMs);
+            drawText(minimapBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 8, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+
+            const NavStats& ns = navStats();
+            char navBuf[160];
+            snprintf(navBuf, sizeof(navBuf), "nav %dx%d %s  %.0f%% blocked  build %.0f ms  route %d: %d expanded, %.2f ms",
+                     NAV_GRID_CELLS, NAV_GRID_CELLS, navGrid() ? (ns.fromMask ? "mask" : "map") : "none", ns.blockedFraction * 100.0f,
+                     ns.buildMs, ns.routes, ns.lastRouteExpanded, ns.lastRouteMs);
+            drawText(navBuf, 8.0f, fbH - HUD_LINE_HEIGHT * 9, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+        }
+
+        // F10: per-pass CPU / GPU times, stacked above the F5 lines
+        if (scene.render.showProfiler) {
+            int fbW = 0, fbH = 0;
+            glfwGetFramebufferSize(window, &fbW, &fbH);
+            drawProfilerOverlay(8.0f, fbH - HUD_LINE_HEIGHT * 10);
+        }
+        // F12: white marker on frames that present new input, and the numbers next to it
+        if (scene.render.latencyMode) {
+            const int marker = 48;
+            int fbW = 0, fbH = 0;
+            glfwGetFramebufferSize(window, &fbW, &fbH);
+            if (inputPendingPresent()) {
+                GLfloat clearColor[4];
+                glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+                glEnable(GL_SCISSOR_TEST);
+                glScissor(fbW - marker, 0, marker, marker);
+                glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+                glDisable(GL_SCISSOR_TEST);
+                glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+            }
+            const InputLatencyStats& is = inputLatencyStats();
+            char latencyBuf[96];
+            snprintf(latencyBuf, sizeof(latencyBuf), "input to present %.1f ms (avg %.1f, max %.1f)", is.lastMs, is.avgMs, is.maxMs);
+            const float textW = float(stb_easy_font_width(latencyBuf)) * HUD_TEXT_SCALE;
+            drawText(latencyBuf, fbW - marker - 16.0f - textW, fbH - HUD_LINE_HEIGHT, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+        }
+        profilerPop(); // hud
+        profilerEndFrame();
+
+        if (sessionEnabled) autosaveSession(scene, frameClock);
+
+        // sample next frame's bone palettes while we wait on swap/frame limiter
+        animationWorker.kick({ &activeAnimator }, dt);
 
-        // Frame limiter (75 FPS)
-        while (glfwGetTime() - initFrameTime < 1 / 75.0) {}
+        glfwSwapBuffers(window);
+        if (startupActive()) {
+            recordStartupPhase("first frame", firstFrameStartMs, false);
+            const StartupReport report = finishStartup(startupTracePath);
+            if (startupCheck) {
+                startupCheckFailed = !report.serial && report.speedup() < STARTUP_TARGET_SPEEDUP;
+                std::cout << "Startup check: " << (startupCheckFailed ? "FAIL" : "PASS") << std::endl;
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
+        }
+        if (scene.render.latencyMode) glFinish(); // "presented" = the swap has actually happened
+        inputEventsPresented();
+        inputPollEvents(window);
+        if (inputReplayFinished()) glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+        // Frame limiter (75 FPS); the wait keeps sampling the input for the next frame's simulation steps.
+        // A headless replay runs as fast as it can
+        while (!headless && glfwGetTime() - initFrameTime < 1 / 75.0) sampleSimInput(window);
     }
 
+    if (sessionEnabled) flushSession(scene);
+    animationWorker.stop();
+    stopSimulation();
+    stopShaderWatcher();
+    shutdownProfiler();
+    finishInputSession();
+
     cleanupText();
     shutdownMeasurement3D();
+    shutdownLighting();
+    shutdownShadows();
+    shutdownMinimap();
+    shutdownPostProcess();
+    shutdownCrowd();
+    if (crowdProxyMesh) crowdProxyMesh->release();
+    delete crowdProxyMesh;
+    crowdProxyMesh = nullptr;
+    shutdownBoneBuffer();
+    shutdownShaderCache();
 
     if (activeModel) { delete activeModel; activeModel = nullptr; }
 
     glfwDestroyWindow(window);
     glfwTerminate();
-    return 0;
+    return startupCheckFailed ? 1 : 0;
 }
@@ -2,26 +2,29 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <cmath>
+#include <cfloat>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "../Header/Measurement3D.h"
 #include "../Header/Globals.h"
 #include "../Header/Util.h" // for createShader()
+#include "../Header/Culling.h"
+#include "../Header/ShaderCache.h"
+#include "../Header/ShaderReload.h"
 
 // Simple low-poly sphere + cone generator for pins and line rendering
 static unsigned measurementProg = 0;
 static unsigned sphereVAO = 0, sphereVBO = 0, sphereEBO = 0, sphereCount = 0;
 static unsigned coneVAO = 0, coneVBO = 0, coneEBO = 0, coneCount = 0;
 static unsigned lineVAO = 0, lineVBO = 0;
+static std::vector<glm::vec3> pinLights;
 
 // helper to create shader program (uses existing project helper)
 static unsigned createMeasurementShader() {
     return createShader("measurement3d.vert", "measurement3d.frag");
 }
 
-static void buildSphere(int stacks = 8, int slices = 16) {
-    std::vector<float> verts;
-    std::vector<unsigned> idx;
+static void buildSphere(std::vector<float>& verts, std::vector<unsigned>& idx, int stacks = 8, int slices = 16) {
     for (int i = 0; i <= stacks; ++i) {
         float V = float(i) / float(stacks);
         float phi = V * glm::pi<float>();
@@ -47,33 +50,10 @@ static void buildSphere(int stacks = 8, int slices = 16) {
             idx.push_back(first + 1);
         }
     }
-
-    glGenVertexArrays(1, &sphereVAO);
-    glGenBuffers(1, &sphereVBO);
-    glGenBuffers(1, &sphereEBO);
-
-    glBindVertexArray(sphereVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-
-    // pos(3) + normal(3)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-
-    glBindVertexArray(0);
-    sphereCount = (unsigned)idx.size();
 }
 
 // Build a cone where TIP is at y=0 (point at bottom) and BASE ring is at y=1 (wider at top).
-static void buildCone(int slices = 24) {
-    std::vector<float> verts;
-    std::vector<unsigned> idx;
-
+static void buildCone(std::vector<float>& verts, std::vector<unsigned>& idx, int slices = 24) {
     // TIP vertex at y = 0
     verts.push_back(0.0f); verts.push_back(0.0f); verts.push_back(0.0f); // pos
     verts.push_back(0.0f); verts.push_back(-1.0f); verts.push_back(0.0f); // normal (approx)
@@ -107,31 +87,41 @@ static void buildCone(int slices = 24) {
         idx.push_back(ringStart + i);
         idx.push_back(ringStart + i + 1);
     }
+}
 
-    glGenVertexArrays(1, &coneVAO);
-    glGenBuffers(1, &coneVBO);
-    glGenBuffers(1, &coneEBO);
+// pos(3) + normal(3) mesh -> VAO; returns the index count
+static unsigned uploadPinMesh(const std::vector<float>& verts, const std::vector<unsigned>& idx, unsigned& vao, unsigned& vbo, unsigned& ebo) {
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
 
-    glBindVertexArray(coneVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, coneVBO);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, coneEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
 
-    // pos(3) + normal(3)
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
 
     glBindVertexArray(0);
-    coneCount = (unsigned)idx.size();
+    return (unsigned)idx.size();
 }
 
-void initMeasurement3D() {
+MeasurementGeometry buildMeasurementGeometry() {
+    MeasurementGeometry geometry;
+    buildSphere(geometry.sphereVerts, geometry.sphereIdx, 10, 20);
+    buildCone(geometry.coneVerts, geometry.coneIdx, 32);
+    return geometry;
+}
+
+void initMeasurement3D(const MeasurementGeometry& geometry) {
     measurementProg = createMeasurementShader();
-    buildSphere(10, 20);
-    buildCone(32);
+    watchShaderProgram(&measurementProg, "measurement3d.vert", "measurement3d.frag");
+    sphereCount = uploadPinMesh(geometry.sphereVerts, geometry.sphereIdx, sphereVAO, sphereVBO, sphereEBO);
+    coneCount = uploadPinMesh(geometry.coneVerts, geometry.coneIdx, coneVAO, coneVBO, coneEBO);
 
     // line VAO (dynamic)
     glGenVertexArrays(1, &lineVAO);
@@ -152,32 +142,21 @@ void shutdownMeasurement3D() {
     if (coneEBO) { glDeleteBuffers(1, &coneEBO); coneEBO = 0; }
     if (lineVAO) { glDeleteVertexArrays(1, &lineVAO); lineVAO = 0; }
     if (lineVBO) { glDeleteBuffers(1, &lineVBO); lineVBO = 0; }
-    if (measurementProg) { glDeleteProgram(measurementProg); measurementProg = 0; }
+    unwatchShaderProgram(&measurementProg);
+    if (measurementProg) { releaseProgram(measurementProg); measurementProg = 0; }
 }
 
-void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, float planeScale) {
-    if (measurementPoints.empty()) return;
-    GLFWwindow* ctx = glfwGetCurrentContext();
-    if (!ctx) return;
-
-    int fbW = 0, fbH = 0;
-    glfwGetFramebufferSize(ctx, &fbW, &fbH);
-    if (fbW == 0 || fbH == 0) return;
-
-    glUseProgram(measurementProg);
-    GLint locM = glGetUniformLocation(measurementProg, "uM");
-    GLint locV = glGetUniformLocation(measurementProg, "uV");
-    GLint locP = glGetUniformLocation(measurementProg, "uP");
-    GLint locColor = glGetUniformLocation(measurementProg, "uColor");
-
-    glUniformMatrix4fv(locV, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(locP, 1, GL_FALSE, glm::value_ptr(projection));
+const std::vector<glm::vec3>& measurementPinLights() {
+    return pinLights;
+}
 
+std::vector<glm::vec3> measurementWorldPoints(const glm::mat4& pickView, const glm::mat4& pickProjection, int fbW, int fbH,
+                                              float planeScale, const MeasurementState& measurement, const SavedViewState& saved) {
     // Convert stored framebuffer measurement points -> world coords using unProject + ray-plane intersection.
     // That correctly accounts for camera perspective and tilt.
     std::vector<glm::vec3> worldPts;
-    worldPts.reserve(measurementPoints.size());
-    for (auto &p : measurementPoints) {
+    worldPts.reserve(measurement.points.size());
+    for (auto &p : measurement.points) {
         // p holds framebuffer pixel coords (x,y).
         float px = p.first;
         float py = p.second;
@@ -189,8 +168,8 @@ void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, floa
         glm::vec3 farWin(px, winY, 1.0f);
 
         // unProject with model = view (we want camera-space -> world)
-        glm::vec3 nearW = glm::unProject(nearWin, view, projection, glm::vec4(0, 0, fbW, fbH));
-        glm::vec3 farW  = glm::unProject(farWin,  view, projection, glm::vec4(0, 0, fbW, fbH));
+        glm::vec3 nearW = glm::unProject(nearWin, pickView, pickProjection, glm::vec4(0, 0, fbW, fbH));
+        glm::vec3 farW  = glm::unProject(farWin,  pickView, pickProjection, glm::vec4(0, 0, fbW, fbH));
 
         glm::vec3 dir = glm::normalize(farW - nearW);
 
@@ -199,8 +178,8 @@ void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, floa
             // nearly parallel -> fallback to projecting to plane using texture mapping as a best-effort
             float u_screen = px / float(fbW);
             float v_screen = py / float(fbH);
-            float texU = saved_mapOffsetX + u_screen * saved_mapTexScale;
-            float texV = saved_mapOffsetY + v_screen * saved_mapTexScale;
+            float texU = saved.mapOffsetX + u_screen * saved.mapTexScale;
+            float texV = saved.mapOffsetY + v_screen * saved.mapTexScale;
             float worldX = (0.5f - texU) * planeScale;
             float worldZ = (texV - 0.5f) * planeScale;
             worldPts.emplace_back(worldX, 0.0f, worldZ);
@@ -210,8 +189,8 @@ void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, floa
                 // intersection behind near plane; fallback same as above
                 float u_screen = px / float(fbW);
                 float v_screen = py / float(fbH);
-                float texU = saved_mapOffsetX + u_screen * saved_mapTexScale;
-                float texV = saved_mapOffsetY + v_screen * saved_mapTexScale;
+                float texU = saved.mapOffsetX + u_screen * saved.mapTexScale;
+                float texV = saved.mapOffsetY + v_screen * saved.mapTexScale;
                 float worldX = (0.5f - texU) * planeScale;
                 float worldZ = (texV - 0.5f) * planeScale;
                 worldPts.emplace_back(worldX, 0.0f, worldZ);
@@ -222,26 +201,88 @@ void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, floa
         }
     }
 
-    // Draw line segments (slightly above plane)
+    return worldPts;
+}
+
+// Draw the path as a flat ribbon (slightly above plane): wide GL lines are not reliable in a core
+// profile, and triangles get anti-aliased by MSAA / FXAA like the rest of the scene.
+// Expects measurementProg bound; color is set by the caller.
+static void drawRibbon(const std::vector<glm::vec3>& worldPts, float halfWidth, float lift, GLint locM) {
     std::vector<glm::vec3> lineVerts;
-    lineVerts.reserve(worldPts.size());
-    for (auto &wp : worldPts) {
-        glm::vec3 v = wp;
-        v.y += 0.02f; // slight lift so it is visible above plane
-        lineVerts.push_back(v);
+    lineVerts.reserve(worldPts.size() * 2);
+    for (size_t i = 0; i < worldPts.size(); ++i) {
+        glm::vec3 prev = worldPts[i > 0 ? i - 1 : i];
+        glm::vec3 next = worldPts[i + 1 < worldPts.size() ? i + 1 : i];
+        glm::vec3 dir = next - prev;
+        dir.y = 0.0f;
+        if (glm::length(dir) < 1e-6f) dir = glm::vec3(1.0f, 0.0f, 0.0f);
+        dir = glm::normalize(dir);
+        glm::vec3 side(-dir.z, 0.0f, dir.x);
+
+        // miter at the joints: keep the segment width constant, capped for very sharp turns
+        float miter = 1.0f;
+        if (i > 0 && i + 1 < worldPts.size()) {
+            glm::vec3 seg = worldPts[i + 1] - worldPts[i];
+            seg.y = 0.0f;
+            if (glm::length(seg) > 1e-6f) {
+                seg = glm::normalize(seg);
+                miter = 1.0f / glm::max(glm::dot(side, glm::vec3(-seg.z, 0.0f, seg.x)), 0.35f);
+            }
+        }
+
+        glm::vec3 v = worldPts[i];
+        v.y += lift; // slight lift so it is visible above plane
+        lineVerts.push_back(v + side * (halfWidth * miter));
+        lineVerts.push_back(v - side * (halfWidth * miter));
     }
 
-    // upload dynamic line vertices and draw
+    // upload dynamic ribbon vertices and draw
     glBindVertexArray(lineVAO);
     glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
     glBufferData(GL_ARRAY_BUFFER, lineVerts.size() * sizeof(glm::vec3), lineVerts.data(), GL_DYNAMIC_DRAW);
 
+    glUniformMatrix4fv(locM, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    if (lineVerts.size() >= 4) {
+        // strip winding flips with the path direction, so draw both sides
+        GLboolean cullWasOn = glIsEnabled(GL_CULL_FACE);
+        glDisable(GL_CULL_FACE);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)lineVerts.size());
+        if (cullWasOn) glEnable(GL_CULL_FACE);
+    }
+}
+
+// pickView / pickProjection: camera the points were clicked with. viewFrustum: test the pins against this
+// instead of the frame's culling stage (a second view; stats and pin lights are left alone).
+static void drawRoute(const glm::mat4& view, const glm::mat4& projection, const glm::mat4& pickView, const glm::mat4& pickProjection,
+                      float planeScale, const MeasurementState& measurement, const SavedViewState& saved, const Frustum* viewFrustum) {
+    if (!viewFrustum) pinLights.clear();
+    if (measurement.points.empty()) return;
+    GLFWwindow* ctx = glfwGetCurrentContext();
+    if (!ctx) return;
+
+    int fbW = 0, fbH = 0;
+    glfwGetFramebufferSize(ctx, &fbW, &fbH);
+    if (fbW == 0 || fbH == 0) return;
+    const std::vector<glm::vec3> worldPts = measurementWorldPoints(pickView, pickProjection, fbW, fbH, planeScale, measurement, saved);
+
+    glUseProgram(measurementProg);
+    GLint locM = glGetUniformLocation(measurementProg, "uM");
+    GLint locV = glGetUniformLocation(measurementProg, "uV");
+    GLint locP = glGetUniformLocation(measurementProg, "uP");
+    GLint locColor = glGetUniformLocation(measurementProg, "uColor");
+
+    glUniformMatrix4fv(locV, 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(locP, 1, GL_FALSE, glm::value_ptr(projection));
+
+    // walking route on the navigation grid (under the straight line, a little wider)
+    if (measurement.walkRoute.size() >= 2) {
+        glUniform4f(locColor, 0.25f, 0.75f, 0.3f, 1.0f);
+        drawRibbon(measurement.walkRoute, 0.045f, 0.015f, locM);
+    }
+
     // line color = blue (sky blue)
     glUniform4f(locColor, 123.0f/255.0f, 194.0f/255.0f, 252.0f/255.0f, 1.0f);
-    glUniformMatrix4fv(locM, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
-    glLineWidth(3.0f);
-    glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)lineVerts.size());
-    glLineWidth(1.0f);  
+    drawRibbon(worldPts, 0.03f, 0.02f, locM);
 
     // Draw pins: cone needle (tip at plane) + red sphere on top
     float needleHeight = 0.9f;    // needle height in world units
@@ -251,7 +292,28 @@ void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, floa
     // last added index (only this one is lit)
     int lastIndex = (int)worldPts.size() - 1;
 
+    if (!viewFrustum)
+        for (const glm::vec3& wp : worldPts) pinLights.push_back(glm::vec3(wp.x, needleHeight + sphereRadius, wp.z));
+
+    // analytic pin bounds: needle + ball, one sphere per pin, tested as a batch
+    const float pinTop = needleHeight + sphereRadius * 2.0f;
+    const float pinWidth = sphereRadius;
+    std::vector<float> pinX(worldPts.size()), pinZ(worldPts.size());
+    for (size_t i = 0; i < worldPts.size(); ++i) {
+        pinX[i] = worldPts[i].x;
+        pinZ[i] = worldPts[i].z;
+    }
+    SphereSoA pinSpheres;
+    pinSpheres.x = pinX.data();
+    pinSpheres.z = pinZ.data();
+    pinSpheres.yConst = pinTop * 0.5f;
+    pinSpheres.radiusConst = std::sqrt(pinTop * pinTop * 0.25f + pinWidth * pinWidth);
+    std::vector<unsigned char> pinVisible(worldPts.size());
+    if (viewFrustum) cullSpheres(*viewFrustum, glm::vec3(glm::inverse(view)[3]), FLT_MAX, pinSpheres, 0, worldPts.size(), pinVisible.data());
+    else cullBatch(pinSpheres, worldPts.size(), pinVisible.data(), CULL_PINS);
+
     for (size_t i = 0; i < worldPts.size(); ++i) {
+        if (!pinVisible[i]) continue;
         glm::vec3 base = worldPts[i];
 
         // Cone: model has tip at y=0 and base at y=1 -> translate to plane then scale
@@ -267,42 +329,12 @@ void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, floa
         Ms = glm::scale(Ms, glm::vec3(sphereRadius));
         glUniformMatrix4fv(locM, 1, GL_FALSE, glm::value_ptr(Ms));
 
-        // If this is the last added point, render it brighter and draw a stronger, tighter additive glow.
+        // If this is the last added point, render it emissive: HDR red above the bloom threshold,
+        // the bloom pass (PostProcess) turns it into the glow.
         if ((int)i == lastIndex) {
-            // Brighter core (pure red)
-            glUniform4f(locColor, 1.0f, 0.0f, 0.0f, 1.0f);
+            glUniform4f(locColor, 4.0f, 0.15f, 0.1f, 1.0f);
             glBindVertexArray(sphereVAO);
             glDrawElements(GL_TRIANGLES, (GLsizei)sphereCount, GL_UNSIGNED_INT, 0);
-
-            // Glow: additive blended, smaller spread and stronger red
-            GLboolean prevBlend = glIsEnabled(GL_BLEND);
-            GLint prevDepthMask;
-            glGetIntegerv(GL_DEPTH_WRITEMASK, &prevDepthMask);
-
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-            glDepthMask(GL_FALSE);
-
-            // tighter shells configuration: smaller scale multipliers and higher alpha for intensity
-            const float shellScales[3] = { 1.25f, 1.9f, 2.8f };
-            const float shellAlphas[3] = { 0.85f, 0.55f, 0.30f };
-
-            for (int s = 0; s < 3; ++s) {
-                glm::mat4 Mg = glm::translate(glm::mat4(1.0f), glm::vec3(base.x, needleHeight + sphereRadius, base.z));
-                Mg = glm::scale(Mg, glm::vec3(sphereRadius * shellScales[s]));
-                glUniformMatrix4fv(locM, 1, GL_FALSE, glm::value_ptr(Mg));
-                // pure red shells
-                glUniform4f(locColor, 1.0f, 0.0f, 0.0f, shellAlphas[s]);
-                glBindVertexArray(sphereVAO);
-                glDrawElements(GL_TRIANGLES, (GLsizei)sphereCount, GL_UNSIGNED_INT, 0);
-            }
-
-            // restore
-            glDepthMask((GLboolean)prevDepthMask);
-            if (!prevBlend) glDisable(GL_BLEND);
-
-            // restore model matrix for any subsequent objects
-            glUniformMatrix4fv(locM, 1, GL_FALSE, glm::value_ptr(Ms));
         } else {
             // regular (unlit) red sphere
             glUniform4f(locColor, 212.0f/255.0f, 3.0f/255.0f, 3.0f/255.0f, 1.0f);
@@ -314,3 +346,14 @@ void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, floa
     glBindVertexArray(0);
     glUseProgram(0);
 }
+
+void drawMeasurements3D(const glm::mat4& view, const glm::mat4& projection, float planeScale,
+                        const MeasurementState& measurement, const SavedViewState& saved) {
+    drawRoute(view, projection, view, projection, planeScale, measurement, saved, nullptr);
+}
+
+void drawMeasurementsInView(const glm::mat4& view, const glm::mat4& projection, const glm::mat4& pickView, const glm::mat4& pickProjection,
+                            float planeScale, const MeasurementState& measurement, const SavedViewState& saved) {
+    const Frustum frustum = extractFrustum(projection * view);
+    drawRoute(view, projection, pickView, pickProjection, planeScale, measurement, saved, &frustum);
+}
@@ -0,0 +1,381 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <unordered_map>
+
+#include "../Header/MeshLod.h"
+#include "../Header/TextureCache.h"
+
+// target size and error budget of levels 1..MESH_LOD_MAX-1 (fraction of level 0 indices, fraction of bounds diagonal)
+static const float LOD_TARGET_RATIO[MESH_LOD_MAX - 1] = { 0.5f, 0.25f, 0.12f };
+static const float LOD_MAX_ERROR[MESH_LOD_MAX - 1] = { 0.01f, 0.03f, 0.08f };
+
+// screen height (px) below which level i is replaced by level i+1
+static const float LOD_SWITCH_PX[MESH_LOD_MAX - 1] = { 180.0f, 80.0f, 32.0f };
+static const float LOD_HYSTERESIS = 0.15f;
+
+static const uint32_t LOD_CACHE_MAGIC = 0x444F4C4B; // "KLOD"
+static const uint32_t LOD_CACHE_VERSION = 1;
+
+// ---------------------------------------------------------------------------------------------
+// Quadric error metric (Garland-Heckbert). Symmetric 4x4 stored as its upper triangle.
+
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+    void addPlane(double a, double b, double c, double d) {
+        a2 += a * a; ab += a * b; ac += a * c; ad += a * d;
+        b2 += b * b; bc += b * c; bd += b * d;
+        c2 += c * c; cd += c * d;
+        d2 += d * d;
+    }
+    void add(const Quadric& o) {
+        a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad; b2 += o.b2;
+        bc += o.bc; bd += o.bd; c2 += o.c2; cd += o.cd; d2 += o.d2;
+    }
+    // sum of squared distances of p to the accumulated planes
+    double evaluate(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+             + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+             + c2 * z * z + 2 * cd * z
+             + d2;
+    }
+};
+
+struct Collapse {
+    unsigned int from, to;
+    double cost;
+};
+
+static glm::vec3 triangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+{
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+// Vertices that must not move: positions shared by several vertices (UV / normal / material seams)
+// and vertices on open borders. Moving either would tear the surface.
+static std::vector<bool> findLockedVertices(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    struct PosHash {
+        size_t operator()(const glm::vec3& p) const {
+            uint32_t h[3];
+            std::memcpy(h, &p.x, sizeof(h));
+            return (size_t(h[0]) * 73856093u) ^ (size_t(h[1]) * 19349663u) ^ (size_t(h[2]) * 83492791u);
+        }
+    };
+    struct PosEq {
+        bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+    };
+
+    // canonical vertex per position
+    std::vector<unsigned int> canon(vertices.size());
+    std::vector<unsigned int> shared(vertices.size(), 0);
+    std::unordered_map<glm::vec3, unsigned int, PosHash, PosEq> firstAt;
+    firstAt.reserve(vertices.size());
+    for (unsigned int v = 0; v < vertices.size(); ++v) {
+        auto it = firstAt.emplace(vertices[v].Position, v).first;
+        canon[v] = it->second;
+        shared[it->second]++;
+    }
+
+    std::vector<bool> locked(vertices.size(), false);
+    for (unsigned int v = 0; v < vertices.size(); ++v)
+        if (shared[canon[v]] > 1) locked[v] = true;
+
+    // border edges: used by exactly one triangle (counted on welded positions)
+    std::unordered_map<uint64_t, int> edgeUse;
+    edgeUse.reserve(indices.size());
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = canon[indices[t + e]];
+            unsigned int b = canon[indices[t + (e + 1) % 3]];
+            if (a > b) std::swap(a, b);
+            edgeUse[(uint64_t(a) << 32) | b]++;
+        }
+    }
+    std::vector<bool> borderCanon(vertices.size(), false);
+    for (const auto& kv : edgeUse) {
+        if (kv.second == 1) {
+            borderCanon[unsigned(kv.first >> 32)] = true;
+            borderCanon[unsigned(kv.first & 0xffffffffu)] = true;
+        }
+    }
+    for (unsigned int v = 0; v < vertices.size(); ++v)
+        if (borderCanon[canon[v]]) locked[v] = true;
+
+    return locked;
+}
+
+std::vector<unsigned int> simplifyMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+    size_t targetIndexCount, float maxError, float* outError)
+{
+    std::vector<unsigned int> tris = indices;
+    if (outError) *outError = 0.0f;
+    if (vertices.empty() || tris.size() < 3 || tris.size() <= targetIndexCount) return tris;
+
+    glm::vec3 bbMin(FLT_MAX), bbMax(-FLT_MAX);
+    for (const Vertex& v : vertices) {
+        bbMin = glm::min(bbMin, v.Position);
+        bbMax = glm::max(bbMax, v.Position);
+    }
+    double diagonal = glm::length(bbMax - bbMin);
+    if (diagonal <= 0.0) return tris;
+    const double maxCost = (maxError * diagonal) * (maxError * diagonal);
+
+    const std::vector<bool> locked = findLockedVertices(vertices, tris);
+
+    std::vector<Quadric> quadrics(vertices.size());
+    for (size_t t = 0; t + 2 < tris.size(); t += 3) {
+        const glm::vec3& p0 = vertices[tris[t]].Position;
+        glm::vec3 n = triangleNormal(p0, vertices[tris[t + 1]].Position, vertices[tris[t + 2]].Position);
+        float len = glm::length(n);
+        if (len <= 0.0f) continue;
+        n /= len;
+        double d = -glm::dot(n, p0);
+        for (int k = 0; k < 3; ++k) quadrics[tris[t + k]].addPlane(n.x, n.y, n.z, d);
+    }
+
+    std::vector<glm::vec3> positions(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v) positions[v] = vertices[v].Position;
+
+    double worstAccepted = 0.0;
+    std::vector<unsigned int> adjOffset, adjTris;
+    std::vector<Collapse> candidates;
+    std::vector<bool> dirty;
+
+    // Each pass collapses an independent set of the cheapest edges, then rebuilds adjacency.
+    while (tris.size() > targetIndexCount) {
+        const size_t triCount = tris.size() / 3;
+
+        // vertex -> triangles (CSR)
+        adjOffset.assign(vertices.size() + 1, 0);
+        for (unsigned int idx : tris) adjOffset[idx + 1]++;
+        for (size_t v = 0; v < vertices.size(); ++v) adjOffset[v + 1] += adjOffset[v];
+        adjTris.resize(tris.size());
+        {
+            std::vector<unsigned int> fill(adjOffset.begin(), adjOffset.end() - 1);
+            for (size_t t = 0; t < triCount; ++t)
+                for (int k = 0; k < 3; ++k) adjTris[fill[tris[t * 3 + k]]++] = (unsigned int)t;
+        }
+
+        candidates.clear();
+        for (size_t t = 0; t < triCount; ++t) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = tris[t * 3 + e];
+                unsigned int b = tris[t * 3 + (e + 1) % 3];
+                // half-edge collapse onto an existing vertex keeps the vertex buffer (and its attributes) intact
+                for (int dir = 0; dir < 2; ++dir) {
+                    unsigned int from = dir ? b : a, to = dir ? a : b;
+                    if (locked[from]) continue;
+                    Quadric q = quadrics[from];
+                    q.add(quadrics[to]);
+                    double cost = std::max(0.0, q.evaluate(positions[to]));
+                    if (cost <= maxCost) candidates.push_back({ from, to, cost });
+                }
+            }
+        }
+        if (candidates.empty()) break;
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        dirty.assign(vertices.size(), false);
+        std::vector<bool> removed(triCount, false);
+        size_t liveIndices = tris.size();
+        size_t collapsed = 0;
+
+        for (const Collapse& c : candidates) {
+            if (liveIndices <= targetIndexCount) break;
+            if (dirty[c.from] || dirty[c.to]) continue;
+
+            // reject collapses that flip (or nearly flip) a surviving triangle
+            bool flips = false;
+            for (unsigned int i = adjOffset[c.from]; i < adjOffset[c.from + 1] && !flips; ++i) {
+                unsigned int t = adjTris[i];
+                if (removed[t]) continue;
+                unsigned int* tri = &tris[t * 3];
+                if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) continue; // collapses away
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = positions[tri[k]];
+                    q[k] = tri[k] == c.from ? positions[c.to] : p[k];
+                }
+                glm::vec3 before = triangleNormal(p[0], p[1], p[2]);
+                glm::vec3 after = triangleNormal(q[0], q[1], q[2]);
+                float lb = glm::length(before), la = glm::length(after);
+                if (la <= 1e-12f || (lb > 0.0f && glm::dot(before, after) < 0.2f * lb * la)) flips = true;
+            }
+            if (flips) continue;
+
+            for (unsigned int i = adjOffset[c.from]; i < adjOffset[c.from + 1]; ++i) {
+                unsigned int t = adjTris[i];
+                if (removed[t]) continue;
+                unsigned int* tri = &tris[t * 3];
+                for (int k = 0; k < 3; ++k) if (tri[k] == c.from) tri[k] = c.to;
+                if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+                    removed[t] = true;
+                    liveIndices -= 3;
+                }
+                dirty[tri[0]] = dirty[tri[1]] = dirty[tri[2]] = true;
+            }
+            quadrics[c.to].add(quadrics[c.from]);
+            dirty[c.from] = dirty[c.to] = true;
+            // neighbours' triangles changed shape: keep them out of this pass too
+            for (unsigned int i = adjOffset[c.to]; i < adjOffset[c.to + 1]; ++i) {
+                const unsigned int* tri = &tris[adjTris[i] * 3];
+                dirty[tri[0]] = dirty[tri[1]] = dirty[tri[2]] = true;
+            }
+            worstAccepted = std::max(worstAccepted, c.cost);
+            collapsed++;
+        }
+
+        if (collapsed == 0) break;
+
+        size_t out = 0;
+        for (size_t t = 0; t < triCount; ++t) {
+            if (removed[t]) continue;
+            for (int k = 0; k < 3; ++k) tris[out++] = tris[t * 3 + k];
+        }
+        tris.resize(out);
+    }
+
+    if (outError) *outError = float(std::sqrt(worstAccepted) / diagonal);
+    return tris;
+}
+
+MeshLodChain buildLodChain(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    MeshLodChain chain;
+    chain.indices = indices;
+    chain.lods.push_back({ 0u, (unsigned int)indices.size(), 0.0f });
+
+    std::vector<unsigned int> previous = indices;
+    float error = 0.0f;
+    for (int level = 0; level < MESH_LOD_MAX - 1; ++level) {
+        size_t target = size_t(indices.size() * LOD_TARGET_RATIO[level]) / 3 * 3;
+        float levelError = 0.0f;
+        std::vector<unsigned int> next = simplifyMesh(vertices, previous, target, LOD_MAX_ERROR[level], &levelError);
+
+        // not worth a level if it barely shrank (locked seams / error budget hit)
+        if (next.empty() || next.size() > previous.size() * 85 / 100) break;
+
+        error = std::max(error, levelError);
+        chain.lods.push_back({ (unsigned int)chain.indices.size(), (unsigned int)next.size(), error });
+        chain.indices.insert(chain.indices.end(), next.begin(), next.end());
+        previous = std::move(next);
+    }
+    return chain;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Cache file: magic, version, mesh count, then per mesh: level count, levels (offset, count, error),
+// index count, indices.
+
+static std::string lodCachePath(const std::string& modelPath)
+{
+    std::string key = modelPath;
+    for (char& c : key) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '_';
+        if (!ok) c = '_';
+    }
+    return std::string(TEXTURE_CACHE_DIR) + "/" + key + ".lod";
+}
+
+bool loadLodCache(const std::string& modelPath, std::vector<MeshLodChain>& chains)
+{
+    const std::string path = lodCachePath(modelPath);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) return false;
+    auto cacheTime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    auto srcTime = std::filesystem::last_write_time(modelPath, ec);
+    if (!ec && cacheTime < srcTime) return false;
+
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    bool ok = true;
+    auto read = [&](void* dst, size_t bytes) { if (ok && fread(dst, 1, bytes, f) != bytes) ok = false; };
+
+    uint32_t magic = 0, version = 0, meshCount = 0;
+    read(&magic, 4); read(&version, 4); read(&meshCount, 4);
+    if (!ok || magic != LOD_CACHE_MAGIC || version != LOD_CACHE_VERSION || meshCount > 100000) ok = false;
+
+    std::vector<MeshLodChain> loaded(ok ? meshCount : 0);
+    for (MeshLodChain& chain : loaded) {
+        uint32_t lodCount = 0, indexCount = 0;
+        read(&lodCount, 4);
+        if (!ok || lodCount == 0 || lodCount > MESH_LOD_MAX) { ok = false; break; }
+        chain.lods.resize(lodCount);
+        for (MeshLod& lod : chain.lods) {
+            read(&lod.indexOffset, 4); read(&lod.indexCount, 4); read(&lod.error, 4);
+        }
+        read(&indexCount, 4);
+        if (!ok) break;
+        chain.indices.resize(indexCount);
+        read(chain.indices.data(), size_t(indexCount) * 4);
+        for (const MeshLod& lod : chain.lods)
+            if (size_t(lod.indexOffset) + lod.indexCount > indexCount) ok = false;
+        if (!ok) break;
+    }
+    fclose(f);
+
+    if (!ok) {
+        std::cout << "LOD cache: ignoring malformed " << path << std::endl;
+        return false;
+    }
+    chains = std::move(loaded);
+    return true;
+}
+
+void saveLodCache(const std::string& modelPath, const std::vector<MeshLodChain>& chains)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(TEXTURE_CACHE_DIR, ec);
+
+    const std::string path = lodCachePath(modelPath);
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        std::cout << "LOD cache: cannot write " << path << std::endl;
+        return;
+    }
+    auto write32 = [&](uint32_t v) { fwrite(&v, 4, 1, f); };
+    write32(LOD_CACHE_MAGIC);
+    write32(LOD_CACHE_VERSION);
+    write32((uint32_t)chains.size());
+    for (const MeshLodChain& chain : chains) {
+        write32((uint32_t)chain.lods.size());
+        for (const MeshLod& lod : chain.lods) {
+            write32(lod.indexOffset);
+            write32(lod.indexCount);
+            fwrite(&lod.error, 4, 1, f);
+        }
+        write32((uint32_t)chain.indices.size());
+        fwrite(chain.indices.data(), 4, chain.indices.size(), f);
+    }
+    fclose(f);
+}
+
+// ---------------------------------------------------------------------------------------------
+
+float projectedHeightPx(float worldHeight, float distance, float fovYRadians, float viewportHeightPx)
+{
+    distance = std::max(distance, 1e-4f);
+    return worldHeight / (2.0f * distance * std::tan(fovYRadians * 0.5f)) * viewportHeightPx;
+}
+
+int selectLodLevel(float screenHeightPx, int currentLevel, int levelCount)
+{
+    if (levelCount <= 1) return 0;
+    int level = std::min(std::max(currentLevel, 0), levelCount - 1);
+    // coarser once clearly below the switch size, finer once clearly above it
+    while (level + 1 < levelCount && level < MESH_LOD_MAX - 1 && screenHeightPx < LOD_SWITCH_PX[level] * (1.0f - LOD_HYSTERESIS))
+        ++level;
+    while (level > 0 && screenHeightPx > LOD_SWITCH_PX[level - 1] * (1.0f + LOD_HYSTERESIS))
+        --level;
+    return level;
+}
@@ -0,0 +1,132 @@
+#include <GL/glew.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../Header/Minimap.h"
+
+static GLuint minimapFBO = 0;
+static GLuint minimapColor = 0;
+static GLuint minimapDepth = 0;
+
+static bool haveImage = false;
+static MinimapKey lastKey;
+static double lastRenderTime = 0.0;
+static std::chrono::steady_clock::time_point passStart;
+static GLint previousFBO = 0; // the back buffer or whatever the caller had bound
+static MinimapStats stats;
+
+static bool sameKey(const MinimapKey& a, const MinimapKey& b)
+{
+    return std::memcmp(&a.avatarModel, &b.avatarModel, sizeof(glm::mat4)) == 0 &&
+           a.measurementPoints == b.measurementPoints && a.measurementDistance == b.measurementDistance &&
+           a.walkRouteLength == b.walkRouteLength &&
+           a.light == b.light && a.mapOffset == b.mapOffset && a.mapTexScale == b.mapTexScale && a.shadows == b.shadows;
+}
+
+void initMinimap()
+{
+    glGenTextures(1, &minimapColor);
+    glBindTexture(GL_TEXTURE_2D, minimapColor);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, MINIMAP_SIZE, MINIMAP_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &minimapDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, minimapDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, MINIMAP_SIZE, MINIMAP_SIZE);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &minimapFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, minimapFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, minimapColor, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, minimapDepth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Minimap: framebuffer incomplete" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    haveImage = false;
+}
+
+void shutdownMinimap()
+{
+    if (minimapFBO) { glDeleteFramebuffers(1, &minimapFBO); minimapFBO = 0; }
+    if (minimapDepth) { glDeleteRenderbuffers(1, &minimapDepth); minimapDepth = 0; }
+    if (minimapColor) { glDeleteTextures(1, &minimapColor); minimapColor = 0; }
+    haveImage = false;
+}
+
+void minimapCamera(float planeHalf, glm::mat4& view, glm::mat4& projection, glm::vec3& eye)
+{
+    // +Z up on screen and +X to the left, like the R overview camera
+    eye = glm::vec3(0.0f, 30.0f, 0.0f);
+    view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    const float half = planeHalf * 1.02f;
+    projection = glm::ortho(-half, half, -half, half, 1.0f, 60.0f);
+}
+
+bool beginMinimapPass(const MinimapKey& key, double now)
+{
+    if (!minimapFBO) return false;
+
+    const double elapsed = now - lastRenderTime;
+    if (haveImage) {
+        bool changed = !sameKey(key, lastKey);
+        if ((changed && elapsed < MINIMAP_MIN_INTERVAL) || (!changed && elapsed < MINIMAP_IDLE_INTERVAL)) {
+            stats.reused++;
+            return false;
+        }
+    }
+    passStart = std::chrono::steady_clock::now();
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, minimapFBO);
+    glViewport(0, 0, MINIMAP_SIZE, MINIMAP_SIZE);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    lastKey = key;
+    lastRenderTime = now;
+    return true;
+}
+
+void endMinimapPass(int viewportW, int viewportH)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFBO);
+    glViewport(0, 0, viewportW, viewportH);
+    haveImage = true;
+    stats.renders++;
+    stats.lastRenderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - passStart).count();
+}
+
+void drawMinimap(int fbW, int fbH)
+{
+    if (!haveImage) return;
+    const int size = std::min(MINIMAP_SIZE, std::min(fbW, fbH) / 3);
+    if (size <= 0) return;
+    const int x1 = fbW - MINIMAP_MARGIN, y1 = fbH - MINIMAP_MARGIN;
+    const int x0 = x1 - size, y0 = y1 - size;
+
+    // frame: a 2 px cleared border under the image
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x0 - 2, y0 - 2, size + 4, size + 4);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+    GLint previousRead = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, minimapFBO);
+    glBlitFramebuffer(0, 0, MINIMAP_SIZE, MINIMAP_SIZE, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)previousRead);
+}
+
+const MinimapStats& minimapStats()
+{
+    return stats;
+}
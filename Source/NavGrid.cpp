@@ -0,0 +1,589 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+
+#include "../Header/NavGrid.h"
+#include "../Header/Startup.h"
+#include "../Header/ThreadPool.h"
+#include "../Header/stb_image.h"
+
+static const float SQRT2 = 1.41421356f;
+
+NavGrid::NavGrid(int width, int height, float worldHalf)
+    : cellsX(width), cellsZ(height), half(worldHalf)
+{
+    wordsPerRow = (cellsX + 63) >> 6;
+    blocksX = (cellsX + NAV_BLOCK - 1) >> NAV_BLOCK_SHIFT;
+    blocksZ = (cellsZ + NAV_BLOCK - 1) >> NAV_BLOCK_SHIFT;
+    cell = 2.0f * worldHalf / (float)cellsX;
+    bits.assign((size_t)wordsPerRow * cellsZ, 0);
+    blocks.assign((size_t)blocksX * blocksZ, NAV_BLOCK_FREE);
+}
+
+void NavGrid::setBlocked(int x, int z, bool isBlocked)
+{
+    if ((unsigned)x >= (unsigned)cellsX || (unsigned)z >= (unsigned)cellsZ) return;
+    uint64_t& word = bits[(size_t)z * wordsPerRow + (x >> 6)];
+    const uint64_t bit = uint64_t(1) << (x & 63);
+    if (isBlocked) word |= bit;
+    else word &= ~bit;
+}
+
+// any blocked cell in [xa, xb] of row z (inclusive, in range), a word at a time
+static bool rowBlocked(const uint64_t* row, int xa, int xb)
+{
+    const int wa = xa >> 6, wb = xb >> 6;
+    for (int w = wa; w <= wb; ++w) {
+        uint64_t mask = ~uint64_t(0);
+        if (w == wa) mask &= ~uint64_t(0) << (xa & 63);
+        if (w == wb) mask &= ~uint64_t(0) >> (63 - (xb & 63));
+        if (row[w] & mask) return true;
+    }
+    return false;
+}
+
+void NavGrid::rebuildBlocks()
+{
+    for (int bz = 0; bz < blocksZ; ++bz) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            const int x0 = bx << NAV_BLOCK_SHIFT, z0 = bz << NAV_BLOCK_SHIFT;
+            const int x1 = std::min(x0 + NAV_BLOCK, cellsX), z1 = std::min(z0 + NAV_BLOCK, cellsZ);
+            int count = 0;
+            for (int z = z0; z < z1; ++z)
+                for (int x = x0; x < x1; ++x) count += blocked(x, z);
+            const int total = (x1 - x0) * (z1 - z0);
+            blocks[(size_t)bz * blocksX + bx] = count == 0 ? NAV_BLOCK_FREE : count == total ? NAV_BLOCK_FULL : NAV_BLOCK_MIXED;
+        }
+    }
+}
+
+NavGrid NavGrid::inflated(float radius) const
+{
+    NavGrid out = *this;
+    const int k = (int)std::ceil(radius / cell);
+    // neighbour offsets whose cell rectangle comes closer than radius (gap = whole cells between the two)
+    std::vector<glm::ivec2> offsets;
+    for (int oz = -k; oz <= k; ++oz) {
+        for (int ox = -k; ox <= k; ++ox) {
+            const float gx = (float)std::max(0, std::abs(ox) - 1) * cell, gz = (float)std::max(0, std::abs(oz) - 1) * cell;
+            if ((ox || oz) && gx * gx + gz * gz < radius * radius) offsets.push_back(glm::ivec2(ox, oz));
+        }
+    }
+    for (int bz = 0; bz < blocksZ; ++bz) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            const int x0 = bx << NAV_BLOCK_SHIFT, z0 = bz << NAV_BLOCK_SHIFT;
+            const int x1 = std::min(x0 + NAV_BLOCK, cellsX) - 1, z1 = std::min(z0 + NAV_BLOCK, cellsZ) - 1;
+            if (cellsFree(x0 - k, z0 - k, x1 + k, z1 + k)) continue; // open ground around the whole block
+            for (int z = z0; z <= z1; ++z) {
+                for (int x = x0; x <= x1; ++x) {
+                    if (blocked(x, z)) continue;
+                    for (const glm::ivec2& o : offsets) {
+                        if (blocked(x + o.x, z + o.y)) { out.setBlocked(x, z, true); break; }
+                    }
+                }
+            }
+        }
+    }
+    out.rebuildBlocks();
+    return out;
+}
+
+float NavGrid::blockedFraction() const
+{
+    size_t count = 0;
+    for (uint64_t w : bits) {
+        for (; w; w &= w - 1) count++;
+    }
+    return cellsX && cellsZ ? (float)count / ((float)cellsX * (float)cellsZ) : 0.0f;
+}
+
+glm::ivec2 NavGrid::cellAt(const glm::vec2& p) const
+{
+    return glm::ivec2((int)std::floor((p.x + half) / cell), (int)std::floor((p.y + half) / cell));
+}
+
+glm::vec2 NavGrid::cellCenter(const glm::ivec2& c) const
+{
+    return glm::vec2(-half + ((float)c.x + 0.5f) * cell, -half + ((float)c.y + 0.5f) * cell);
+}
+
+bool NavGrid::walkable(const glm::vec2& p) const
+{
+    const glm::ivec2 c = cellAt(p);
+    return !blocked(c.x, c.y);
+}
+
+bool NavGrid::cellsFree(int x0, int z0, int x1, int z1) const
+{
+    if (x0 < 0 || z0 < 0 || x1 >= cellsX || z1 >= cellsZ) return false;
+    for (int bz = z0 >> NAV_BLOCK_SHIFT; bz <= (z1 >> NAV_BLOCK_SHIFT); ++bz) {
+        for (int bx = x0 >> NAV_BLOCK_SHIFT; bx <= (x1 >> NAV_BLOCK_SHIFT); ++bx) {
+            const NavBlockState state = blockState(bx, bz);
+            if (state == NAV_BLOCK_FREE) continue;
+            if (state == NAV_BLOCK_FULL) return false;
+            // mixed: only the part of the block inside the rectangle
+            const int xa = std::max(x0, bx << NAV_BLOCK_SHIFT), xb = std::min(x1, ((bx + 1) << NAV_BLOCK_SHIFT) - 1);
+            const int za = std::max(z0, bz << NAV_BLOCK_SHIFT), zb = std::min(z1, ((bz + 1) << NAV_BLOCK_SHIFT) - 1);
+            for (int z = za; z <= zb; ++z)
+                if (rowBlocked(&bits[(size_t)z * wordsPerRow], xa, xb)) return false;
+        }
+    }
+    return true;
+}
+
+bool NavGrid::circleFree(const glm::vec2& center, float radius) const
+{
+    const glm::ivec2 lo = cellAt(center - glm::vec2(radius));
+    const glm::ivec2 hi = cellAt(center + glm::vec2(radius));
+    if (cellsFree(lo.x, lo.y, hi.x, hi.y)) return true;
+
+    // something blocked near: exact circle / cell test for those
+    for (int z = lo.y; z <= hi.y; ++z) {
+        for (int x = lo.x; x <= hi.x; ++x) {
+            if (!blocked(x, z)) continue;
+            const glm::vec2 cmin(-half + x * cell, -half + z * cell);
+            const glm::vec2 nearest = glm::clamp(center, cmin, cmin + glm::vec2(cell));
+            const glm::vec2 d = center - nearest;
+            if (glm::dot(d, d) < radius * radius) return false;
+        }
+    }
+    return true;
+}
+
+bool NavGrid::segmentFree(const glm::vec2& a, const glm::vec2& b) const
+{
+    glm::ivec2 c = cellAt(a);
+    const glm::ivec2 end = cellAt(b);
+    if (cellsFree(std::min(c.x, end.x), std::min(c.y, end.y), std::max(c.x, end.x), std::max(c.y, end.y))) return true;
+
+    // cell walk along the segment (Amanatides & Woo)
+    const glm::vec2 d = b - a;
+    const int stepX = d.x > 0.0f ? 1 : -1, stepZ = d.y > 0.0f ? 1 : -1;
+    const float inf = 1e30f;
+    const float deltaX = d.x != 0.0f ? cell / std::fabs(d.x) : inf;
+    const float deltaZ = d.y != 0.0f ? cell / std::fabs(d.y) : inf;
+    const glm::vec2 cmin(-half + c.x * cell, -half + c.y * cell);
+    float tMaxX = d.x != 0.0f ? ((stepX > 0 ? cmin.x + cell - a.x : a.x - cmin.x) / std::fabs(d.x)) : inf;
+    float tMaxZ = d.y != 0.0f ? ((stepZ > 0 ? cmin.y + cell - a.y : a.y - cmin.y) / std::fabs(d.y)) : inf;
+
+    const int maxSteps = std::abs(end.x - c.x) + std::abs(end.y - c.y) + 1;
+    for (int i = 0; i <= maxSteps; ++i) {
+        if (blocked(c.x, c.y)) return false;
+        if (c == end) return true;
+        if (tMaxX < tMaxZ) { tMaxX += deltaX; c.x += stepX; }
+        else { tMaxZ += deltaZ; c.y += stepZ; }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Search (A* / JPS)
+// ---------------------------------------------------------------------------------------------
+
+// per-thread scratch sized to the grid; stamps instead of clearing between searches
+struct NavScratch {
+    std::vector<float> g;
+    std::vector<int> parent;
+    std::vector<uint32_t> seen;    // == stamp: g / parent are valid this search
+    std::vector<uint32_t> closed;  // == stamp: expanded
+    uint32_t stamp = 0;
+
+    void begin(size_t cells)
+    {
+        if (g.size() < cells) {
+            g.resize(cells);
+            parent.resize(cells);
+            seen.assign(cells, 0);
+            closed.assign(cells, 0);
+        }
+        if (++stamp == 0) { // wrapped
+            std::fill(seen.begin(), seen.end(), 0);
+            std::fill(closed.begin(), closed.end(), 0);
+            stamp = 1;
+        }
+    }
+};
+
+static float octile(int dx, int dz)
+{
+    dx = std::abs(dx);
+    dz = std::abs(dz);
+    return (float)std::max(dx, dz) + (SQRT2 - 1.0f) * (float)std::min(dx, dz);
+}
+
+static int sign(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+// Straight jump: true if (x, z) + k * (dx, dz) reaches the goal or a cell with a forced neighbour.
+static bool jumpStraightFinds(const NavGrid& grid, int x, int z, int dx, int dz, const glm::ivec2& goal)
+{
+    while (true) {
+        x += dx;
+        z += dz;
+        if (grid.blocked(x, z)) return false;
+        if (x == goal.x && z == goal.y) return true;
+        if (dx) {
+            if ((!grid.blocked(x, z - 1) && grid.blocked(x - dx, z - 1)) || (!grid.blocked(x, z + 1) && grid.blocked(x - dx, z + 1))) return true;
+        } else {
+            if ((!grid.blocked(x - 1, z) && grid.blocked(x - 1, z - dz)) || (!grid.blocked(x + 1, z) && grid.blocked(x + 1, z - dz))) return true;
+        }
+    }
+}
+
+// Jump from (x, z) in (dx, dz); diagonal steps need both orthogonal cells open. Returns false if it runs into
+// a wall, otherwise the jump point in out.
+static bool jump(const NavGrid& grid, int x, int z, int dx, int dz, const glm::ivec2& goal, glm::ivec2& out)
+{
+    while (true) {
+        if (dx && dz && (grid.blocked(x + dx, z) || grid.blocked(x, z + dz))) return false;
+        x += dx;
+        z += dz;
+        if (grid.blocked(x, z)) return false;
+        if (x == goal.x && z == goal.y) break;
+        if (dx && dz) {
+            if (jumpStraightFinds(grid, x, z, dx, 0, goal) || jumpStraightFinds(grid, x, z, 0, dz, goal)) break;
+        } else if (dx) {
+            if ((!grid.blocked(x, z - 1) && grid.blocked(x - dx, z - 1)) || (!grid.blocked(x, z + 1) && grid.blocked(x - dx, z + 1))) break;
+        } else {
+            if ((!grid.blocked(x - 1, z) && grid.blocked(x - 1, z - dz)) || (!grid.blocked(x + 1, z) && grid.blocked(x + 1, z - dz))) break;
+        }
+    }
+    out = glm::ivec2(x, z);
+    return true;
+}
+
+// Directions worth following from a node reached in (dx, dz) (JPS pruning); every direction for the start.
+// Without corner cutting a diagonal move has only its natural neighbours. A straight move keeps going, and
+// turns to a side only where the cell beside the parent is blocked (forced neighbour): when it is open, that
+// side is reached at least as cheaply through it.
+static int prunedDirections(const NavGrid& grid, int x, int z, int dx, int dz, glm::ivec2* dirs)
+{
+    int n = 0;
+    if (!dx && !dz) {
+        for (int oz = -1; oz <= 1; ++oz)
+            for (int ox = -1; ox <= 1; ++ox)
+                if (ox || oz) dirs[n++] = glm::ivec2(ox, oz);
+        return n;
+    }
+    if (dx && dz) {
+        dirs[n++] = glm::ivec2(0, dz);
+        dirs[n++] = glm::ivec2(dx, 0);
+        dirs[n++] = glm::ivec2(dx, dz);
+        return n;
+    }
+    if (dx) {
+        dirs[n++] = glm::ivec2(dx, 0);
+        for (int side = -1; side <= 1; side += 2) {
+            if (grid.blocked(x, z + side) || !grid.blocked(x - dx, z + side)) continue;
+            dirs[n++] = glm::ivec2(0, side);
+            dirs[n++] = glm::ivec2(dx, side);
+        }
+    } else {
+        dirs[n++] = glm::ivec2(0, dz);
+        for (int side = -1; side <= 1; side += 2) {
+            if (grid.blocked(x + side, z) || !grid.blocked(x + side, z - dz)) continue;
+            dirs[n++] = glm::ivec2(side, 0);
+            dirs[n++] = glm::ivec2(side, dz);
+        }
+    }
+    return n;
+}
+
+std::vector<glm::ivec2> findNavPath(const NavGrid& grid, const glm::ivec2& start, const glm::ivec2& goal,
+                                    NavSearch search, NavSearchStats* stats)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<glm::ivec2> path;
+    int expanded = 0;
+
+    if (!grid.blocked(start.x, start.y) && !grid.blocked(goal.x, goal.y)) {
+        static thread_local NavScratch s;
+        const int W = grid.width();
+        s.begin((size_t)W * grid.height());
+
+        typedef std::pair<float, int> Entry; // f, cell index
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        const int startIndex = start.y * W + start.x, goalIndex = goal.y * W + goal.x;
+        s.g[startIndex] = 0.0f;
+        s.parent[startIndex] = -1;
+        s.seen[startIndex] = s.stamp;
+        open.push(Entry(octile(goal.x - start.x, goal.y - start.y), startIndex));
+
+        // relax the edge cur -> (nx, nz) (a straight / diagonal run of length cost)
+        auto relax = [&](int cur, int nx, int nz, float cost) {
+            const int ni = nz * W + nx;
+            if (s.closed[ni] == s.stamp) return;
+            const float g = s.g[cur] + cost;
+            if (s.seen[ni] == s.stamp && g >= s.g[ni]) return;
+            s.seen[ni] = s.stamp;
+            s.g[ni] = g;
+            s.parent[ni] = cur;
+            open.push(Entry(g + octile(goal.x - nx, goal.y - nz), ni));
+        };
+
+        bool found = false;
+        while (!open.empty()) {
+            const int cur = open.top().second;
+            open.pop();
+            if (s.closed[cur] == s.stamp) continue; // stale entry
+            s.closed[cur] = s.stamp;
+            expanded++;
+            if (cur == goalIndex) { found = true; break; }
+
+            const int x = cur % W, z = cur / W;
+            if (search == NAV_SEARCH_JPS) {
+                int dx = 0, dz = 0;
+                if (s.parent[cur] >= 0) {
+                    dx = sign(x - s.parent[cur] % W);
+                    dz = sign(z - s.parent[cur] / W);
+                }
+                glm::ivec2 dirs[8];
+                const int n = prunedDirections(grid, x, z, dx, dz, dirs);
+                for (int i = 0; i < n; ++i) {
+                    glm::ivec2 jp;
+                    if (jump(grid, x, z, dirs[i].x, dirs[i].y, goal, jp)) relax(cur, jp.x, jp.y, octile(jp.x - x, jp.y - z));
+                }
+            } else {
+                for (int oz = -1; oz <= 1; ++oz) {
+                    for (int ox = -1; ox <= 1; ++ox) {
+                        if (!ox && !oz) continue;
+                        if (grid.blocked(x + ox, z + oz)) continue;
+                        if (ox && oz && (grid.blocked(x + ox, z) || grid.blocked(x, z + oz))) continue; // no corner cutting
+                        relax(cur, x + ox, z + oz, (ox && oz) ? SQRT2 : 1.0f);
+                    }
+                }
+            }
+        }
+
+        if (found) {
+            for (int i = goalIndex; i >= 0; i = s.parent[i]) path.push_back(glm::ivec2(i % W, i / W));
+            std::reverse(path.begin(), path.end());
+
+            // corners only (A* gives every cell, JPS already gives jump points)
+            std::vector<glm::ivec2> corners;
+            for (size_t i = 0; i < path.size(); ++i) {
+                if (i == 0 || i + 1 == path.size()) { corners.push_back(path[i]); continue; }
+                const glm::ivec2 in(sign(path[i].x - path[i - 1].x), sign(path[i].y - path[i - 1].y));
+                const glm::ivec2 outDir(sign(path[i + 1].x - path[i].x), sign(path[i + 1].y - path[i].y));
+                if (in != outDir) corners.push_back(path[i]);
+            }
+            path.swap(corners);
+        }
+    }
+
+    if (stats) {
+        stats->expanded = expanded;
+        stats->ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+    return path;
+}
+
+std::vector<glm::vec2> smoothNavPath(const NavGrid& clearance, const std::vector<glm::ivec2>& cells)
+{
+    std::vector<glm::vec2> points;
+    if (cells.empty()) return points;
+    points.push_back(clearance.cellCenter(cells[0]));
+    size_t anchor = 0;
+    for (size_t i = 2; i < cells.size(); ++i) {
+        if (!clearance.segmentFree(clearance.cellCenter(cells[anchor]), clearance.cellCenter(cells[i]))) {
+            anchor = i - 1;
+            points.push_back(clearance.cellCenter(cells[anchor]));
+        }
+    }
+    if (cells.size() > 1) points.push_back(clearance.cellCenter(cells.back()));
+    return points;
+}
+
+// ---------------------------------------------------------------------------------------------
+// The map's grid
+// ---------------------------------------------------------------------------------------------
+
+static NavGrid mapGrid;
+static NavGrid mapClearance; // mapGrid inflated by NAV_AVATAR_RADIUS
+static std::mutex buildMutex;
+static std::condition_variable buildCv;
+static bool buildStarted = false;
+static bool buildDone = false;
+static bool buildOk = false;
+static std::atomic<bool> gridReady{ false };
+
+static std::mutex routeMutex;
+static unsigned latestRequest = 0;
+static NavRoute finishedRoute;
+static bool haveFinishedRoute = false;
+
+static NavStats stats;
+
+// water on the map image: clearly blue
+static bool isWater(const unsigned char* rgb)
+{
+    return rgb[2] > 160 && rgb[2] >= rgb[1] && rgb[2] > rgb[0] + 48;
+}
+
+// Cell (x, z) covers a rectangle of the image: the plane maps U = 0.5 - x / size, and the image (row 0 =
+// bottom, as uploaded to GL) runs from -Z at the bottom to +Z at the top.
+static bool buildMapGrid(const std::vector<unsigned char>& mapRgba, int mapW, int mapH, float worldHalf, bool& fromMask)
+{
+    stbi_set_flip_vertically_on_load_thread(1); // the mask bottom row first too
+    int w = 0, h = 0, n = 0;
+    unsigned char* mask = stbi_load(NAV_MASK_PATH, &w, &h, &n, 1);
+    fromMask = mask != nullptr;
+    const unsigned char* pixels = mask;
+    if (!mask) {
+        if (mapRgba.empty()) {
+            std::cout << "Navigation: no map image, movement is only clamped to the map" << std::endl;
+            return false;
+        }
+        pixels = mapRgba.data();
+        w = mapW;
+        h = mapH;
+    }
+
+    const int cells = NAV_GRID_CELLS;
+    mapGrid = NavGrid(cells, cells, worldHalf);
+    const int channels = fromMask ? 1 : 4;
+    for (int z = 0; z < cells; ++z) {
+        // image rows of this cell row (bottom of the image = -Z)
+        const int r0 = z * h / cells, r1 = std::max(r0 + 1, (z + 1) * h / cells);
+        for (int x = 0; x < cells; ++x) {
+            const int c0 = (cells - 1 - x) * w / cells, c1 = std::max(c0 + 1, (cells - x) * w / cells);
+            int blockedPixels = 0, total = 0;
+            for (int r = r0; r < r1; ++r) {
+                for (int c = c0; c < c1; ++c) {
+                    const unsigned char* p = pixels + ((size_t)r * w + c) * channels;
+                    blockedPixels += fromMask ? (p[0] < 128) : isWater(p);
+                    total++;
+                }
+            }
+            mapGrid.setBlocked(x, z, blockedPixels * 2 > total);
+        }
+    }
+    if (mask) stbi_image_free(mask);
+    mapGrid.rebuildBlocks();
+    mapClearance = mapGrid.inflated(NAV_AVATAR_RADIUS);
+    return true;
+}
+
+void startNavGridBuild(std::vector<unsigned char> mapRgba, int width, int height, float worldHalf)
+{
+    {
+        std::lock_guard<std::mutex> lock(buildMutex);
+        if (buildStarted) return;
+        buildStarted = true;
+    }
+    auto pixels = std::make_shared<std::vector<unsigned char>>(std::move(mapRgba));
+    workerPool().submit([pixels, width, height, worldHalf] {
+        StartupPhase phase("nav grid build", false, true); // new work, not in the startup baseline
+        const auto t0 = std::chrono::steady_clock::now();
+        bool fromMask = false;
+        const bool ok = buildMapGrid(*pixels, width, height, worldHalf, fromMask);
+        pixels->clear();
+        pixels->shrink_to_fit();
+        stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        stats.fromMask = fromMask;
+        if (ok) stats.blockedFraction = mapGrid.blockedFraction();
+        {
+            std::lock_guard<std::mutex> lock(buildMutex);
+            buildOk = ok;
+            buildDone = true;
+        }
+        gridReady.store(true, std::memory_order_release);
+        buildCv.notify_all();
+    });
+}
+
+const NavGrid* waitNavGrid()
+{
+    std::unique_lock<std::mutex> lock(buildMutex);
+    if (!buildStarted) return nullptr;
+    buildCv.wait(lock, [] { return buildDone; });
+    return buildOk ? &mapGrid : nullptr;
+}
+
+const NavGrid* navGrid()
+{
+    if (!gridReady.load(std::memory_order_acquire)) return nullptr;
+    return buildOk ? &mapGrid : nullptr;
+}
+
+// Legs are searched on the clearance grid, so the route keeps the avatar's radius off the water and can be
+// shortened freely; where that finds nothing (a passage narrower than the avatar, or a waypoint by the water)
+// the plain grid's path is used as it is.
+static NavRoute searchRoute(const NavGrid* grid, const NavGrid* clearance, const std::vector<glm::vec2>& waypoints, NavSearch search)
+{
+    NavRoute route;
+    if (waypoints.size() < 2) return route;
+    route.complete = true;
+    route.points.push_back(glm::vec3(waypoints[0].x, 0.0f, waypoints[0].y));
+    for (size_t i = 1; i < waypoints.size(); ++i) {
+        std::vector<glm::vec2> leg;
+        if (grid) {
+            const glm::ivec2 from = grid->cellAt(waypoints[i - 1]), to = grid->cellAt(waypoints[i]);
+            NavSearchStats legStats;
+            std::vector<glm::ivec2> cells = findNavPath(*clearance, from, to, search, &legStats);
+            route.search.expanded += legStats.expanded;
+            route.search.ms += legStats.ms;
+            if (cells.empty()) {
+                cells = findNavPath(*grid, from, to, search, &legStats);
+                route.search.expanded += legStats.expanded;
+                route.search.ms += legStats.ms;
+            }
+            leg = smoothNavPath(*clearance, cells);
+        }
+        if (leg.size() < 2) {
+            route.complete = false; // no grid / no path: straight
+            leg = { waypoints[i - 1], waypoints[i] };
+        }
+        // the leg runs between cell centers: keep the exact waypoints at its ends
+        leg.front() = waypoints[i - 1];
+        leg.back() = waypoints[i];
+        for (size_t k = 1; k < leg.size(); ++k) route.points.push_back(glm::vec3(leg[k].x, 0.0f, leg[k].y));
+    }
+    for (size_t i = 1; i < route.points.size(); ++i) route.length += glm::length(route.points[i] - route.points[i - 1]);
+    return route;
+}
+
+unsigned requestNavRoute(const std::vector<glm::vec2>& waypoints, NavSearch search)
+{
+    unsigned id;
+    {
+        std::lock_guard<std::mutex> lock(routeMutex);
+        id = ++latestRequest;
+    }
+    const NavGrid* grid = navGrid();
+    const NavGrid* clearance = grid ? &mapClearance : nullptr;
+    workerPool().submit([grid, clearance, waypoints, search, id] {
+        NavRoute route = searchRoute(grid, clearance, waypoints, search);
+        route.request = id;
+        std::lock_guard<std::mutex> lock(routeMutex);
+        if (id != latestRequest) return; // a newer request is on its way
+        finishedRoute = std::move(route);
+        haveFinishedRoute = true;
+    });
+    return id;
+}
+
+bool takeNavRoute(NavRoute& route)
+{
+    std::lock_guard<std::mutex> lock(routeMutex);
+    if (!haveFinishedRoute) return false;
+    route = std::move(finishedRoute);
+    haveFinishedRoute = false;
+    stats.routes++;
+    stats.lastRouteMs = route.search.ms;
+    stats.lastRouteExpanded = route.search.expanded;
+    return true;
+}
+
+const NavStats& navStats()
+{
+    return stats;
+}
@@ -4,6 +4,7 @@
 
 #include "../Header/OverlayDraw.h"
 #include "../Header/Util.h" // for createShader
+#include "../Header/ShaderReload.h"
 
 // Local shader + GL objects used to draw simple overlay geometry in pixel coords.
 // We reuse the same text shaders ("text.vert"/"text.frag") which provide a
@@ -21,6 +22,10 @@ static void ensureInitialized() {
     overlayProg = createShader("text.vert", "text.frag");
     uResolutionLoc = glGetUniformLocation(overlayProg, "uResolution");
     uColorLoc = glGetUniformLocation(overlayProg, "uColor");
+    watchShaderProgram(&overlayProg, "text.vert", "text.frag", [](unsigned program) {
+        uResolutionLoc = glGetUniformLocation(program, "uResolution");
+        uColorLoc = glGetUniformLocation(program, "uColor");
+    });
 
     glGenVertexArrays(1, &overlayVAO);
     glGenBuffers(1, &overlayVBO);
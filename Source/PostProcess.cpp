@@ -0,0 +1,439 @@
+#include <GL/glew.h>
+#include <cmath>
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+#include "../Header/PostProcess.h"
+#include "../Header/Profiler.h"
+#include "../Header/SceneState.h"
+#include "../Header/shader.hpp"
+
+struct RenderTarget {
+    GLuint fbo = 0;
+    GLuint color = 0;
+    int width = 0, height = 0;
+};
+
+// what the targets were last built for
+struct TargetConfig {
+    int width = 0, height = 0;
+    int bloomQuality = -1;
+    int samples = 0;      // 0 = single-sampled scene
+    bool fxaa = false;
+};
+
+// profiler pass of the post part, one per AA mode (and MSAA sample count), so its GPU result says which
+// mode it was measured with; seen = the profiler's result count last read
+struct PostPass {
+    const char* name;
+    int mode;
+    int samples;
+    unsigned seen;
+};
+#define SCENE_PASS "scene"
+
+// dynamic resolution controller
+#define SCALE_STEP 0.05f      // scale is quantized, so the targets are rebuilt only on real changes
+#define SCALE_COOLDOWN 30     // frames to wait after a change (query latency + smoothing settle)
+#define SCALE_DOWN_AT 0.95    // over this fraction of the budget: shrink
+#define SCALE_UP_AT 0.75      // under this fraction: grow one step (the band between is the hysteresis)
+
+static RenderSettings settings; // this frame's, copied by beginScenePass
+static RenderTarget scene;
+static GLuint sceneDepth = 0;
+static GLuint msaaFBO = 0, msaaColor = 0, msaaDepth = 0;
+static RenderTarget ldr; // composite output for FXAA
+static RenderTarget mips[BLOOM_MAX_MIPS];
+static TargetConfig built;
+static int maxSamples = 1;
+
+static Shader* downShader = nullptr;
+static Shader* upShader = nullptr;
+static Shader* compositeShader = nullptr;
+static Shader* fxaaShader = nullptr;
+static GLuint emptyVAO = 0; // full-screen triangle comes from gl_VertexID
+
+static bool sceneActive = false;
+static int frameMode = AA_OFF;
+static int frameSamples = 0;
+static int outputWidth = 0, outputHeight = 0; // back buffer size, the scene may be smaller
+static int sceneW = 0, sceneH = 0;
+
+static float renderScale = 1.0f;
+static double smoothedGpuMs = 0.0;
+static int scaleCooldown = 0;
+
+static PostPass postPasses[] = {
+    { "post", AA_OFF, 0, 0 },
+    { "post (MSAA 2x)", AA_MSAA, 2, 0 },
+    { "post (MSAA 4x)", AA_MSAA, 4, 0 },
+    { "post (MSAA 8x)", AA_MSAA, 8, 0 },
+    { "post (FXAA)", AA_FXAA, 0, 0 },
+};
+static unsigned sceneSeen = 0;
+static PostProcessStats stats;
+
+static void destroyTarget(RenderTarget& t)
+{
+    if (t.fbo) glDeleteFramebuffers(1, &t.fbo);
+    if (t.color) glDeleteTextures(1, &t.color);
+    t = RenderTarget();
+}
+
+static void createTarget(RenderTarget& t, int w, int h, GLenum format)
+{
+    destroyTarget(t);
+    t.width = w;
+    t.height = h;
+    glGenTextures(1, &t.color);
+    glBindTexture(GL_TEXTURE_2D, t.color);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &t.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, t.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, t.color, 0);
+}
+
+static void destroyMsaa()
+{
+    if (msaaFBO) { glDeleteFramebuffers(1, &msaaFBO); msaaFBO = 0; }
+    if (msaaColor) { glDeleteRenderbuffers(1, &msaaColor); msaaColor = 0; }
+    if (msaaDepth) { glDeleteRenderbuffers(1, &msaaDepth); msaaDepth = 0; }
+}
+
+static void checkComplete(const char* what, int w, int h)
+{
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "PostProcess: " << what << " framebuffer incomplete (" << w << " x " << h << ")" << std::endl;
+}
+
+// (Re)build the scene target, the MSAA target, the FXAA target and the bloom chain for this config.
+static void ensureTargets(const TargetConfig& want)
+{
+    if (built.width == want.width && built.height == want.height && built.bloomQuality == want.bloomQuality &&
+        built.samples == want.samples && built.fxaa == want.fxaa) return;
+    const int w = want.width, h = want.height;
+
+    // the single-sampled scene is what bloom / composite read; with MSAA it is the resolve target and
+    // needs no depth of its own
+    createTarget(scene, w, h, GL_RGBA16F);
+    if (sceneDepth) { glDeleteRenderbuffers(1, &sceneDepth); sceneDepth = 0; }
+    if (!want.samples) {
+        glGenRenderbuffers(1, &sceneDepth);
+        glBindRenderbuffer(GL_RENDERBUFFER, sceneDepth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, sceneDepth);
+    }
+    checkComplete("scene", w, h);
+
+    destroyMsaa();
+    if (want.samples) {
+        glGenRenderbuffers(1, &msaaColor);
+        glBindRenderbuffer(GL_RENDERBUFFER, msaaColor);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, want.samples, GL_RGBA16F, w, h);
+        glGenRenderbuffers(1, &msaaDepth);
+        glBindRenderbuffer(GL_RENDERBUFFER, msaaDepth);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, want.samples, GL_DEPTH_COMPONENT24, w, h);
+        glGenFramebuffers(1, &msaaFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, msaaFBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msaaColor);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, msaaDepth);
+        checkComplete("MSAA scene", w, h);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    if (want.fxaa) createTarget(ldr, w, h, GL_RGBA8);
+    else destroyTarget(ldr);
+
+    // bloom only needs low precision: R11G11B10 halves the bandwidth of RGBA16F
+    for (int i = 0; i < BLOOM_MAX_MIPS; ++i) destroyTarget(mips[i]);
+    const int wantMips = want.bloomQuality >= 2 ? BLOOM_MAX_MIPS : want.bloomQuality == 1 ? 4 : 0;
+    int mw = w / 2, mh = h / 2;
+    for (int i = 0; i < wantMips && mw >= 8 && mh >= 8; ++i) {
+        createTarget(mips[i], mw, mh, GL_R11F_G11F_B10F);
+        mw /= 2;
+        mh /= 2;
+    }
+    built = want;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+static const PostPass& postPassFor(int mode, int samples)
+{
+    const PostPass* pass = &postPasses[0];
+    for (const PostPass& p : postPasses) {
+        if (p.mode == mode && p.samples <= samples) pass = &p; // largest listed count not above the real one
+    }
+    return *pass;
+}
+
+// Take the frame the profiler resolved in profilerBeginFrame, if it has one (the profiler never waits).
+static void readPassTimes()
+{
+    unsigned results = 0;
+    const double sceneMs = profilerGpuMs(SCENE_PASS, &results);
+    if (results == sceneSeen) return;
+    sceneSeen = results;
+
+    const PostPass* pass = nullptr;
+    double postMs = 0.0;
+    for (PostPass& p : postPasses) {
+        const double ms = profilerGpuMs(p.name, &results);
+        if (results == p.seen) continue;
+        p.seen = results;
+        pass = &p;
+        postMs = ms;
+    }
+    if (!pass) return;
+    stats.sceneMs = sceneMs;
+    stats.postMs = postMs;
+
+    // a sample count change restarts the MSAA average
+    double& avg = stats.modeMs[pass->mode];
+    if (pass->mode == AA_MSAA && stats.modeSamples != pass->samples) {
+        avg = 0.0;
+        stats.modeSamples = pass->samples;
+    }
+    const double frameMs = stats.sceneMs + stats.postMs;
+    avg = avg == 0.0 ? frameMs : avg * 0.9 + frameMs * 0.1;
+    smoothedGpuMs = smoothedGpuMs == 0.0 ? frameMs : smoothedGpuMs * 0.8 + frameMs * 0.2;
+    stats.gpuFrameMs = smoothedGpuMs;
+}
+
+static float quantizeScale(float s)
+{
+    const float lo = glm::clamp(settings.renderScaleMin, SCALE_STEP, 1.0f);
+    const float hi = glm::clamp(settings.renderScaleMax, lo, 1.0f);
+    s = std::floor(s / SCALE_STEP + 0.01f) * SCALE_STEP;
+    return glm::clamp(s, lo, hi);
+}
+
+// Pick this frame's render scale from the smoothed GPU time. Pixel count goes with scale^2, so going
+// down jumps straight to the scale that should fit; going up is one step at a time.
+static void updateRenderScale()
+{
+    if (!settings.dynamicResolution) {
+        renderScale = 1.0f;
+        scaleCooldown = 0;
+        return;
+    }
+    renderScale = quantizeScale(renderScale); // follows min/max edits
+    if (scaleCooldown > 0) { scaleCooldown--; return; }
+    if (smoothedGpuMs <= 0.0 || settings.dynamicResolutionTargetMs <= 0.0f) return;
+
+    const double budget = settings.dynamicResolutionTargetMs;
+    float next = renderScale;
+    if (smoothedGpuMs > budget * SCALE_DOWN_AT) {
+        next = quantizeScale(renderScale * (float)std::sqrt(budget * 0.85 / smoothedGpuMs));
+        if (next == renderScale) next = quantizeScale(renderScale - SCALE_STEP);
+    }
+    else if (smoothedGpuMs < budget * SCALE_UP_AT) {
+        next = quantizeScale(renderScale + SCALE_STEP);
+    }
+    if (next != renderScale) {
+        renderScale = next;
+        scaleCooldown = SCALE_COOLDOWN;
+    }
+}
+
+void initPostProcess()
+{
+    downShader = new Shader("post.vert", "bloom_down.frag");
+    upShader = new Shader("post.vert", "bloom_up.frag");
+    compositeShader = new Shader("post.vert", "composite.frag");
+    fxaaShader = new Shader("post.vert", "fxaa.frag");
+    for (Shader* s : { downShader, upShader }) {
+        s->prepareFeatures(0);
+        s->prepareFeatures(SHADER_HQ_FILTER);
+    }
+    glGenVertexArrays(1, &emptyVAO);
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+}
+
+void shutdownPostProcess()
+{
+    destroyTarget(scene);
+    destroyTarget(ldr);
+    destroyMsaa();
+    for (int i = 0; i < BLOOM_MAX_MIPS; ++i) destroyTarget(mips[i]);
+    if (sceneDepth) { glDeleteRenderbuffers(1, &sceneDepth); sceneDepth = 0; }
+    if (emptyVAO) { glDeleteVertexArrays(1, &emptyVAO); emptyVAO = 0; }
+    delete downShader;
+    delete upShader;
+    delete compositeShader;
+    delete fxaaShader;
+    downShader = upShader = compositeShader = fxaaShader = nullptr;
+    built = TargetConfig();
+}
+
+void beginScenePass(int viewportW, int viewportH, const RenderSettings& frameSettings)
+{
+    settings = frameSettings;
+    frameMode = (settings.antiAliasMode >= AA_OFF && settings.antiAliasMode < AA_MODE_COUNT) ? settings.antiAliasMode : AA_OFF;
+    frameSamples = 0;
+    if (frameMode == AA_MSAA) {
+        frameSamples = settings.msaaSamples < maxSamples ? settings.msaaSamples : maxSamples;
+        if (frameSamples < 2) frameMode = AA_OFF; // no multisampling on this GL
+    }
+
+    if (downShader) {
+        readPassTimes();
+        profilerPush(SCENE_PASS, true); // popped by endScenePass
+    }
+    updateRenderScale();
+
+    outputWidth = viewportW;
+    outputHeight = viewportH;
+    sceneW = viewportW;
+    sceneH = viewportH;
+    if (renderScale < 1.0f) {
+        sceneW = glm::max(1, (int)(viewportW * renderScale + 0.5f));
+        sceneH = glm::max(1, (int)(viewportH * renderScale + 0.5f));
+    }
+    stats.renderScale = renderScale;
+    stats.sceneWidth = sceneW;
+    stats.sceneHeight = sceneH;
+
+    sceneActive = (settings.bloomQuality > 0 || frameMode != AA_OFF || sceneW != viewportW || sceneH != viewportH) &&
+                  downShader && viewportW > 0 && viewportH > 0;
+    if (!sceneActive) return;
+
+    TargetConfig want;
+    want.width = sceneW;
+    want.height = sceneH;
+    want.bloomQuality = settings.bloomQuality;
+    want.samples = frameSamples;
+    want.fxaa = frameMode == AA_FXAA;
+    ensureTargets(want);
+    glBindFramebuffer(GL_FRAMEBUFFER, frameSamples ? msaaFBO : scene.fbo);
+    glViewport(0, 0, sceneW, sceneH);
+}
+
+void sceneViewport(int& width, int& height)
+{
+    width = sceneW;
+    height = sceneH;
+}
+
+static void drawFullscreen(const RenderTarget& target)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glViewport(0, 0, target.width, target.height);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+static void runPostPasses()
+{
+    GLboolean blendWasOn = glIsEnabled(GL_BLEND);
+    GLboolean cullWasOn = glIsEnabled(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+
+    // MSAA: resolve the samples into the scene texture first
+    if (frameSamples) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, msaaFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, scene.fbo);
+        glBlitFramebuffer(0, 0, scene.width, scene.height, 0, 0, scene.width, scene.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+
+    glBindVertexArray(emptyVAO);
+    glActiveTexture(GL_TEXTURE0);
+
+    const unsigned filter = settings.bloomQuality >= 2 ? SHADER_HQ_FILTER : 0u;
+    int levels = 0;
+    while (levels < BLOOM_MAX_MIPS && mips[levels].fbo) levels++;
+
+    if (levels > 0) {
+        // threshold + first downsample, then down the chain
+        downShader->setFeatures(filter);
+        downShader->use();
+        downShader->setInt("uSource", 0);
+        const RenderTarget* src = &scene;
+        for (int i = 0; i < levels; ++i) {
+            downShader->setFloat("uThreshold", i == 0 ? settings.bloomThreshold : 0.0f);
+            glUniform2f(glGetUniformLocation(downShader->ID, "uTexel"), 1.0f / src->width, 1.0f / src->height);
+            glBindTexture(GL_TEXTURE_2D, src->color);
+            drawFullscreen(mips[i]);
+            src = &mips[i];
+        }
+
+        // back up: each level adds the blurred level below it
+        upShader->setFeatures(filter);
+        upShader->use();
+        upShader->setInt("uSource", 0);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        for (int i = levels - 2; i >= 0; --i) {
+            glUniform2f(glGetUniformLocation(upShader->ID, "uTexel"), 1.0f / mips[i + 1].width, 1.0f / mips[i + 1].height);
+            glBindTexture(GL_TEXTURE_2D, mips[i + 1].color);
+            drawFullscreen(mips[i]);
+        }
+        glDisable(GL_BLEND);
+    }
+
+    // scene + bloom into the back buffer (FXAA: into the LDR target, FXAA writes the back buffer).
+    // Whichever pass writes the back buffer also does the (bilinear) upscale from the render scale.
+    const bool fxaa = frameMode == AA_FXAA && ldr.fbo;
+    glBindFramebuffer(GL_FRAMEBUFFER, fxaa ? ldr.fbo : 0);
+    if (fxaa) glViewport(0, 0, ldr.width, ldr.height);
+    else glViewport(0, 0, outputWidth, outputHeight);
+    compositeShader->use();
+    compositeShader->setInt("uScene", 0);
+    compositeShader->setInt("uBloom", 1);
+    compositeShader->setFloat("uBloomIntensity", levels > 0 ? settings.bloomIntensity : 0.0f);
+    glBindTexture(GL_TEXTURE_2D, scene.color);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, levels > 0 ? mips[0].color : 0);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    if (fxaa) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, outputWidth, outputHeight);
+        fxaaShader->use();
+        fxaaShader->setInt("uSource", 0);
+        glUniform2f(glGetUniformLocation(fxaaShader->ID, "uTexel"), 1.0f / ldr.width, 1.0f / ldr.height);
+        glBindTexture(GL_TEXTURE_2D, ldr.color);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindVertexArray(0);
+    if (blendWasOn) glEnable(GL_BLEND);
+    if (cullWasOn) glEnable(GL_CULL_FACE);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void endScenePass()
+{
+    if (!downShader) return;
+    profilerPop(); // SCENE_PASS
+
+    PROFILE_GPU_SCOPE(postPassFor(frameMode, frameSamples).name);
+    if (sceneActive) {
+        sceneActive = false;
+        runPostPasses();
+    }
+}
+
+const char* antiAliasModeName(int mode)
+{
+    switch (mode) {
+    case AA_MSAA: return "MSAA";
+    case AA_FXAA: return "FXAA";
+    default:      return "off";
+    }
+}
+
+const PostProcessStats& postProcessStats()
+{
+    return stats;
+}
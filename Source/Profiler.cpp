@@ -0,0 +1,370 @@
+#include <GL/glew.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../Header/Profiler.h"
+#include "../Header/Text.h"
+
+// rolling window of one named pass; samples are per frame (a pass that runs twice in a frame is summed)
+struct PassHistory {
+    const char* name = nullptr;
+    int depth = 0;                   // nesting depth where it was first seen (overlay indent)
+    float cpu[PROFILER_HISTORY] = {};
+    float gpu[PROFILER_HISTORY] = {};
+    int cpuCount = 0, cpuNext = 0;
+    int gpuCount = 0, gpuNext = 0;
+    double cpuFrameMs = 0.0;         // accumulated this frame
+    bool cpuTouched = false;
+    double gpuLatestMs = 0.0;        // newest resolved frame, for profilerGpuMs
+    unsigned gpuResults = 0;
+};
+
+// a pair of GL_TIMESTAMP queries around one scope; startUs is the CPU time the scope opened (where the trace
+// places it)
+struct GpuSample {
+    GLuint begin, end;
+    int pass;
+    double startUs;
+};
+
+// queries issued in one frame
+struct FrameSlot {
+    std::vector<GLuint> pool;        // query objects, grown on demand and reused
+    std::vector<GpuSample> samples;
+    GLuint lastQuery = 0;            // issued last, so the GPU finishes it last
+    bool pending = false;
+    bool traced = false;
+};
+
+struct OpenScope {
+    int pass;
+    double startUs;
+    int sample;                      // index in the frame slot's samples, -1 = CPU only
+};
+
+struct TraceEvent {
+    const char* name;
+    double tsUs;
+    double durUs;
+    int tid;                         // 1 = CPU, 2 = GPU
+};
+
+static bool initialized = false;
+static std::thread::id mainThread;
+static std::chrono::steady_clock::time_point epoch;
+
+static std::vector<PassHistory> passes;
+static std::unordered_map<const char*, int> passByPtr;
+static std::unordered_map<std::string, int> passByName; // same name from another call site = same pass
+static std::vector<OpenScope> openScopes;
+
+static FrameSlot slots[PROFILER_LATENCY];
+static int frameSlot = 0;
+static std::vector<double> gpuFrameMs; // per pass, scratch for resolving a slot
+static std::vector<char> gpuTouched;
+
+static int traceFramesLeft = 0;
+static bool traceWritePending = false;
+static std::vector<TraceEvent> traceEvents;
+
+static const float bucketEdges[PROFILER_BUCKETS - 1] = { 0.1f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f };
+
+static double nowUs()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+static bool onMainThread()
+{
+    return initialized && std::this_thread::get_id() == mainThread;
+}
+
+static int passIndex(const char* name)
+{
+    auto it = passByPtr.find(name);
+    if (it != passByPtr.end()) return it->second;
+
+    int index;
+    auto named = passByName.find(name);
+    if (named != passByName.end()) {
+        index = named->second;
+    } else {
+        index = (int)passes.size();
+        PassHistory p;
+        p.name = name;
+        p.depth = (int)openScopes.size();
+        passes.push_back(p);
+        passByName.emplace(name, index);
+    }
+    passByPtr.emplace(name, index);
+    return index;
+}
+
+static void pushSample(float* ring, int& count, int& next, double ms)
+{
+    ring[next] = (float)ms;
+    next = (next + 1) % PROFILER_HISTORY;
+    if (count < PROFILER_HISTORY) count++;
+}
+
+// Read back a slot's queries, if the GPU has finished that frame (never waits).
+static void resolveSlot(FrameSlot& slot)
+{
+    if (!slot.pending) return;
+    slot.pending = false;
+
+    if (!slot.samples.empty()) {
+        // queries of one frame finish in order, the last one being ready means all are
+        GLint available = 0;
+        glGetQueryObjectiv(slot.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            gpuFrameMs.assign(passes.size(), 0.0);
+            gpuTouched.assign(passes.size(), 0);
+            for (const GpuSample& s : slot.samples) {
+                GLuint64 begin = 0, end = 0;
+                glGetQueryObjectui64v(s.begin, GL_QUERY_RESULT, &begin);
+                glGetQueryObjectui64v(s.end, GL_QUERY_RESULT, &end);
+                const double ms = end > begin ? double(end - begin) * 1e-6 : 0.0;
+                gpuFrameMs[s.pass] += ms;
+                gpuTouched[s.pass] = 1;
+                if (slot.traced) traceEvents.push_back({ passes[s.pass].name, s.startUs, ms * 1000.0, 2 });
+            }
+            for (size_t i = 0; i < passes.size(); ++i) {
+                if (!gpuTouched[i]) continue;
+                PassHistory& p = passes[i];
+                pushSample(p.gpu, p.gpuCount, p.gpuNext, gpuFrameMs[i]);
+                p.gpuLatestMs = gpuFrameMs[i];
+                p.gpuResults++;
+            }
+        }
+    }
+    slot.samples.clear();
+    slot.traced = false;
+}
+
+static void writeTrace()
+{
+    char fileName[64];
+    std::time_t t = std::time(nullptr);
+    std::strftime(fileName, sizeof(fileName), "trace_%Y%m%d_%H%M%S.json", std::localtime(&t));
+
+    FILE* f = std::fopen(fileName, "w");
+    if (!f) {
+        std::cout << "Profiler: cannot write " << fileName << std::endl;
+        traceEvents.clear();
+        return;
+    }
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main thread (CPU)\"}},\n");
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU (at CPU issue time)\"}}");
+    for (const TraceEvent& e : traceEvents) {
+        std::string name;
+        for (const char* c = e.name; *c; ++c) {
+            if (*c == '"' || *c == '\\') name += '\\';
+            name += *c;
+        }
+        std::fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                     name.c_str(), e.tid == 1 ? "cpu" : "gpu", e.tsUs, e.durUs, e.tid);
+    }
+    std::fprintf(f, "\n]}\n");
+    std::fclose(f);
+    std::cout << "Profiler: trace written to " << fileName << " (" << traceEvents.size() << " events)" << std::endl;
+    traceEvents.clear();
+}
+
+void initProfiler()
+{
+    mainThread = std::this_thread::get_id();
+    epoch = std::chrono::steady_clock::now();
+    initialized = true;
+}
+
+void shutdownProfiler()
+{
+    for (FrameSlot& slot : slots) {
+        if (!slot.pool.empty()) glDeleteQueries((GLsizei)slot.pool.size(), slot.pool.data());
+        slot = FrameSlot();
+    }
+    passes.clear();
+    passByPtr.clear();
+    passByName.clear();
+    openScopes.clear();
+    traceEvents.clear();
+    traceFramesLeft = 0;
+    traceWritePending = false;
+    initialized = false;
+}
+
+void profilerBeginFrame()
+{
+    if (!onMainThread()) return;
+    frameSlot = (frameSlot + 1) % PROFILER_LATENCY;
+    resolveSlot(slots[frameSlot]);
+    slots[frameSlot].traced = traceFramesLeft > 0;
+
+    if (traceWritePending) {
+        bool waiting = false;
+        for (const FrameSlot& slot : slots) waiting = waiting || (slot.pending && slot.traced);
+        if (!waiting) {
+            writeTrace();
+            traceWritePending = false;
+        }
+    }
+    profilerPush("frame", false);
+}
+
+void profilerEndFrame()
+{
+    if (!onMainThread()) return;
+    while (!openScopes.empty()) profilerPop(); // "frame" (and anything left open by mistake)
+
+    for (PassHistory& p : passes) {
+        if (!p.cpuTouched) continue;
+        pushSample(p.cpu, p.cpuCount, p.cpuNext, p.cpuFrameMs);
+        p.cpuFrameMs = 0.0;
+        p.cpuTouched = false;
+    }
+    slots[frameSlot].pending = true;
+
+    if (traceFramesLeft > 0 && --traceFramesLeft == 0) traceWritePending = true;
+}
+
+void profilerPush(const char* name, bool gpu)
+{
+    if (!onMainThread()) return;
+    OpenScope scope{ passIndex(name), nowUs(), -1 };
+    if (gpu) {
+        FrameSlot& slot = slots[frameSlot];
+        const size_t i = slot.samples.size() * 2;
+        if (i == slot.pool.size()) {
+            GLuint q[2] = {};
+            glGenQueries(2, q);
+            slot.pool.insert(slot.pool.end(), q, q + 2);
+        }
+        scope.sample = (int)slot.samples.size();
+        slot.samples.push_back({ slot.pool[i], slot.pool[i + 1], scope.pass, scope.startUs });
+        glQueryCounter(slot.pool[i], GL_TIMESTAMP);
+    }
+    openScopes.push_back(scope);
+}
+
+void profilerPop()
+{
+    if (!onMainThread() || openScopes.empty()) return;
+    const OpenScope scope = openScopes.back();
+    openScopes.pop_back();
+    if (scope.sample >= 0) {
+        FrameSlot& slot = slots[frameSlot];
+        slot.lastQuery = slot.samples[scope.sample].end;
+        glQueryCounter(slot.lastQuery, GL_TIMESTAMP);
+    }
+
+    const double endUs = nowUs();
+    PassHistory& p = passes[scope.pass];
+    p.cpuFrameMs += (endUs - scope.startUs) * 1e-3;
+    p.cpuTouched = true;
+    if (traceFramesLeft > 0) traceEvents.push_back({ p.name, scope.startUs, endUs - scope.startUs, 1 });
+}
+
+struct WindowStats {
+    float avg = 0.0f, p95 = 0.0f, max = 0.0f;
+};
+
+static WindowStats windowStats(const float* ring, int count)
+{
+    WindowStats s;
+    if (count == 0) return s;
+    float sorted[PROFILER_HISTORY];
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        sorted[i] = ring[i];
+        sum += ring[i];
+        s.max = std::max(s.max, ring[i]);
+    }
+    const int k = (int)(0.95f * (count - 1));
+    std::nth_element(sorted, sorted + k, sorted + count);
+    s.avg = sum / count;
+    s.p95 = sorted[k];
+    return s;
+}
+
+// one character per bucket, darker = more frames in that bucket
+static void histogramText(const float* ring, int count, char* out)
+{
+    int buckets[PROFILER_BUCKETS] = {};
+    for (int i = 0; i < count; ++i) {
+        int b = 0;
+        while (b < PROFILER_BUCKETS - 1 && ring[i] >= bucketEdges[b]) b++;
+        buckets[b]++;
+    }
+    int most = 1;
+    for (int b = 0; b < PROFILER_BUCKETS; ++b) most = std::max(most, buckets[b]);
+    static const char levels[] = " .:-=+*#";
+    for (int b = 0; b < PROFILER_BUCKETS; ++b)
+        out[b] = levels[buckets[b] == 0 ? 0 : 1 + buckets[b] * 6 / most];
+    out[PROFILER_BUCKETS] = '\0';
+}
+
+void drawProfilerOverlay(float xPx, float bottomPx)
+{
+    const int lines = (int)passes.size() + 1;
+    float y = bottomPx - HUD_LINE_HEIGHT * lines;
+
+    char buf[192];
+    std::snprintf(buf, sizeof(buf), "%-16s %-20s %-20s %s", "pass", "cpu avg/p95/max", "gpu avg/p95/max", "0.1..8ms");
+    drawText(buf, xPx, y, 1.0f, 0.85f, 0.4f, HUD_TEXT_SCALE);
+
+    for (const PassHistory& p : passes) {
+        y += HUD_LINE_HEIGHT;
+        const WindowStats cpu = windowStats(p.cpu, p.cpuCount);
+        char label[32];
+        std::snprintf(label, sizeof(label), "%*s%s", p.depth * 2, "", p.name);
+        int len = std::snprintf(buf, sizeof(buf), "%-16s %5.2f/%5.2f/%5.2f    ", label, cpu.avg, cpu.p95, cpu.max);
+
+        char histogram[PROFILER_BUCKETS + 1];
+        if (p.gpuCount > 0) {
+            const WindowStats gpu = windowStats(p.gpu, p.gpuCount);
+            len += std::snprintf(buf + len, sizeof(buf) - len, "%5.2f/%5.2f/%5.2f    ", gpu.avg, gpu.p95, gpu.max);
+            histogramText(p.gpu, p.gpuCount, histogram);
+        } else {
+            len += std::snprintf(buf + len, sizeof(buf) - len, "%-20s ", "-");
+            histogramText(p.cpu, p.cpuCount, histogram);
+        }
+        std::snprintf(buf + len, sizeof(buf) - len, "[%s]", histogram);
+        drawText(buf, xPx, y, 1.0f, 1.0f, 1.0f, HUD_TEXT_SCALE);
+    }
+}
+
+void requestProfilerTrace()
+{
+    if (!initialized || traceFramesLeft > 0 || traceWritePending) return;
+    traceEvents.clear();
+    traceEvents.reserve(PROFILER_TRACE_FRAMES * 32);
+    traceFramesLeft = PROFILER_TRACE_FRAMES;
+    std::cout << "Profiler: recording " << PROFILER_TRACE_FRAMES << " frames" << std::endl;
+}
+
+bool profilerTraceActive()
+{
+    return traceFramesLeft > 0 || traceWritePending;
+}
+
+double profilerGpuMs(const char* name, unsigned* results)
+{
+    auto it = passByPtr.find(name);
+    const PassHistory* p = nullptr;
+    if (it != passByPtr.end()) p = &passes[it->second];
+    else {
+        auto named = passByName.find(name);
+        if (named != passByName.end()) p = &passes[named->second];
+    }
+    if (results) *results = p ? p->gpuResults : 0;
+    return p ? p->gpuLatestMs : 0.0;
+}
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "../Header/RouteTrack.h"
+
+RouteTrack::RouteTrack(const std::vector<glm::vec3>& input)
+{
+    points.reserve(input.size());
+    for (const glm::vec3& p : input)
+        if (points.empty() || glm::length(p - points.back()) > 1e-6f) points.push_back(p);
+    if (points.size() < 2) {
+        points.clear();
+        return;
+    }
+
+    const size_t segments = points.size() - 1;
+    cumulative.resize(points.size());
+    cumulative[0] = 0.0f;
+    float shortest = FLT_MAX;
+    for (size_t i = 0; i < segments; ++i) {
+        const float len = glm::length(points[i + 1] - points[i]);
+        cumulative[i + 1] = cumulative[i] + len;
+        shortest = std::min(shortest, len);
+    }
+    total = cumulative.back();
+
+    // enough buckets that a bucket spans about one of the short segments, within the cap
+    const size_t wanted = (size_t)std::min((double)total / shortest, (double)segments * ROUTE_TRACK_MAX_BUCKETS_PER_SEGMENT);
+    const size_t count = std::max(segments, wanted);
+    bucketLength = total / (float)count;
+    buckets.resize(count);
+    size_t seg = 0;
+    for (size_t k = 0; k < count; ++k) {
+        const float start = bucketLength * (float)k;
+        while (seg + 1 < segments && cumulative[seg + 1] <= start) ++seg;
+        buckets[k] = (uint32_t)seg;
+    }
+}
+
+glm::vec3 RouteTrack::positionAt(float s, glm::vec3* direction) const
+{
+    if (points.empty()) {
+        if (direction) *direction = glm::vec3(0.0f, 0.0f, 1.0f);
+        return glm::vec3(0.0f);
+    }
+    s = glm::clamp(s, 0.0f, total);
+    const size_t segments = points.size() - 1;
+    size_t i = buckets[std::min((size_t)(s / bucketLength), buckets.size() - 1)];
+    while (i + 1 < segments && cumulative[i + 1] < s) ++i;
+
+    const float len = cumulative[i + 1] - cumulative[i];
+    const float t = glm::clamp((s - cumulative[i]) / len, 0.0f, 1.0f);
+    if (direction) *direction = (points[i + 1] - points[i]) / len;
+    return glm::mix(points[i], points[i + 1], t);
+}
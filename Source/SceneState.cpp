@@ -0,0 +1,21 @@
+#include <GLFW/glfw3.h>
+#include <cmath>
+
+#include "../Header/SceneState.h"
+
+SceneState& sceneOf(GLFWwindow* window)
+{
+    return *static_cast<SceneState*>(glfwGetWindowUserPointer(window));
+}
+
+void resetCameraFront(ViewState& view)
+{
+    float yawRad = glm::radians(view.cameraYaw);
+    float pitchRad = glm::radians(view.cameraPitch);
+
+    glm::vec3 front;
+    front.x = cos(yawRad) * cos(pitchRad);
+    front.y = sin(pitchRad);
+    front.z = sin(yawRad) * cos(pitchRad);
+    view.cameraFront = glm::normalize(front);
+}
@@ -0,0 +1,365 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include "../Header/Session.h"
+#include "../Header/ThreadPool.h"
+
+static uint32_t sectionTag(const char (&name)[5])
+{
+    return (uint32_t)name[0] | ((uint32_t)name[1] << 8) | ((uint32_t)name[2] << 16) | ((uint32_t)name[3] << 24);
+}
+
+static const uint32_t TAG_VIEW = sectionTag("VIEW");
+static const uint32_t TAG_AVATAR = sectionTag("AVTR");
+static const uint32_t TAG_SAVED = sectionTag("SAVD");
+static const uint32_t TAG_RENDER = sectionTag("REND");
+static const uint32_t TAG_LIGHT = sectionTag("LITE");
+static const uint32_t TAG_MODEL = sectionTag("MODL");
+static const uint32_t TAG_AUTOPILOT = sectionTag("AUTO");
+static const uint32_t TAG_MEASUREMENT = sectionTag("MEAS");
+
+static const size_t HEADER_SIZE = 16;
+
+// writer (one write in flight, the newest pending state replaces an older one)
+static std::mutex writeMutex;
+static std::condition_variable writeCv;
+static std::vector<uint8_t> pendingWrite;
+static bool writePending = false;
+static bool writerBusy = false;
+
+// main thread
+static std::vector<uint8_t> lastSaved;
+static double lastCheck = -1e9;
+
+static SessionStats stats;  // guarded by writeMutex
+
+static uint32_t fnv1a(const uint8_t* data, size_t size)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void putBytes(std::vector<uint8_t>& out, const void* data, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    out.insert(out.end(), p, p + size);
+}
+
+template <typename T>
+static void putValue(std::vector<uint8_t>& out, const T& value)
+{
+    putBytes(out, &value, sizeof(T));
+}
+
+// Field by field, fixed sizes (int32, float, bool as one byte, vec3 as three floats): no padding bytes
+// in the file, and the layout does not depend on the compiler.
+struct FieldWriter {
+    std::vector<uint8_t>& out;
+    void operator()(float v) { putValue(out, v); }
+    void operator()(int v) { putValue(out, (int32_t)v); }
+    void operator()(bool v) { putValue(out, (uint8_t)(v ? 1 : 0)); }
+    void operator()(const glm::vec3& v) { putValue(out, v.x); putValue(out, v.y); putValue(out, v.z); }
+};
+
+struct FieldReader {
+    const uint8_t* data;
+    uint32_t size;
+    uint32_t pos = 0;
+    bool ok = true;
+
+    template <typename T>
+    void take(T& v)
+    {
+        if (size - pos < sizeof(T)) { ok = false; return; }
+        std::memcpy(&v, data + pos, sizeof(T));
+        pos += sizeof(T);
+    }
+    void operator()(float& v) { take(v); }
+    void operator()(int& v) { int32_t x = 0; take(x); v = x; }
+    void operator()(bool& v) { uint8_t x = 0; take(x); v = x != 0; }
+    void operator()(glm::vec3& v) { take(v.x); take(v.y); take(v.z); }
+};
+
+// The stored fields of each section, in file order; the same list reads and writes.
+template <typename F>
+static void sectionFields(F& f, ViewState& v)
+{
+    f(v.cameraPos); f(v.cameraFront); f(v.cameraUp);
+    f(v.cameraYaw); f(v.cameraPitch); f(v.cameraYWalking);
+    f(v.overviewMode); f(v.pinShowsStanding); f(v.cameraOnPath);
+    f(v.mapOffsetX); f(v.mapOffsetY); f(v.mapTexScale);
+}
+
+template <typename F>
+static void sectionFields(F& f, AvatarState& a)
+{
+    f(a.pos); f(a.yawDeg); f(a.meters);
+    f(a.spriteState); f(a.spriteFrame); f(a.spriteTimer);
+    f(a.autopilot); f(a.autopilotProgress);
+}
+
+template <typename F>
+static void sectionFields(F& f, SavedViewState& s)
+{
+    f(s.cameraPos); f(s.cameraFront); f(s.cameraYaw); f(s.cameraPitch);
+    f(s.mapOffsetX); f(s.mapOffsetY); f(s.mapTexScale);
+}
+
+// only the user-facing choices; the debug state (F1..F4 depth / cull, F5 stats, F10 profiler, F12 latency
+// mode) starts from the defaults every run
+template <typename F>
+static void sectionFields(F& f, RenderSettings& r)
+{
+    f(r.crowdEnabled); f(r.crowdAgentCount); f(r.crowdMaxDistance);
+    f(r.shadowsEnabled); f(r.shadowMapSize); f(r.shadowPcfRadius);
+    f(r.bloomQuality); f(r.bloomThreshold); f(r.bloomIntensity);
+    f(r.antiAliasMode); f(r.msaaSamples);
+    f(r.dynamicResolution); f(r.dynamicResolutionTargetMs); f(r.renderScaleMin); f(r.renderScaleMax);
+    f(r.showMinimap);
+}
+
+template <typename F>
+static void sectionFields(F& f, SceneLightState& l)
+{
+    f(l.pos); f(l.color); f(l.intensity); f(l.radius); f(l.directional); f(l.dir);
+}
+
+template <typename F>
+static void sectionFields(F& f, ModelRequest& m)
+{
+    f(m.desiredHeight); f(m.loadHeight); f(m.reloadRequested);
+}
+
+template <typename F>
+static void sectionFields(F& f, AutopilotRequest& a)
+{
+    f(a.speed); f(a.toggleRequested);
+}
+
+template <typename T>
+static void putSection(std::vector<uint8_t>& out, uint32_t tag, T value)
+{
+    putValue(out, tag);
+    const size_t sizeAt = out.size();
+    putValue(out, (uint32_t)0);
+    FieldWriter writer{ out };
+    sectionFields(writer, value);
+    const uint32_t size = (uint32_t)(out.size() - sizeAt - 4);
+    std::memcpy(&out[sizeAt], &size, 4);
+}
+
+std::vector<uint8_t> encodeSession(const SceneState& scene)
+{
+    // the walking view: in overview it is the saved one, transient flags are not kept
+    ViewState view = scene.view;
+    if (view.overviewMode) {
+        view.cameraPos = scene.saved.cameraPos;
+        view.cameraFront = scene.saved.cameraFront;
+        view.cameraYaw = scene.saved.cameraYaw;
+        view.cameraPitch = scene.saved.cameraPitch;
+        view.mapOffsetX = scene.saved.mapOffsetX;
+        view.mapOffsetY = scene.saved.mapOffsetY;
+        view.mapTexScale = scene.saved.mapTexScale;
+    }
+    view.overviewMode = false;
+    view.pinShowsStanding = false;
+    view.cameraOnPath = false;
+
+    AvatarState avatar = scene.avatar;
+    avatar.autopilot = false;
+    avatar.autopilotProgress = 0.0f;
+    ModelRequest model = scene.model;
+    model.reloadRequested = false;
+    AutopilotRequest autopilot = scene.autopilot;
+    autopilot.toggleRequested = false;
+
+    std::vector<uint8_t> out(HEADER_SIZE, 0);
+    out.reserve(512 + scene.measurement.points.size() * 8);
+    putSection(out, TAG_VIEW, view);
+    putSection(out, TAG_AVATAR, avatar);
+    putSection(out, TAG_SAVED, scene.saved);
+    putSection(out, TAG_RENDER, scene.render);
+    putSection(out, TAG_LIGHT, scene.light);
+    putSection(out, TAG_MODEL, model);
+    putSection(out, TAG_AUTOPILOT, autopilot);
+
+    const uint32_t count = (uint32_t)scene.measurement.points.size();
+    putValue(out, TAG_MEASUREMENT);
+    putValue(out, (uint32_t)(8 + count * 8));
+    putValue(out, scene.measurement.distancePixels);
+    putValue(out, count);
+    for (const auto& p : scene.measurement.points) {
+        putValue(out, p.first);
+        putValue(out, p.second);
+    }
+
+    const uint32_t version = SESSION_VERSION, payload = (uint32_t)(out.size() - HEADER_SIZE);
+    const uint32_t checksum = fnv1a(out.data() + HEADER_SIZE, payload);
+    std::memcpy(&out[0], "KSES", 4);
+    std::memcpy(&out[4], &version, 4);
+    std::memcpy(&out[8], &payload, 4);
+    std::memcpy(&out[12], &checksum, 4);
+    return out;
+}
+
+// A section that does not hold exactly the current fields is from another layout and is skipped.
+template <typename T>
+static void takeSection(const uint8_t* data, uint32_t size, T& value)
+{
+    T read = value;
+    FieldReader reader{ data, size };
+    sectionFields(reader, read);
+    if (reader.ok && reader.pos == size) value = read;
+}
+
+bool decodeSession(const uint8_t* data, size_t size, SceneState& scene)
+{
+    uint32_t version = 0, payload = 0, checksum = 0;
+    if (size < HEADER_SIZE || std::memcmp(data, "KSES", 4) != 0) return false;
+    std::memcpy(&version, data + 4, 4);
+    std::memcpy(&payload, data + 8, 4);
+    std::memcpy(&checksum, data + 12, 4);
+    if (version != SESSION_VERSION || payload != size - HEADER_SIZE || fnv1a(data + HEADER_SIZE, payload) != checksum) return false;
+
+    // decode into a copy: a bad section leaves the scene as it was
+    SceneState restored = scene;
+    size_t pos = HEADER_SIZE;
+    while (pos + 8 <= size) {
+        uint32_t tag = 0, length = 0;
+        std::memcpy(&tag, data + pos, 4);
+        std::memcpy(&length, data + pos + 4, 4);
+        pos += 8;
+        if (length > size - pos) return false;
+        const uint8_t* body = data + pos;
+        pos += length;
+
+        if (tag == TAG_VIEW) takeSection(body, length, restored.view);
+        else if (tag == TAG_AVATAR) takeSection(body, length, restored.avatar);
+        else if (tag == TAG_SAVED) takeSection(body, length, restored.saved);
+        else if (tag == TAG_RENDER) takeSection(body, length, restored.render);
+        else if (tag == TAG_LIGHT) takeSection(body, length, restored.light);
+        else if (tag == TAG_MODEL) takeSection(body, length, restored.model);
+        else if (tag == TAG_AUTOPILOT) takeSection(body, length, restored.autopilot);
+        else if (tag == TAG_MEASUREMENT && length >= 8) {
+            uint32_t count = 0;
+            std::memcpy(&restored.measurement.distancePixels, body, 4);
+            std::memcpy(&count, body + 4, 4);
+            if (length != 8 + (size_t)count * 8) return false;
+            restored.measurement.points.resize(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                std::memcpy(&restored.measurement.points[i].first, body + 8 + i * 8, 4);
+                std::memcpy(&restored.measurement.points[i].second, body + 12 + i * 8, 4);
+            }
+            restored.measurement.walkRoute.clear(); // searched again
+            restored.measurement.walkRouteLength = 0.0f;
+        }
+    }
+    scene = std::move(restored);
+    return true;
+}
+
+bool writeSessionFile(const char* path, const std::vector<uint8_t>& bytes)
+{
+    const std::string temp = std::string(path) + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+        if (!file) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool restoreSession(SceneState& scene, const char* path)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    const std::streamsize size = file.tellg();
+    std::vector<uint8_t> bytes(size > 0 ? (size_t)size : 0);
+    file.seekg(0);
+    if (bytes.empty() || !file.read((char*)bytes.data(), size) || !decodeSession(bytes.data(), bytes.size(), scene)) {
+        std::cout << "Session: " << path << " is unreadable, starting fresh" << std::endl;
+        return false;
+    }
+    lastSaved = bytes;
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    stats.restoreMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    stats.bytes = bytes.size();
+    return true;
+}
+
+static void writerLoop()
+{
+    std::unique_lock<std::mutex> lock(writeMutex);
+    while (writePending) {
+        std::vector<uint8_t> bytes;
+        bytes.swap(pendingWrite);
+        writePending = false;
+        lock.unlock();
+
+        const bool ok = writeSessionFile(SESSION_PATH, bytes);
+        if (!ok) std::cout << "Session: cannot write " << SESSION_PATH << std::endl;
+
+        lock.lock();
+        if (ok) {
+            stats.saves++;
+            stats.bytes = bytes.size();
+        }
+    }
+    writerBusy = false;
+    writeCv.notify_all();
+}
+
+static void queueWrite(std::vector<uint8_t> bytes)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    pendingWrite = std::move(bytes);
+    writePending = true;
+    if (writerBusy) return; // the running writer picks it up
+    writerBusy = true;
+    workerPool().submit(writerLoop);
+}
+
+void autosaveSession(const SceneState& scene, double now)
+{
+    if (now - lastCheck < SESSION_SAVE_INTERVAL) return;
+    lastCheck = now;
+    std::vector<uint8_t> bytes = encodeSession(scene);
+    if (bytes == lastSaved) return;
+    lastSaved = bytes;
+    queueWrite(std::move(bytes));
+}
+
+void flushSession(const SceneState& scene)
+{
+    std::vector<uint8_t> bytes = encodeSession(scene);
+    if (bytes != lastSaved) {
+        lastSaved = bytes;
+        queueWrite(std::move(bytes));
+    }
+    std::unique_lock<std::mutex> lock(writeMutex);
+    writeCv.wait(lock, [] { return !writerBusy; });
+}
+
+SessionStats sessionStats()
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return stats;
+}
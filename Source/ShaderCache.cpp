@@ -0,0 +1,325 @@
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "../Header/ShaderCache.h"
+#include "../Header/ThreadPool.h"
+
+const char* SHADER_CACHE_DIR = "Resources/cache/shaders";
+
+static const uint32_t PROGRAM_BINARY_MAGIC = 0x4752504B; // "KPRG"
+static const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+struct CachedProgram {
+    unsigned program = 0;
+    int refs = 0;
+};
+
+static std::unordered_map<uint64_t, CachedProgram> programsByKey;
+static std::unordered_map<unsigned, uint64_t> keyByProgram;
+static ShaderCacheStats stats;
+
+// prefetched sources by normalized path (readShaderSource can run on the hot reload thread too)
+static std::mutex prefetchMutex;
+static std::unordered_map<std::string, std::shared_future<std::string>> prefetched;
+
+static uint64_t fnv1a64(const void* data, size_t n, uint64_t h = 1469598103934665603ULL) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ULL; }
+    return h;
+}
+
+// binaries are only valid for the driver that produced them
+static uint64_t driverHash() {
+    static uint64_t hash = 0;
+    if (hash == 0) {
+        const char* strings[] = { (const char*)glGetString(GL_VENDOR), (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION) };
+        hash = 1469598103934665603ULL;
+        for (const char* s : strings)
+            if (s) hash = fnv1a64(s, std::strlen(s) + 1, hash);
+    }
+    return hash;
+}
+
+static bool binariesSupported() {
+    if (!(GLEW_ARB_get_program_binary || GLEW_VERSION_4_1)) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+static std::string binaryPathFor(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return std::string(SHADER_CACHE_DIR) + "/" + name;
+}
+
+static std::string prefetchKey(const std::filesystem::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+static std::string readShaderSourceFile(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Greska pri citanju fajla sa putanje \"" << path << "\"!" << std::endl;
+        return std::string();
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    std::string temp = ss.str();
+
+    // Strip UTF-8 BOM if present (0xEF,0xBB,0xBF)
+    if (temp.size() >= 3 &&
+        static_cast<unsigned char>(temp[0]) == 0xEF &&
+        static_cast<unsigned char>(temp[1]) == 0xBB &&
+        static_cast<unsigned char>(temp[2]) == 0xBF) {
+        temp.erase(0, 3);
+    }
+
+    // Ensure #version is the first meaningful token (some drivers reject anything before it).
+    size_t pos = temp.find("#version");
+    if (pos != std::string::npos) {
+        size_t lineStart = temp.rfind('\n', pos);
+        if (lineStart != std::string::npos) temp.erase(0, lineStart + 1);
+    } else {
+        std::cout << "Warning: shader file \"" << path << "\" does not contain a #version directive." << std::endl;
+    }
+
+    while (!temp.empty() && (temp.front() == '\r' || temp.front() == '\n')) {
+        temp.erase(temp.begin());
+    }
+    return temp;
+}
+
+std::string readShaderSource(const char* path)
+{
+    std::shared_future<std::string> source;
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex);
+        auto it = prefetched.empty() ? prefetched.end() : prefetched.find(prefetchKey(path));
+        if (it != prefetched.end()) source = it->second;
+    }
+    if (source.valid() && source.wait_for(std::chrono::seconds(0)) == std::future_status::ready) return source.get();
+    return readShaderSourceFile(path);
+}
+
+void prefetchShaderSources(const char* directory)
+{
+    // one job reads them all (a few KB each), each file completes its own future
+    auto reads = std::make_shared<std::vector<std::pair<std::string, std::promise<std::string>>>>();
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        const std::filesystem::path ext = entry.path().extension();
+        if (ext != ".vert" && ext != ".frag") continue;
+        reads->emplace_back(entry.path().string(), std::promise<std::string>());
+        std::lock_guard<std::mutex> lock(prefetchMutex);
+        prefetched[prefetchKey(entry.path())] = reads->back().second.get_future().share();
+    }
+    workerPool().submit([reads] {
+        for (auto& read : *reads) read.second.set_value(readShaderSourceFile(read.first.c_str()));
+    });
+}
+
+void endShaderSourcePrefetch()
+{
+    std::lock_guard<std::mutex> lock(prefetchMutex);
+    prefetched.clear();
+}
+
+std::string insertShaderDefines(const std::string& code, const std::string& defines)
+{
+    if (defines.empty() || code.empty()) return code;
+    size_t eol = code.find('\n');
+    if (code.compare(0, 8, "#version") != 0 || eol == std::string::npos) return defines + "#line 1\n" + code;
+    return code.substr(0, eol + 1) + defines + "#line 2\n" + code.substr(eol + 1);
+}
+
+static unsigned compileStage(GLenum type, const std::string& code, const std::string& label)
+{
+    const char* src = code.c_str();
+    unsigned shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, NULL);
+    glCompileShader(shader);
+
+    int success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (success == GL_FALSE) {
+        char infoLog[1024];
+        glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+        std::cout << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT") << " sejder (" << label << ") ima gresku! Greska: \n" << infoLog << std::endl;
+    }
+    return shader;
+}
+
+static bool linked(unsigned program)
+{
+    int success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+// Restore a program from its binary. Any mismatch (header, driver, format rejected by glProgramBinary) -> 0.
+static unsigned loadProgramBinary(uint64_t key)
+{
+    std::ifstream file(binaryPathFor(key), std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    uint32_t magic = 0, version = 0, format = 0, length = 0;
+    uint64_t driver = 0;
+    file.read((char*)&magic, 4);
+    file.read((char*)&version, 4);
+    file.read((char*)&driver, 8);
+    file.read((char*)&format, 4);
+    file.read((char*)&length, 4);
+    if (!file || magic != PROGRAM_BINARY_MAGIC || version != PROGRAM_BINARY_VERSION || driver != driverHash() || length == 0) {
+        stats.binaryRejected++;
+        return 0;
+    }
+    std::vector<char> blob(length);
+    file.read(blob.data(), length);
+    if (!file) {
+        stats.binaryRejected++;
+        return 0;
+    }
+
+    unsigned program = glCreateProgram();
+    glProgramBinary(program, (GLenum)format, blob.data(), (GLsizei)length);
+    if (!linked(program)) {
+        // driver update or different GPU: fall back to source
+        glDeleteProgram(program);
+        stats.binaryRejected++;
+        return 0;
+    }
+    return program;
+}
+
+static void saveProgramBinary(uint64_t key, unsigned program)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> blob((size_t)length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, blob.data());
+    if (written <= 0) return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(SHADER_CACHE_DIR, ec);
+    std::ofstream file(binaryPathFor(key), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "Shader cache: cannot write " << binaryPathFor(key) << std::endl;
+        return;
+    }
+    uint32_t magic = PROGRAM_BINARY_MAGIC, version = PROGRAM_BINARY_VERSION, fmt = format, len = (uint32_t)written;
+    uint64_t driver = driverHash();
+    file.write((const char*)&magic, 4);
+    file.write((const char*)&version, 4);
+    file.write((const char*)&driver, 8);
+    file.write((const char*)&fmt, 4);
+    file.write((const char*)&len, 4);
+    file.write(blob.data(), written);
+}
+
+static unsigned buildProgram(const std::string& vertexCode, const std::string& fragmentCode, const std::string& label, bool retrievable)
+{
+    unsigned program = glCreateProgram();
+    unsigned vs = compileStage(GL_VERTEX_SHADER, vertexCode, label);
+    unsigned fs = compileStage(GL_FRAGMENT_SHADER, fragmentCode, label);
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    if (retrievable) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+
+    if (!linked(program)) {
+        char infoLog[1024];
+        glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+        std::cout << "Objedinjeni sejder (" << label << ") ima gresku! Greska: \n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        program = 0;
+    } else {
+        glDetachShader(program, vs);
+        glDetachShader(program, fs);
+    }
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    return program;
+}
+
+unsigned acquireProgramFromSource(const std::string& vertexCode, const std::string& fragmentCode, const std::string& label)
+{
+    auto start = std::chrono::steady_clock::now();
+    stats.requests++;
+
+    uint64_t key = fnv1a64(vertexCode.data(), vertexCode.size());
+    key = fnv1a64("\0", 1, key);
+    key = fnv1a64(fragmentCode.data(), fragmentCode.size(), key);
+
+    auto it = programsByKey.find(key);
+    if (it != programsByKey.end()) {
+        it->second.refs++;
+        stats.shared++;
+        return it->second.program;
+    }
+
+    const bool binaries = binariesSupported();
+    unsigned program = binaries ? loadProgramBinary(key) : 0;
+    if (program) {
+        stats.fromBinary++;
+    } else {
+        program = buildProgram(vertexCode, fragmentCode, label, binaries);
+        if (!program) return 0;
+        stats.compiled++;
+        if (binaries) saveProgramBinary(key, program);
+    }
+
+    programsByKey[key] = { program, 1 };
+    keyByProgram[program] = key;
+    stats.totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return program;
+}
+
+unsigned acquireProgram(const char* vertexPath, const char* fragmentPath)
+{
+    std::string vertexCode = readShaderSource(vertexPath);
+    std::string fragmentCode = readShaderSource(fragmentPath);
+    if (vertexCode.empty() || fragmentCode.empty()) return 0;
+    return acquireProgramFromSource(vertexCode, fragmentCode, std::string(vertexPath) + " + " + fragmentPath);
+}
+
+void releaseProgram(unsigned program)
+{
+    auto k = keyByProgram.find(program);
+    if (k == keyByProgram.end()) return;
+    auto it = programsByKey.find(k->second);
+    if (it != programsByKey.end() && --it->second.refs > 0) return;
+
+    glDeleteProgram(program);
+    if (it != programsByKey.end()) programsByKey.erase(it);
+    keyByProgram.erase(k);
+}
+
+const ShaderCacheStats& shaderCacheStats()
+{
+    return stats;
+}
+
+void shutdownShaderCache()
+{
+    for (auto& kv : programsByKey) glDeleteProgram(kv.second.program);
+    programsByKey.clear();
+    keyByProgram.clear();
+}
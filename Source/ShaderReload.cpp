@@ -0,0 +1,187 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../Header/ShaderReload.h"
+#include "../Header/ShaderCache.h"
+
+struct WatchedProgram {
+    unsigned* slot = nullptr;
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::function<void(unsigned)> onReload;
+    std::string defines;
+};
+
+// preprocessed on the watcher thread, compiled on the main thread
+struct PendingReload {
+    unsigned* slot = nullptr;
+    std::string vertexCode;
+    std::string fragmentCode;
+    std::string label;
+};
+
+struct WatchedFile {
+    std::filesystem::file_time_type known;
+    bool changed = false;
+};
+
+static std::vector<WatchedProgram> programs;
+static std::vector<PendingReload> pending;
+static std::atomic<bool> hasPending{ false };
+static std::mutex mutex;
+static std::condition_variable cv;
+static std::thread watcher;
+static bool quit = false;
+
+static void queueReload(PendingReload&& reload)
+{
+    for (PendingReload& p : pending) {
+        if (p.slot == reload.slot) { p = std::move(reload); return; }
+    }
+    pending.push_back(std::move(reload));
+}
+
+static void watchLoop(int pollMs)
+{
+    // only this thread touches the timestamps
+    std::unordered_map<std::string, WatchedFile> files;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!quit) {
+        std::vector<WatchedProgram> snapshot = programs;
+        lock.unlock();
+
+        // a file counts as changed once its mtime moved and then held still for one poll
+        std::unordered_set<std::string> settled;
+        for (const WatchedProgram& w : snapshot) {
+            for (const std::string* path : { &w.vertexPath, &w.fragmentPath }) {
+                std::error_code ec;
+                auto t = std::filesystem::last_write_time(*path, ec);
+                if (ec) continue;
+
+                auto it = files.find(*path);
+                if (it == files.end()) { files[*path].known = t; continue; }
+                WatchedFile& f = it->second;
+                if (t != f.known) { f.known = t; f.changed = true; }
+                else if (f.changed) { f.changed = false; settled.insert(*path); }
+            }
+        }
+
+        std::vector<PendingReload> ready;
+        for (const WatchedProgram& w : snapshot) {
+            if (!settled.count(w.vertexPath) && !settled.count(w.fragmentPath)) continue;
+            PendingReload r;
+            r.slot = w.slot;
+            r.vertexCode = insertShaderDefines(readShaderSource(w.vertexPath.c_str()), w.defines);
+            r.fragmentCode = insertShaderDefines(readShaderSource(w.fragmentPath.c_str()), w.defines);
+            r.label = w.vertexPath + " + " + w.fragmentPath;
+            if (r.vertexCode.empty() || r.fragmentCode.empty()) continue;
+            ready.push_back(std::move(r));
+        }
+
+        lock.lock();
+        if (!ready.empty()) {
+            for (PendingReload& r : ready) queueReload(std::move(r));
+            hasPending.store(true, std::memory_order_release);
+        }
+        cv.wait_for(lock, std::chrono::milliseconds(pollMs), [] { return quit; });
+    }
+}
+
+void startShaderWatcher(int pollMs)
+{
+    if (watcher.joinable()) return;
+    quit = false;
+    watcher = std::thread(watchLoop, pollMs);
+}
+
+void stopShaderWatcher()
+{
+    if (watcher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        cv.notify_all();
+        watcher.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    programs.clear();
+    pending.clear();
+    hasPending.store(false);
+}
+
+void watchShaderProgram(unsigned* program, const char* vertexPath, const char* fragmentPath,
+                        std::function<void(unsigned)> onReload, const std::string& defines)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (WatchedProgram& w : programs) {
+        if (w.slot == program) { w = { program, vertexPath, fragmentPath, onReload, defines }; return; }
+    }
+    programs.push_back({ program, vertexPath, fragmentPath, onReload, defines });
+}
+
+void unwatchShaderProgram(unsigned* program)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < programs.size(); ++i) {
+        if (programs[i].slot == program) { programs.erase(programs.begin() + i); break; }
+    }
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (pending[i].slot == program) { pending.erase(pending.begin() + i); break; }
+    }
+}
+
+int applyShaderReloads()
+{
+    if (!hasPending.load(std::memory_order_acquire)) return 0;
+
+    std::vector<PendingReload> batch;
+    std::vector<std::function<void(unsigned)>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch.swap(pending);
+        hasPending.store(false);
+        // drop reloads whose slot was unwatched meanwhile, pick up the callbacks
+        for (size_t i = 0; i < batch.size();) {
+            const WatchedProgram* owner = nullptr;
+            for (const WatchedProgram& w : programs)
+                if (w.slot == batch[i].slot) { owner = &w; break; }
+            if (!owner) { batch.erase(batch.begin() + i); continue; }
+            callbacks.push_back(owner->onReload);
+            ++i;
+        }
+    }
+
+    int swapped = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const PendingReload& r = batch[i];
+        unsigned program = acquireProgramFromSource(r.vertexCode, r.fragmentCode, r.label);
+        if (!program) {
+            std::cout << "Hot reload: " << r.label << " failed, keeping the previous program" << std::endl;
+            continue;
+        }
+        if (program == *r.slot) {
+            // saved without a real change: the cache handed back the live program
+            releaseProgram(program);
+            continue;
+        }
+
+        unsigned old = *r.slot;
+        *r.slot = program;
+        if (old) releaseProgram(old);
+        if (callbacks[i]) callbacks[i](program);
+        swapped++;
+        std::cout << "Hot reload: " << r.label << " reloaded" << std::endl;
+    }
+    return swapped;
+}
@@ -0,0 +1,159 @@
+#include <GL/glew.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../Header/Shadow.h"
+#include "../Header/Animation.h"
+
+static GLuint shadowFBO = 0;
+static GLuint shadowDepth = 0;
+static int allocatedSize = 0;
+static Shader* casterShader = nullptr;
+
+static glm::mat4 lightViewProj = glm::mat4(1.0f);
+static bool haveMap = false;
+static bool activeThisFrame = false;
+static ShadowCasterKey lastKey;
+static glm::vec3 lastLightDir = glm::vec3(0.0f);
+static std::chrono::steady_clock::time_point passStart;
+static GLint previousFBO = 0; // the scene may be rendering into an off-screen target
+static ShadowStats stats;
+
+static bool sameKey(const ShadowCasterKey& a, const ShadowCasterKey& b)
+{
+    return std::memcmp(glm::value_ptr(a.model), glm::value_ptr(b.model), sizeof(glm::mat4)) == 0 &&
+           a.poseTime == b.poseTime && a.lod == b.lod;
+}
+
+static void allocateMap(int size)
+{
+    if (!shadowDepth) glGenTextures(1, &shadowDepth);
+    glBindTexture(GL_TEXTURE_2D, shadowDepth);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // hardware depth compare + bilinear = 2x2 PCF per tap
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    const float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!shadowFBO) glGenFramebuffers(1, &shadowFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowDepth, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Shadow map: framebuffer incomplete (" << size << " x " << size << ")" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    allocatedSize = size;
+    haveMap = false;
+}
+
+void initShadows(const RenderSettings& settings)
+{
+    casterShader = new Shader("basic.vert", "shadow.frag");
+    casterShader->onProgramCreated(bindBoneBlock);
+    for (unsigned f : { 0u, (unsigned)SHADER_USE_TEX, (unsigned)SHADER_SKINNED, (unsigned)(SHADER_SKINNED | SHADER_USE_TEX) })
+        casterShader->prepareFeatures(f);
+    allocateMap(settings.shadowMapSize);
+}
+
+void shutdownShadows()
+{
+    if (shadowFBO) { glDeleteFramebuffers(1, &shadowFBO); shadowFBO = 0; }
+    if (shadowDepth) { glDeleteTextures(1, &shadowDepth); shadowDepth = 0; }
+    delete casterShader;
+    casterShader = nullptr;
+    allocatedSize = 0;
+    haveMap = false;
+}
+
+void beginShadowFrame()
+{
+    activeThisFrame = false;
+}
+
+bool beginShadowPass(const glm::vec3& lightDir, const Bounds& casterBounds, const ShadowCasterKey& key,
+                     const RenderSettings& settings)
+{
+    if (!casterShader) return false;
+    activeThisFrame = true;
+
+    if (settings.shadowMapSize != allocatedSize) allocateMap(settings.shadowMapSize);
+    if (haveMap && sameKey(key, lastKey) && lightDir == lastLightDir) {
+        stats.reused++;
+        return false;
+    }
+    passStart = std::chrono::steady_clock::now();
+
+    // orthographic box around the casters, deep enough to reach the plane under them
+    const glm::vec3 dir = glm::normalize(lightDir);
+    const float r = glm::max(casterBounds.radius, 0.01f);
+    const glm::vec3 eye = casterBounds.center - dir * (r * 2.0f);
+    float farPlane = r * 4.0f;
+    if (dir.y < -0.05f) farPlane = glm::max(farPlane, eye.y / -dir.y + r);
+    farPlane = glm::min(farPlane, r * 2.0f + 50.0f);
+    const glm::vec3 up = glm::abs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    lightViewProj = glm::ortho(-r, r, -r, r, 0.0f, farPlane) * glm::lookAt(eye, casterBounds.center, up);
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
+    glViewport(0, 0, allocatedSize, allocatedSize);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    casterShader->use();
+    casterShader->setMat4("uV", glm::mat4(1.0f));
+    casterShader->setMat4("uP", lightViewProj);
+
+    lastKey = key;
+    lastLightDir = lightDir;
+    return true;
+}
+
+void endShadowPass(int viewportW, int viewportH)
+{
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFBO);
+    glViewport(0, 0, viewportW, viewportH);
+    haveMap = true;
+    stats.renders++;
+    stats.lastRenderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - passStart).count();
+}
+
+Shader& shadowCasterShader()
+{
+    return *casterShader;
+}
+
+bool shadowsActive()
+{
+    return activeThisFrame && haveMap;
+}
+
+void bindShadowMap(unsigned program, const RenderSettings& settings)
+{
+    glActiveTexture(GL_TEXTURE0 + SHADOW_MAP_UNIT);
+    glBindTexture(GL_TEXTURE_2D, shadowDepth);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUniform1i(glGetUniformLocation(program, "uShadowMap"), SHADOW_MAP_UNIT);
+    glUniformMatrix4fv(glGetUniformLocation(program, "uLightVP"), 1, GL_FALSE, glm::value_ptr(lightViewProj));
+    glUniform1i(glGetUniformLocation(program, "uShadowPcf"), glm::clamp(settings.shadowPcfRadius, 0, SHADOW_MAX_PCF_RADIUS));
+}
+
+const ShadowStats& shadowStats()
+{
+    return stats;
+}
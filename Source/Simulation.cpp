@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../Header/Simulation.h"
+#include "../Header/InputReplay.h"
+#include "../Header/InputQueue.h"
+#include "../Header/NavGrid.h"
+#include "../Header/RouteTrack.h"
+#include "../Header/SupermanGlobals.h"
+
+// plane is 20 x 20 world units centered on the origin (same as the map model matrix)
+static const float planeHalf = 20.0f * 0.5f;
+
+// movement input sampled between frames
+struct SimInputSample {
+    float offset;      // seconds into the frame's dt
+    uint16_t keys;
+    glm::vec2 move;
+};
+
+struct SimFrame {
+    float dt;
+    SimInput input;                            // polled at the frame start (the end of its dt)
+    std::vector<SimInputSample> samples;       // in time order, live sessions only
+    bool routeChanged = false;                 // setSimAutopilot() since the previous frame
+    std::shared_ptr<const RouteTrack> route;
+};
+
+// speeds / bounds copied at start: the thread never reads state the main thread writes
+struct SimParams {
+    float cameraSpeed = 0.0f;
+    float clampMargin = 0.0f;
+    float moveSpeed = 0.0f;
+    float turnSpeed = 0.0f;
+    float metersPerUnit = 0.0f;
+    const NavGrid* nav = nullptr;  // immutable once built; null = no collision, only the plane clamp
+};
+
+static std::thread simThread;
+static std::mutex simMutex;
+static std::condition_variable simCv;
+static std::vector<SimFrame> queuedFrames;
+static bool simBusy = false;
+static bool simQuit = false;
+static bool pendingRouteChanged = false;           // attached to the next handed-over frame
+static std::shared_ptr<const RouteTrack> pendingRoute;
+
+// published after every frame (guarded by simMutex)
+static SimSnapshot publishedPrev, publishedCurr;
+static float publishedAlpha = 0.0f;
+
+// owned by the thread
+static SimParams params;
+static SimSnapshot state;
+static SimSnapshot previous;        // state before the last step (the renderer blends the two)
+static glm::vec3 meteredPos(0.0f);  // last position the walked distance was counted from
+static float accumulator = 0.0f;
+static std::shared_ptr<const RouteTrack> autopilotTrack;
+static float autopilotDistance = 0.0f;  // arc length walked along it
+
+// main thread: input sampling
+static std::vector<SimInputSample> pendingSamples;  // since the last frame poll
+static double intervalStart = -1.0;   // glfwGetTime of the last frame poll
+static double lastSampleTime = 0.0;
+static uint16_t lastKeys = 0;
+static glm::vec2 lastMove(0.0f);
+static glm::vec2 lastLook(0.0f);      // right stick at the last sample, held until the next one
+static double lastLookTime = 0.0;
+static glm::vec2 lookDegrees(0.0f);   // right stick turn accumulated since the last frame poll
+static SimInputStats inputStats;
+
+static float clampToPlane(float v)
+{
+    return glm::clamp(v, -planeHalf - params.clampMargin, planeHalf + params.clampMargin);
+}
+
+// Move from -> to unless the avatar's footprint would end up in blocked cells; then slide along whichever
+// axis still fits (walking diagonally into a shore keeps the parallel part of the move).
+static glm::vec3 resolveMove(const glm::vec3& from, const glm::vec3& to)
+{
+    const NavGrid* nav = params.nav;
+    if (!nav) return to;
+    const float r = NAV_AVATAR_RADIUS;
+    if (nav->circleFree(glm::vec2(to.x, to.z), r)) return to;
+    if (!nav->circleFree(glm::vec2(from.x, from.z), r)) return to; // already inside (start spot): let it walk out
+    if (nav->circleFree(glm::vec2(to.x, from.z), r)) return glm::vec3(to.x, to.y, from.z);
+    if (nav->circleFree(glm::vec2(from.x, to.z), r)) return glm::vec3(from.x, to.y, to.z);
+    return from;
+}
+
+// walked distance (world units -> meters)
+static void meterAvatar()
+{
+    float moved = glm::length(state.avatarPos - meteredPos);
+    if (moved > 1e-6f) {
+        state.avatarMeters += moved * params.metersPerUnit;
+        meteredPos = state.avatarPos;
+    }
+}
+
+// turn towards a movement direction (shortest way), at most turnSpeed deg/s
+static void turnAvatar(float desiredYaw, float h)
+{
+    float diff = fmodf(desiredYaw - state.avatarYawDeg + 540.0f, 360.0f) - 180.0f;
+    float maxDelta = params.turnSpeed * h;
+    state.avatarYawDeg += glm::clamp(diff, -maxDelta, maxDelta);
+}
+
+static void stepAutopilot(const SimInput& in, float h)
+{
+    glm::vec3 before = state.avatarPos;
+    autopilotDistance = std::min(autopilotDistance + in.autopilotSpeed * h, autopilotTrack->length());
+    glm::vec3 dir;
+    glm::vec3 p = autopilotTrack->positionAt(autopilotDistance, &dir);
+
+    // same yaw convention as WASD: a move along (-x, z) faces atan2(z, x)
+    turnAvatar(glm::degrees(std::atan2(dir.z, -dir.x)), h);
+    state.avatarPos = glm::vec3(p.x, state.avatarPos.y, p.z);
+    meterAvatar();
+    state.avatarSpeed = glm::length(state.avatarPos - before) / h;
+
+    state.autopilotProgress = autopilotDistance / autopilotTrack->length();
+    if (autopilotDistance >= autopilotTrack->length()) {
+        autopilotTrack.reset();
+        state.autopilot = false;
+    }
+}
+
+static void stepAvatar(const SimInput& in, float h)
+{
+    glm::vec3 inputDir(0.0f);
+    if (in.keys & SIM_KEY_W) inputDir += glm::vec3(0.0f, 0.0f, 1.0f); // forward -> +Z
+    if (in.keys & SIM_KEY_S) inputDir -= glm::vec3(0.0f, 0.0f, 1.0f); // back    -> -Z
+    if (in.keys & SIM_KEY_D) inputDir += glm::vec3(1.0f, 0.0f, 0.0f); // right   -> +X
+    if (in.keys & SIM_KEY_A) inputDir -= glm::vec3(1.0f, 0.0f, 0.0f); // left    -> -X
+
+    inputDir += glm::vec3(in.move.x, 0.0f, in.move.y); // stick: same axes as D / W
+
+    glm::vec3 before = state.avatarPos;
+    if (glm::length(inputDir) > 1e-6f) {
+        glm::vec3 moveDir = glm::normalize(inputDir);
+        float amount = std::min(glm::length(inputDir), 1.0f); // a half-tilted stick walks at half speed
+
+        turnAvatar(glm::degrees(std::atan2(moveDir.z, moveDir.x)), h);
+
+        glm::vec3 next = state.avatarPos + glm::vec3(-moveDir.x, 0.0f, moveDir.z) * params.moveSpeed * amount * h;
+        next.x = clampToPlane(next.x);
+        next.z = clampToPlane(next.z);
+        state.avatarPos = resolveMove(state.avatarPos, next);
+        meterAvatar();
+    }
+    state.avatarSpeed = glm::length(state.avatarPos - before) / h;
+}
+
+static void stepCamera(const SimInput& in, float h)
+{
+    float camMoveSpeed = params.cameraSpeed * h;
+    float yawRad = glm::radians(in.cameraYaw);
+    glm::vec3 forwardXZ = glm::normalize(glm::vec3(cos(yawRad), 0.0f, sin(yawRad)));
+    glm::vec3 right = glm::normalize(glm::cross(forwardXZ, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+    if (in.keys & SIM_KEY_UP)    state.cameraPos += forwardXZ * camMoveSpeed;
+    if (in.keys & SIM_KEY_DOWN)  state.cameraPos -= forwardXZ * camMoveSpeed;
+    if (in.keys & SIM_KEY_LEFT)  state.cameraPos -= right * camMoveSpeed;
+    if (in.keys & SIM_KEY_RIGHT) state.cameraPos += right * camMoveSpeed;
+
+    state.cameraPos.x = clampToPlane(state.cameraPos.x);
+    state.cameraPos.z = clampToPlane(state.cameraPos.z);
+    state.cameraPos.y = in.cameraY;
+}
+
+// 2D walk sprite: facing from the WASD direction, two frames alternating every 0.5 s while moving
+static void stepSprite(const SimInput& in, float h)
+{
+    int dirX = ((in.keys & SIM_KEY_D) || in.move.x > 0.5f ? 1 : 0) - ((in.keys & SIM_KEY_A) || in.move.x < -0.5f ? 1 : 0);
+    int dirY = ((in.keys & SIM_KEY_W) || in.move.y > 0.5f ? 1 : 0) - ((in.keys & SIM_KEY_S) || in.move.y < -0.5f ? 1 : 0);
+    int facing = 0;
+    if (dirX > 0) facing = 1;      // rightish
+    else if (dirX < 0) facing = 2; // leftish
+    else if (dirY > 0) facing = 3; // up
+    else if (dirY < 0) facing = 4; // down
+
+    if (facing == 0) {
+        state.spriteState = 0;
+        state.spriteTimer = 0.0f;
+        state.spriteFrame = 0;
+        return;
+    }
+    state.spriteState = facing;
+    state.spriteTimer += h;
+    if (state.spriteTimer >= 0.5f) {
+        state.spriteTimer -= 0.5f;
+        state.spriteFrame ^= 1;
+    }
+}
+
+static void step(const SimInput& in, float h)
+{
+    if (in.paused) {
+        state.avatarSpeed = 0.0f;
+        return;
+    }
+    // WASD / the stick takes the avatar back from the autopilot
+    if (autopilotTrack && ((in.keys & (SIM_KEY_W | SIM_KEY_A | SIM_KEY_S | SIM_KEY_D)) || glm::length(in.move) > 0.0f)) {
+        autopilotTrack.reset();
+        state.autopilot = false;
+    }
+    if (autopilotTrack) stepAutopilot(in, h);
+    else stepAvatar(in, h);
+    stepCamera(in, h);
+    stepSprite(in, h);
+}
+
+// The input during the step ending at stepEnd (seconds into the frame): the first sample from its middle on.
+// Without samples (or past the last one) the frame's own poll.
+static SimInput inputForStep(const SimFrame& f, float stepEnd)
+{
+    SimInput in = f.input;
+    const float middle = stepEnd - SIM_STEP_SECONDS * 0.5f;
+    for (const SimInputSample& s : f.samples) {
+        if (s.offset < middle) continue;
+        in.keys = s.keys;
+        in.move = s.move;
+        break;
+    }
+    return in;
+}
+
+static void runSimulation()
+{
+    std::vector<SimFrame> batch;
+    std::unique_lock<std::mutex> lock(simMutex);
+    while (true) {
+        simCv.wait(lock, [] { return !queuedFrames.empty() || simQuit; });
+        if (simQuit) return;
+
+        batch.swap(queuedFrames);
+        simBusy = true;
+        lock.unlock();
+
+        for (const SimFrame& f : batch) {
+            if (f.routeChanged) {
+                autopilotTrack = f.route && !f.route->empty() ? f.route : nullptr;
+                autopilotDistance = 0.0f;
+                state.autopilot = autopilotTrack != nullptr;
+                state.autopilotProgress = 0.0f;
+            }
+            const float carry = accumulator; // time already stepped into before this frame began
+            accumulator += std::min(f.dt, SIM_MAX_FRAME_SECONDS);
+            for (int n = 1; accumulator >= SIM_STEP_SECONDS; ++n) {
+                previous = state;
+                step(f.samples.empty() ? f.input : inputForStep(f, n * SIM_STEP_SECONDS - carry), SIM_STEP_SECONDS);
+                accumulator -= SIM_STEP_SECONDS;
+            }
+            std::lock_guard<std::mutex> publish(simMutex);
+            publishedPrev = previous;
+            publishedCurr = state;
+            publishedAlpha = accumulator / SIM_STEP_SECONDS;
+        }
+        batch.clear();
+
+        lock.lock();
+        simBusy = false;
+        simCv.notify_all();
+    }
+}
+
+void startSimulation(const SceneState& scene, const NavGrid* nav)
+{
+    if (simThread.joinable()) return;
+
+    params.cameraSpeed = scene.camera.speed;
+    params.clampMargin = scene.camera.clampMargin;
+    params.moveSpeed = supermanMoveSpeed;
+    params.turnSpeed = supermanTurnSpeed;
+    params.metersPerUnit = METERS_PER_WORLD_UNIT;
+    params.nav = nav;
+
+    state = SimSnapshot();
+    state.cameraPos = scene.view.cameraPos;
+    state.avatarPos = scene.avatar.pos;
+    state.avatarYawDeg = scene.avatar.yawDeg;
+    state.avatarMeters = scene.avatar.meters;
+    state.spriteState = scene.avatar.spriteState;
+    state.spriteFrame = scene.avatar.spriteFrame;
+    state.spriteTimer = scene.avatar.spriteTimer;
+    previous = state;
+    meteredPos = scene.avatar.pos;
+    accumulator = 0.0f;
+    autopilotTrack.reset();
+    pendingRouteChanged = false;
+    pendingRoute.reset();
+
+    publishedPrev = publishedCurr = state;
+    publishedAlpha = 0.0f;
+    queuedFrames.clear();
+    simQuit = false;
+    simThread = std::thread(runSimulation);
+}
+
+void stopSimulation()
+{
+    if (!simThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(simMutex);
+        simQuit = true;
+    }
+    simCv.notify_all();
+    simThread.join();
+}
+
+static uint16_t polledKeyBits(GLFWwindow* window)
+{
+    static const struct { int key; uint16_t bit; } keyMap[] = {
+        { GLFW_KEY_W, SIM_KEY_W }, { GLFW_KEY_A, SIM_KEY_A }, { GLFW_KEY_S, SIM_KEY_S }, { GLFW_KEY_D, SIM_KEY_D },
+        { GLFW_KEY_UP, SIM_KEY_UP }, { GLFW_KEY_DOWN, SIM_KEY_DOWN }, { GLFW_KEY_LEFT, SIM_KEY_LEFT }, { GLFW_KEY_RIGHT, SIM_KEY_RIGHT }
+    };
+    uint16_t keys = 0;
+    for (const auto& k : keyMap)
+        if (inputKeyDown(window, k.key)) keys |= k.bit;
+    return keys;
+}
+
+// A new sample: stamp changes for the latency stats, integrate the right stick up to `now`.
+static void noteSample(double now, uint16_t keys, const glm::vec2& move, const glm::vec2& look)
+{
+    if (keys != lastKeys || move != lastMove || (look != glm::vec2(0.0f) && lastLook == glm::vec2(0.0f)))
+        notePolledInputChange(inputClockUs());
+    lookDegrees += lastLook * (float)(now - lastLookTime) * GAMEPAD_LOOK_DEG_PER_SEC;
+    lastKeys = keys;
+    lastMove = move;
+    lastLook = look;
+    lastLookTime = now;
+}
+
+void sampleSimInput(GLFWwindow* window)
+{
+    if (inputSessionMode() != INPUT_LIVE || intervalStart < 0.0) return;
+    const double now = glfwGetTime();
+    if (now - lastSampleTime < 1.0 / SIM_INPUT_SAMPLE_HZ) return;
+    lastSampleTime = now;
+
+    inputPollEvents(window); // key state (and button presses) as of now
+    const GamepadInput pad = inputSampleGamepad(window);
+    SimInputSample s;
+    s.offset = (float)(now - intervalStart);
+    s.keys = polledKeyBits(window);
+    s.move = glm::vec2(pad.moveX, pad.moveY);
+    pendingSamples.push_back(s);
+    noteSample(now, s.keys, s.move, glm::vec2(pad.lookX, pad.lookY));
+}
+
+SimInput pollSimInput(GLFWwindow* window, ViewState& view, float dt)
+{
+    const GamepadInput& pad = inputGamepad();
+    SimInput in;
+    in.keys = polledKeyBits(window);
+    in.move = glm::vec2(pad.moveX, pad.moveY);
+    in.paused = view.overviewMode || view.cameraOnPath;
+
+    // right stick: live, integrated over the samples since the last poll; recorded / replayed, over the frame dt
+    const glm::vec2 look(pad.lookX, pad.lookY);
+    const double now = glfwGetTime();
+    glm::vec2 turn = look * dt * GAMEPAD_LOOK_DEG_PER_SEC;
+    if (inputSessionMode() == INPUT_LIVE) {
+        if (intervalStart < 0.0) lastLookTime = now;
+        noteSample(now, in.keys, in.move, look);
+        turn = lookDegrees;
+    }
+    lookDegrees = glm::vec2(0.0f);
+    if (!in.paused && turn != glm::vec2(0.0f)) {
+        view.cameraYaw += turn.x;
+        view.cameraPitch = glm::clamp(view.cameraPitch + turn.y, -89.0f, 89.0f);
+        resetCameraFront(view);
+    }
+    intervalStart = now;
+    lastSampleTime = now;
+
+    inputStats.gamepad = pad.connected;
+    in.cameraYaw = view.cameraYaw;
+    in.cameraY = view.cameraYWalking;
+    return in;
+}
+
+const SimInputStats& simInputStats()
+{
+    return inputStats;
+}
+
+void setSimAutopilot(std::shared_ptr<const RouteTrack> track)
+{
+    std::lock_guard<std::mutex> lock(simMutex);
+    pendingRouteChanged = true;
+    pendingRoute = std::move(track);
+}
+
+void advanceSimulation(float dt, const SimInput& input)
+{
+    {
+        std::lock_guard<std::mutex> lock(simMutex);
+        SimFrame frame;
+        frame.dt = dt;
+        frame.input = input;
+        frame.samples.swap(pendingSamples);
+        inputStats.samplesLastFrame = (int)frame.samples.size();
+        frame.routeChanged = pendingRouteChanged;
+        frame.route = std::move(pendingRoute);
+        pendingRouteChanged = false;
+        pendingRoute.reset();
+        queuedFrames.push_back(std::move(frame));
+    }
+    simCv.notify_all();
+}
+
+SimSnapshot sampleSimulation(bool wait)
+{
+    std::unique_lock<std::mutex> lock(simMutex);
+    if (wait) simCv.wait(lock, [] { return (queuedFrames.empty() && !simBusy) || simQuit; });
+
+    const SimSnapshot& a = publishedPrev;
+    const SimSnapshot& b = publishedCurr;
+    float t = publishedAlpha;
+
+    SimSnapshot s = b;
+    s.cameraPos = glm::mix(a.cameraPos, b.cameraPos, t);
+    s.avatarPos = glm::mix(a.avatarPos, b.avatarPos, t);
+    s.avatarMeters = a.avatarMeters + (b.avatarMeters - a.avatarMeters) * t;
+    float yawDiff = fmodf(b.avatarYawDeg - a.avatarYawDeg + 540.0f, 360.0f) - 180.0f;
+    s.avatarYawDeg = a.avatarYawDeg + yawDiff * t;
+    return s;
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../Header/Startup.h"
+
+struct StartupEvent {
+    const char* name;
+    int tid;           // 1 = the thread that called beginStartup (GL thread), then in order of first phase
+    double startMs;
+    double durMs;
+    bool wait;
+    bool extra;
+};
+
+static std::mutex eventMutex;
+static std::vector<StartupEvent> events;
+static std::unordered_map<std::thread::id, int> threadIds;
+static std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+static std::atomic<bool> active{ false };
+static std::atomic<bool> serial{ false };
+
+void setSerialStartup(bool value)
+{
+    serial.store(value, std::memory_order_release);
+}
+
+bool serialStartup()
+{
+    return serial.load(std::memory_order_acquire);
+}
+
+void beginStartup()
+{
+    std::lock_guard<std::mutex> lock(eventMutex);
+    epoch = std::chrono::steady_clock::now();
+    events.clear();
+    events.reserve(64);
+    threadIds.clear();
+    threadIds[std::this_thread::get_id()] = 1;
+    active.store(true, std::memory_order_release);
+}
+
+bool startupActive()
+{
+    return active.load(std::memory_order_acquire);
+}
+
+double startupClockMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void recordStartupPhase(const char* name, double startMs, bool wait, bool extra)
+{
+    if (!startupActive()) return;
+    const double endMs = startupClockMs();
+    std::lock_guard<std::mutex> lock(eventMutex);
+    auto it = threadIds.find(std::this_thread::get_id());
+    const int tid = it != threadIds.end() ? it->second : (threadIds[std::this_thread::get_id()] = (int)threadIds.size() + 1);
+    events.push_back({ name, tid, startMs, endMs - startMs, wait, extra });
+}
+
+static std::string escapeJson(const char* s)
+{
+    std::string out;
+    for (const char* c = s; *c; ++c) {
+        if (*c == '"' || *c == '\\') out += '\\';
+        out += *c;
+    }
+    return out;
+}
+
+static void writeStartupTrace(const char* path, const std::vector<StartupEvent>& list, int threads)
+{
+    FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::cout << "Startup: cannot write " << path << std::endl;
+        return;
+    }
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main thread (GL)\"}}");
+    for (int t = 2; t <= threads; ++t)
+        std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}", t, t - 1);
+    for (const StartupEvent& e : list) {
+        std::fprintf(f, ",\n{\"name\":\"%s%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                     e.wait ? "wait: " : "", escapeJson(e.name).c_str(), e.wait ? "wait" : "init", e.startMs * 1000.0, e.durMs * 1000.0, e.tid);
+    }
+    std::fprintf(f, "\n]}\n");
+    std::fclose(f);
+    std::cout << "Startup: trace written to " << path << std::endl;
+}
+
+StartupReport finishStartup(const char* tracePath)
+{
+    StartupReport report;
+    if (!active.exchange(false)) return report;
+    const double firstFrameMs = startupClockMs();
+
+    std::vector<StartupEvent> list;
+    int threads = 0;
+    {
+        std::lock_guard<std::mutex> lock(eventMutex);
+        list = events;
+        threads = (int)threadIds.size();
+    }
+    std::sort(list.begin(), list.end(), [](const StartupEvent& a, const StartupEvent& b) { return a.startMs < b.startMs; });
+
+    double workerMs = 0.0, waitMs = 0.0;
+    for (const StartupEvent& e : list) {
+        if (e.tid == 1 && e.extra) report.extraMs += e.durMs;
+        if (e.wait) waitMs += e.durMs;
+        else if (e.tid != 1) workerMs += e.durMs;
+    }
+    report.serial = serialStartup();
+    report.firstFrameMs = firstFrameMs;
+    std::printf("Startup: first frame after %.1f ms (workers %.1f ms on %d threads, GL thread waited %.1f ms for them)\n",
+                firstFrameMs, workerMs, std::max(0, threads - 1), waitMs);
+    if (report.serial) {
+        report.baselineMs = report.comparedMs();
+        if (FILE* f = std::fopen(STARTUP_BASELINE_PATH, "w")) {
+            std::fprintf(f, "%.3f\n", report.baselineMs);
+            std::fclose(f);
+        }
+        std::printf("Startup: serial baseline %.1f ms (without %.1f ms of extra phases) written to %s\n",
+                    report.baselineMs, report.extraMs, STARTUP_BASELINE_PATH);
+    } else {
+        if (FILE* f = std::fopen(STARTUP_BASELINE_PATH, "r")) {
+            if (std::fscanf(f, "%lf", &report.baselineMs) != 1) report.baselineMs = 0.0;
+            std::fclose(f);
+        }
+        if (report.baselineMs > 0.0)
+            std::printf("Startup: %.1f ms (without %.1f ms of extra phases) against the serial baseline %.1f ms, %.2fx (target %.1fx)\n",
+                        report.comparedMs(), report.extraMs, report.baselineMs, report.speedup(), STARTUP_TARGET_SPEEDUP);
+        else
+            std::printf("Startup: no serial baseline in %s (run once with --serial-startup)\n", STARTUP_BASELINE_PATH);
+    }
+    for (const StartupEvent& e : list) {
+        char thread[24];
+        if (e.tid == 1) std::snprintf(thread, sizeof(thread), "main");
+        else std::snprintf(thread, sizeof(thread), "worker %d", e.tid - 1);
+        std::printf("  %8.1f ms %8.2f ms  %-9s %s%s%s\n", e.startMs, e.durMs, thread, e.wait ? "wait: " : "", e.name, e.extra ? " (extra)" : "");
+    }
+    if (tracePath) writeStartupTrace(tracePath, list, threads);
+    return report;
+}
@@ -8,6 +8,8 @@
 #include "../Header/Text.h"
 #include "../Header/stb_easy_font.h"
 #include "../Header/Util.h"
+#include "../Header/ShaderCache.h"
+#include "../Header/ShaderReload.h"
 
 
 static GLuint textProgram = 0;
@@ -21,6 +23,10 @@ void initText() {
     textProgram = createShader("text.vert", "text.frag");
     uResolutionLoc = glGetUniformLocation(textProgram, "uResolution");
     uColorLoc = glGetUniformLocation(textProgram, "uColor");
+    watchShaderProgram(&textProgram, "text.vert", "text.frag", [](unsigned program) {
+        uResolutionLoc = glGetUniformLocation(program, "uResolution");
+        uColorLoc = glGetUniformLocation(program, "uColor");
+    });
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -36,14 +42,11 @@ void initText() {
 
 }
 
-void drawText(const char* text, float xPx, float yPx, float r, float g, float b) {
+void drawText(const char* text, float xPx, float yPx, float r, float g, float b, float scale) {
     if (!textProgram || !text) {
         return;
     }
 
-    // scale factor (6x bigger)
-    const float scale = 6.0f;
-
     // compute text bounding box using stb helper (returns px for base size)
     int baseW = stb_easy_font_width((char*)text);
     int baseH = stb_easy_font_height((char*)text);
@@ -167,5 +170,6 @@ void drawText(const char* text, float xPx, float yPx, float r, float g, float b)
 void cleanupText() {
     if (textVBO) { glDeleteBuffers(1, &textVBO); textVBO = 0; }
     if (textVAO) { glDeleteVertexArrays(1, &textVAO); textVAO = 0; }
-    if (textProgram) { glDeleteProgram(textProgram); textProgram = 0; }
+    unwatchShaderProgram(&textProgram);
+    if (textProgram) { releaseProgram(textProgram); textProgram = 0; }
 }
\ No newline at end of file
@@ -0,0 +1,435 @@
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <filesystem>
+
+#include "../Header/TextureCache.h"
+#include "../Header/stb_image.h"
+
+const char* TEXTURE_CACHE_DIR = "Resources/cache";
+
+// Vulkan format ids used by KTX2 (vkFormat field) for the block formats we produce/consume.
+static const uint32_t VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131;
+static const uint32_t VK_FORMAT_BC3_UNORM_BLOCK = 137;
+static const uint32_t VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK = 147;
+static const uint32_t VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK = 151;
+
+// ETC2 enums are core in GL 4.3 / ARB_ES3_compatibility; define them in case the headers are older.
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+static const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+struct BlockFormat {
+    uint32_t vkFormat;
+    GLenum glInternalFormat;
+    uint32_t blockBytes; // bytes per 4x4 block
+    bool hasAlpha;
+};
+
+static const BlockFormat BLOCK_FORMATS[] = {
+    { VK_FORMAT_BC1_RGB_UNORM_BLOCK,         GL_COMPRESSED_RGB_S3TC_DXT1_EXT,  8, false },
+    { VK_FORMAT_BC3_UNORM_BLOCK,             GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16, true },
+    { VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,     GL_COMPRESSED_RGB8_ETC2,          8, false },
+    { VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,   GL_COMPRESSED_RGBA8_ETC2_EAC,     16, true },
+};
+
+static const BlockFormat* findByVkFormat(uint32_t vkFormat) {
+    for (const BlockFormat& f : BLOCK_FORMATS)
+        if (f.vkFormat == vkFormat) return &f;
+    return nullptr;
+}
+
+static bool hasS3TC() { return GLEW_EXT_texture_compression_s3tc; }
+static bool hasETC2() { return GLEW_ARB_ES3_compatibility; }
+
+static bool isSupported(const BlockFormat& f) {
+    if (f.vkFormat == VK_FORMAT_BC1_RGB_UNORM_BLOCK || f.vkFormat == VK_FORMAT_BC3_UNORM_BLOCK) return hasS3TC();
+    return hasETC2();
+}
+
+// pick BC1/BC3 on desktop GPUs, ETC2 where only that is available; nullptr -> stay uncompressed
+static const BlockFormat* chooseFormat(bool needsAlpha) {
+    if (hasS3TC()) return findByVkFormat(needsAlpha ? VK_FORMAT_BC3_UNORM_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+    if (hasETC2()) return findByVkFormat(needsAlpha ? VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK : VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK);
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------
+// small helpers
+// ---------------------------------------------------------------------------------------------
+
+static uint64_t fnv1a64(const unsigned char* data, size_t n) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < n; ++i) { h ^= data[i]; h *= 1099511628211ULL; }
+    return h;
+}
+
+// turn an asset path/key into a flat file name ("Resources\\superman.glb" -> "Resources_superman.glb")
+static std::string sanitizeKey(const std::string& key) {
+    std::string out = key;
+    for (char& c : out) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '_';
+        if (!ok) c = '_';
+    }
+    return out;
+}
+
+static std::string cachePathFor(const std::string& key) {
+    return std::string(TEXTURE_CACHE_DIR) + "/" + sanitizeKey(key) + ".ktx2";
+}
+
+// cache file is usable if it exists and is not older than its source (empty source = memory asset, keyed by hash)
+static bool cacheIsFresh(const std::string& cachePath, const char* sourcePath) {
+    std::error_code ec;
+    if (!std::filesystem::exists(cachePath, ec)) return false;
+    if (!sourcePath) return true;
+    auto cacheTime = std::filesystem::last_write_time(cachePath, ec);
+    if (ec) return false;
+    auto srcTime = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec) return true; // source gone: the cache is all we have
+    return cacheTime >= srcTime;
+}
+
+static void flipRows(unsigned char* rgba, int w, int h) {
+    const size_t stride = size_t(w) * 4;
+    std::vector<unsigned char> tmp(stride);
+    for (int y = 0; y < h / 2; ++y) {
+        unsigned char* a = rgba + size_t(y) * stride;
+        unsigned char* b = rgba + size_t(h - 1 - y) * stride;
+        std::memcpy(tmp.data(), a, stride);
+        std::memcpy(a, b, stride);
+        std::memcpy(b, tmp.data(), stride);
+    }
+}
+
+static bool anyTranslucent(const unsigned char* rgba, int w, int h) {
+    const size_t n = size_t(w) * size_t(h);
+    for (size_t i = 0; i < n; ++i)
+        if (rgba[i * 4 + 3] != 255) return true;
+    return false;
+}
+
+// 2x2 box filter; odd edges reuse the last row/column
+static std::vector<unsigned char> downsample(const std::vector<unsigned char>& src, int w, int h, int& outW, int& outH) {
+    outW = w > 1 ? w / 2 : 1;
+    outH = h > 1 ? h / 2 : 1;
+    std::vector<unsigned char> dst(size_t(outW) * size_t(outH) * 4);
+    for (int y = 0; y < outH; ++y) {
+        int y0 = std::min(y * 2, h - 1), y1 = std::min(y * 2 + 1, h - 1);
+        for (int x = 0; x < outW; ++x) {
+            int x0 = std::min(x * 2, w - 1), x1 = std::min(x * 2 + 1, w - 1);
+            for (int c = 0; c < 4; ++c) {
+                unsigned sum = src[(size_t(y0) * w + x0) * 4 + c] + src[(size_t(y0) * w + x1) * 4 + c]
+                             + src[(size_t(y1) * w + x0) * 4 + c] + src[(size_t(y1) * w + x1) * 4 + c];
+                dst[(size_t(y) * outW + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+// ---------------------------------------------------------------------------------------------
+// KTX2 container
+// ---------------------------------------------------------------------------------------------
+
+struct Ktx2Level {
+    std::vector<unsigned char> data;
+};
+
+static void put32(std::vector<unsigned char>& out, size_t at, uint32_t v) { std::memcpy(out.data() + at, &v, 4); }
+static void put64(std::vector<unsigned char>& out, size_t at, uint64_t v) { std::memcpy(out.data() + at, &v, 8); }
+static uint32_t get32(const std::vector<unsigned char>& in, size_t at) { uint32_t v; std::memcpy(&v, in.data() + at, 4); return v; }
+static uint64_t get64(const std::vector<unsigned char>& in, size_t at) { uint64_t v; std::memcpy(&v, in.data() + at, 8); return v; }
+
+// Basic Data Format Descriptor for the compressed formats above (KDFS 1.3, one block, 1-2 samples).
+static std::vector<uint32_t> buildDfd(const BlockFormat& f) {
+    const uint32_t KHR_DF_MODEL_BC1A = 128, KHR_DF_MODEL_BC3 = 130, KHR_DF_MODEL_ETC2 = 161;
+    const uint32_t CH_COLOR_BC = 0, CH_COLOR_ETC2 = 2, CH_ALPHA = 15;
+    const bool bc = (f.vkFormat == VK_FORMAT_BC1_RGB_UNORM_BLOCK || f.vkFormat == VK_FORMAT_BC3_UNORM_BLOCK);
+
+    uint32_t model = bc ? (f.hasAlpha ? KHR_DF_MODEL_BC3 : KHR_DF_MODEL_BC1A) : KHR_DF_MODEL_ETC2;
+    uint32_t colorChannel = bc ? CH_COLOR_BC : CH_COLOR_ETC2;
+    uint32_t numSamples = f.hasAlpha ? 2 : 1;
+
+    std::vector<uint32_t> words;
+    uint32_t blockSize = 24 + 16 * numSamples;
+    words.push_back(4 + blockSize);               // dfdTotalSize
+    words.push_back(0);                           // vendorId = Khronos, descriptorType = basic
+    words.push_back(2u | (blockSize << 16));      // versionNumber = 2, descriptorBlockSize
+    words.push_back(model | (1u << 8) | (1u << 16)); // colorModel, primaries BT709, transfer linear, flags 0
+    words.push_back(3u | (3u << 8));              // texel block 4x4x1x1 (stored as value-1)
+    words.push_back(f.blockBytes);                // bytesPlane0
+    words.push_back(0);                           // bytesPlane4..7
+
+    auto addSample = [&](uint32_t bitOffset, uint32_t channel) {
+        words.push_back(bitOffset | (63u << 16) | (channel << 24));
+        words.push_back(0);           // sample position
+        words.push_back(0);           // lower
+        words.push_back(0xFFFFFFFFu); // upper
+    };
+    if (f.hasAlpha) {
+        addSample(0, CH_ALPHA);
+        addSample(64, colorChannel);
+    } else {
+        addSample(0, colorChannel);
+    }
+    return words;
+}
+
+static bool writeKTX2(const std::string& path, const BlockFormat& f, int width, int height, const std::vector<Ktx2Level>& levels) {
+    const size_t headerSize = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+    const size_t levelIndexSize = levels.size() * 24;
+    std::vector<uint32_t> dfd = buildDfd(f);
+    const size_t dfdOffset = headerSize + levelIndexSize;
+    const size_t dfdSize = dfd.size() * 4;
+
+    // level data is stored smallest mip first, each level aligned to lcm(blockBytes, 4)
+    const size_t align = f.blockBytes;
+    std::vector<size_t> offsets(levels.size());
+    size_t cursor = dfdOffset + dfdSize;
+    for (size_t i = levels.size(); i-- > 0;) {
+        cursor = (cursor + align - 1) / align * align;
+        offsets[i] = cursor;
+        cursor += levels[i].data.size();
+    }
+
+    std::vector<unsigned char> out(cursor, 0);
+    std::memcpy(out.data(), KTX2_IDENTIFIER, 12);
+    put32(out, 12, f.vkFormat);
+    put32(out, 16, 1);                       // typeSize
+    put32(out, 20, (uint32_t)width);
+    put32(out, 24, (uint32_t)height);
+    put32(out, 28, 0);                       // pixelDepth
+    put32(out, 32, 0);                       // layerCount
+    put32(out, 36, 1);                       // faceCount
+    put32(out, 40, (uint32_t)levels.size()); // levelCount
+    put32(out, 44, 0);                       // supercompressionScheme
+    put32(out, 48, (uint32_t)dfdOffset);
+    put32(out, 52, (uint32_t)dfdSize);
+    put32(out, 56, 0);                       // kvd offset/length
+    put32(out, 60, 0);
+    put64(out, 64, 0);                       // sgd offset/length
+    put64(out, 72, 0);
+    for (size_t i = 0; i < levels.size(); ++i) {
+        size_t at = headerSize + i * 24;
+        put64(out, at + 0, offsets[i]);
+        put64(out, at + 8, levels[i].data.size());
+        put64(out, at + 16, levels[i].data.size());
+        std::memcpy(out.data() + offsets[i], levels[i].data.data(), levels[i].data.size());
+    }
+    std::memcpy(out.data() + dfdOffset, dfd.data(), dfdSize);
+
+    std::error_code ec;
+    std::filesystem::create_directories(TEXTURE_CACHE_DIR, ec);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "Texture cache: cannot write " << path << std::endl;
+        return false;
+    }
+    file.write((const char*)out.data(), (std::streamsize)out.size());
+    return file.good();
+}
+
+static bool readFileBytes(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    bytes.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return !bytes.empty();
+}
+
+// KTX2 file contents -> GL texture (ktxPath only names it in messages)
+static unsigned uploadKTX2(const std::vector<unsigned char>& bytes, const char* ktxPath) {
+    const size_t headerSize = 80;
+    if (bytes.size() < headerSize || std::memcmp(bytes.data(), KTX2_IDENTIFIER, 12) != 0) {
+        std::cout << "Texture cache: not a KTX2 file: " << ktxPath << std::endl;
+        return 0;
+    }
+    uint32_t vkFormat = get32(bytes, 12);
+    uint32_t width = get32(bytes, 20);
+    uint32_t height = get32(bytes, 24);
+    uint32_t levelCount = std::max(1u, get32(bytes, 40));
+    uint32_t supercompression = get32(bytes, 44);
+
+    const BlockFormat* f = findByVkFormat(vkFormat);
+    if (!f || supercompression != 0 || !isSupported(*f)) {
+        std::cout << "Texture cache: unsupported KTX2 format in " << ktxPath << std::endl;
+        return 0;
+    }
+    if (bytes.size() < headerSize + size_t(levelCount) * 24) return 0;
+
+    unsigned tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        size_t at = headerSize + size_t(level) * 24;
+        uint64_t offset = get64(bytes, at);
+        uint64_t length = get64(bytes, at + 8);
+        if (offset + length > bytes.size()) {
+            glDeleteTextures(1, &tex);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            std::cout << "Texture cache: truncated KTX2 file " << ktxPath << std::endl;
+            return 0;
+        }
+        GLsizei w = (GLsizei)std::max(1u, width >> level);
+        GLsizei h = (GLsizei)std::max(1u, height >> level);
+        glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, f->glInternalFormat, w, h, 0, (GLsizei)length, bytes.data() + offset);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levelCount - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+unsigned loadKTX2Texture(const char* ktxPath) {
+    std::vector<unsigned char> bytes;
+    if (!readFileBytes(ktxPath, bytes)) return 0;
+    return uploadKTX2(bytes, ktxPath);
+}
+
+// ---------------------------------------------------------------------------------------------
+// transcoding (first run)
+// ---------------------------------------------------------------------------------------------
+
+// Builds the mip chain, uploads it and - when a block format is available - reads the driver-encoded
+// levels back and writes them to cachePath.
+static unsigned uploadAndCache(std::vector<unsigned char> rgba, int w, int h, const std::string& cachePath) {
+    const BlockFormat* f = chooseFormat(anyTranslucent(rgba.data(), w, h));
+
+    unsigned tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    GLenum internalFormat = f ? f->glInternalFormat : GL_RGBA8;
+    int level = 0, lw = w, lh = h;
+    while (true) {
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, lw, lh, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        if (lw == 1 && lh == 1) break;
+        int nw, nh;
+        rgba = downsample(rgba, lw, lh, nw, nh);
+        lw = nw; lh = nh;
+        ++level;
+    }
+    const int levelCount = level + 1;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+    if (f) {
+        std::vector<Ktx2Level> levels(levelCount);
+        bool ok = true;
+        for (int i = 0; i < levelCount && ok; ++i) {
+            GLint compressed = 0, size = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_COMPRESSED, &compressed);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+            if (!compressed || size <= 0) { ok = false; break; }
+            levels[i].data.resize((size_t)size);
+            glGetCompressedTexImage(GL_TEXTURE_2D, i, levels[i].data.data());
+        }
+        if (ok) writeKTX2(cachePath, *f, w, h, levels);
+        else std::cout << "Texture cache: driver did not compress " << cachePath << ", not cached" << std::endl;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+// ---------------------------------------------------------------------------------------------
+// loading: CPU half (any thread) + GL half
+// ---------------------------------------------------------------------------------------------
+
+// the file or the encoded bytes -> source.rgba
+bool decodeTextureSource(TextureSource& source) {
+    int w, h, channels;
+    unsigned char* data = source.encoded.empty()
+        ? stbi_load(source.filePath.c_str(), &w, &h, &channels, STBI_rgb_alpha)
+        : stbi_load_from_memory(source.encoded.data(), (int)source.encoded.size(), &w, &h, &channels, STBI_rgb_alpha);
+    if (!data) {
+        if (source.encoded.empty()) std::cout << "Textura nije ucitana! Putanja: " << source.filePath << std::endl;
+        else std::cout << "Texture failed to decode: " << source.label << std::endl;
+        return false;
+    }
+    if (source.flipVertically) flipRows(data, w, h);
+    source.rgba.assign(data, data + size_t(w) * size_t(h) * 4);
+    source.width = w;
+    source.height = h;
+    stbi_image_free(data);
+    source.encoded.clear();
+    source.encoded.shrink_to_fit();
+    return true;
+}
+
+TextureSource readTextureSource(const char* filePath, bool flipVertically) {
+    TextureSource source;
+    source.label = filePath;
+    source.filePath = filePath;
+    source.flipVertically = flipVertically;
+    source.cachePath = cachePathFor(std::string(filePath) + (flipVertically ? "" : "_noflip"));
+    if (cacheIsFresh(source.cachePath, filePath) && readFileBytes(source.cachePath, source.ktx2)) return source;
+    decodeTextureSource(source);
+    return source;
+}
+
+TextureSource readTextureSourceFromMemory(const unsigned char* bytes, int byteCount, const std::string& cacheKey, bool flipVertically) {
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)fnv1a64(bytes, (size_t)byteCount));
+    TextureSource source;
+    source.label = cacheKey;
+    source.flipVertically = flipVertically;
+    source.cachePath = cachePathFor(cacheKey + "_" + hash + (flipVertically ? "" : "_noflip"));
+    source.encoded.assign(bytes, bytes + byteCount); // the asset may be gone by upload time
+    if (cacheIsFresh(source.cachePath, nullptr) && readFileBytes(source.cachePath, source.ktx2)) return source;
+    decodeTextureSource(source);
+    return source;
+}
+
+TextureSource readTextureSourceFromPixels(const unsigned char* rgba, int width, int height, const std::string& cacheKey) {
+    const size_t n = size_t(width) * size_t(height) * 4;
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)fnv1a64(rgba, n));
+    TextureSource source;
+    source.label = cacheKey;
+    source.cachePath = cachePathFor(cacheKey + "_" + hash);
+    source.rgba.assign(rgba, rgba + n);
+    source.width = width;
+    source.height = height;
+    if (cacheIsFresh(source.cachePath, nullptr)) readFileBytes(source.cachePath, source.ktx2);
+    return source;
+}
+
+unsigned uploadTextureSource(TextureSource& source) {
+    if (!source.ktx2.empty()) {
+        unsigned tex = uploadKTX2(source.ktx2, source.cachePath.c_str());
+        source.ktx2.clear();
+        if (tex) return tex;
+        // cached format not usable here: decode the original and rewrite the entry
+        if (source.rgba.empty() && !decodeTextureSource(source)) return 0;
+    }
+    if (source.rgba.empty()) return 0; // decode failed (reported by the read)
+    return uploadAndCache(std::move(source.rgba), source.width, source.height, source.cachePath);
+}
+
+unsigned loadTextureCached(const char* filePath, bool flipVertically) {
+    TextureSource source = readTextureSource(filePath, flipVertically);
+    return uploadTextureSource(source);
+}
+
+unsigned loadTextureCachedFromMemory(const unsigned char* bytes, int byteCount, const std::string& cacheKey, bool flipVertically) {
+    TextureSource source = readTextureSourceFromMemory(bytes, byteCount, cacheKey, flipVertically);
+    return uploadTextureSource(source);
+}
+
+unsigned loadTextureCachedFromPixels(const unsigned char* rgba, int width, int height, const std::string& cacheKey) {
+    TextureSource source = readTextureSourceFromPixels(rgba, width, height, cacheKey);
+    return uploadTextureSource(source);
+}
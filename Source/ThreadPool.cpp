@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "../Header/ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned workerCount)
+{
+    if (workerCount == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        workerCount = hw > 1 ? hw - 1 : 1;
+    }
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    cv.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return quit || !queue.empty(); });
+        if (quit && queue.empty()) return;
+        std::function<void()> task = std::move(queue.back());
+        queue.pop_back();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body)
+{
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workers.empty()) {
+        body(0, count);
+        return;
+    }
+
+    // chunks are claimed through an atomic counter; the caller helps until all are claimed
+    struct Shared {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> done{ 0 };
+        std::mutex m;
+        std::condition_variable finished;
+    };
+    auto shared = std::make_shared<Shared>();
+
+    auto drain = [shared, chunks, grain, count, &body]() {
+        size_t c;
+        while ((c = shared->next.fetch_add(1)) < chunks) {
+            size_t begin = c * grain;
+            size_t end = std::min(begin + grain, count);
+            body(begin, end);
+            if (shared->done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(shared->m);
+                shared->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min<size_t>(workers.size(), chunks - 1);
+    for (size_t i = 0; i < helpers; ++i) submit(drain);
+    drain();
+
+    std::unique_lock<std::mutex> lock(shared->m);
+    shared->finished.wait(lock, [&] { return shared->done.load() == chunks; });
+}
+
+ThreadPool& workerPool()
+{
+    static ThreadPool pool;
+    return pool;
+}
@@ -1,15 +1,39 @@
 #include "../Header/mesh.hpp"
 
+#include <cfloat>
 #include <iostream>
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, const glm::vec3& diffuseColor)
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, const glm::vec3& diffuseColor, std::vector<MeshLod> lods, bool uploadNow)
 {
     this->vertices = std::move(vertices);
     this->indices = std::move(indices);
     this->textures = std::move(textures);
     this->diffuseColor = diffuseColor;
+    this->lods = std::move(lods);
+    if (this->lods.empty())
+        this->lods.push_back({ 0u, (unsigned int)this->indices.size(), 0.0f });
 
-    setupMesh();
+    glm::vec3 bbMin(FLT_MAX), bbMax(-FLT_MAX);
+    for (const Vertex& v : this->vertices) {
+        bbMin = glm::min(bbMin, v.Position);
+        bbMax = glm::max(bbMax, v.Position);
+    }
+    if (!this->vertices.empty()) bounds = boundsFromMinMax(bbMin, bbMax);
+
+    if (uploadNow) setupMesh();
+}
+
+void Mesh::upload()
+{
+    if (!VAO) setupMesh();
+}
+
+void Mesh::release()
+{
+    if (VAO) { glDeleteVertexArrays(1, &VAO); VAO = 0; }
+    if (VBO) { glDeleteBuffers(1, &VBO); VBO = 0; }
+    if (EBO) { glDeleteBuffers(1, &EBO); EBO = 0; }
+    boundInstanceVBO = 0;
 }
 
 void Mesh::setupMesh()
@@ -34,24 +58,28 @@ void Mesh::setupMesh()
     // vertex texture coords
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    // bone ids (integer attribute)
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, MAX_BONE_INFLUENCE, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, BoneIDs));
+    // bone weights
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, MAX_BONE_INFLUENCE, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Weights));
 
     glBindVertexArray(0);
 }
 
-void Mesh::Draw(Shader& shader)
+void Mesh::bindMaterial(Shader& shader)
 {
     shader.use();
 
-    // If there are no textures, tell shader to use material color fallback
+    // If there are no textures, switch to the material color variant
+    shader.setFeature(SHADER_USE_TEX, !textures.empty());
     if (textures.empty())
     {
-        shader.setBool("uUseTex", false);
         shader.setVec3("uMatColor", diffuseColor.x, diffuseColor.y, diffuseColor.z);
     }
     else
     {
-        shader.setBool("uUseTex", true);
-
         unsigned int diffuseNr = 1;
         unsigned int specularNr = 1;
 
@@ -72,12 +100,48 @@ void Mesh::Draw(Shader& shader)
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
     }
+}
+
+const MeshLod& Mesh::lodRange(int lod) const
+{
+    if (lod < 0) lod = 0;
+    if (lod >= (int)lods.size()) lod = (int)lods.size() - 1;
+    return lods[lod];
+}
+
+void Mesh::Draw(Shader& shader, int lod)
+{
+    bindMaterial(shader);
+    const MeshLod& range = lodRange(lod);
 
     // draw mesh
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_INT, (void*)(range.indexOffset * sizeof(unsigned int)));
     glBindVertexArray(0);
 
     // reset active texture
     glActiveTexture(GL_TEXTURE0);
-}
\ No newline at end of file
+}
+
+void Mesh::DrawInstanced(Shader& shader, unsigned int instanceVBO, int instanceCount, int lod)
+{
+    if (instanceCount <= 0) return;
+    bindMaterial(shader);
+    const MeshLod& range = lodRange(lod);
+
+    glBindVertexArray(VAO);
+    if (boundInstanceVBO != instanceVBO)
+    {
+        // per-instance vec4 at location 5, advanced once per instance
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glEnableVertexAttribArray(5);
+        glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glVertexAttribDivisor(5, 1);
+        boundInstanceVBO = instanceVBO;
+    }
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_INT,
+        (void*)(range.indexOffset * sizeof(unsigned int)), instanceCount);
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+}
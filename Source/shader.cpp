@@ -1,99 +1,208 @@
 #include "../Header/shader.hpp"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
+#include "../Header/ShaderCache.h"
+#include "../Header/ShaderReload.h"
+
+// The program cache shares identical programs between Shader objects; the last one that wrote uniforms to
+// a program, so the others know its values are no longer theirs.
+static std::unordered_map<unsigned, const Shader*> programWriter;
+
+std::string shaderFeatureDefines(unsigned features)
+{
+    static const struct { unsigned bit; const char* name; } names[] = {
+        { SHADER_USE_TEX, "USE_TEX" },
+        { SHADER_SKINNED, "SKINNED" },
+        { SHADER_LIGHT_DIRECTIONAL, "LIGHT_DIRECTIONAL" },
+        { SHADER_FLIP_X, "FLIP_X" },
+        { SHADER_TILED_LIGHTS, "TILED_LIGHTS" },
+        { SHADER_SHADOWS, "SHADOWS" },
+        { SHADER_HQ_FILTER, "HQ_FILTER" },
+    };
+    std::string defines;
+    for (const auto& n : names)
+        if (features & n.bit) defines += std::string("#define ") + n.name + "\n";
+    return defines;
+}
+
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath)
 {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-
-    vShaderFile.open(vertexPath);
-    fShaderFile.open(fragmentPath);
-    if (vShaderFile.is_open() && fShaderFile.is_open())
-    {
-        std::stringstream vS, fS;
-        vS << vShaderFile.rdbuf();
-        fS << fShaderFile.rdbuf();
-        vertexCode = vS.str();
-        fragmentCode = fS.str();
+    // compiled (or restored from its binary) and shared through the program cache
+    ID = variant(0);
+    if (!ID)
+        std::cout << "ERROR::SHADER::PROGRAM::CREATION_FAILED " << vertexPath << " + " << fragmentPath << std::endl;
+}
+
+Shader::~Shader()
+{
+    for (auto& kv : variants) {
+        unwatchShaderProgram(&kv.second);
+        auto w = programWriter.find(kv.second);
+        if (w != programWriter.end() && w->second == this) programWriter.erase(w);
     }
+}
+
+unsigned Shader::variant(unsigned features)
+{
+    auto it = variants.find(features);
+    if (it != variants.end()) return it->second;
+
+    const std::string defines = shaderFeatureDefines(features);
+    std::string vertexCode = insertShaderDefines(readShaderSource(vertexPath.c_str()), defines);
+    std::string fragmentCode = insertShaderDefines(readShaderSource(fragmentPath.c_str()), defines);
+    unsigned program = 0;
+    if (!vertexCode.empty() && !fragmentCode.empty())
+        program = acquireProgramFromSource(vertexCode, fragmentCode, vertexPath + " + " + fragmentPath + (defines.empty() ? "" : " [variant " + std::to_string(features) + "]"));
+
+    // a failed variant stays 0 (no rebuild every frame) until hot reload brings a fixed source
+    unsigned& slot = variants[features];
+    slot = program;
+    watchShaderProgram(&slot, vertexPath.c_str(), fragmentPath.c_str(), [this, features](unsigned p) {
+        if (programCallback) programCallback(p);
+        if (activeFeatures != features) return; // an inactive variant gets its uniforms when switched to
+        // the new program starts with default uniforms: bind it and give it the recorded values
+        ID = p;
+        glUseProgram(p);
+        replayUniforms();
+    }, defines);
+    if (program && programCallback) programCallback(program);
+    return program;
+}
+
+void Shader::use()
+{
+    glUseProgram(ID);
+}
+
+void Shader::setFeatures(unsigned features)
+{
+    if (features == activeFeatures && ID) return;
+    unsigned program = variant(features);
+    if (!program) return; // keep drawing with the current variant
+    activeFeatures = features;
+    if (program == ID) return;
+    ID = program;
+    glUseProgram(ID);
+    replayUniforms();
+}
+
+void Shader::setFeature(ShaderFeature feature, bool enabled)
+{
+    setFeatures(enabled ? (activeFeatures | feature) : (activeFeatures & ~(unsigned)feature));
+}
+
+void Shader::onProgramCreated(std::function<void(unsigned)> callback)
+{
+    programCallback = callback;
+    if (!programCallback) return;
+    for (auto& kv : variants)
+        if (kv.second) programCallback(kv.second);
+}
+
+size_t Shader::uniformSlot(const std::string& name, UniformType type) const
+{
+    auto it = uniformIndex.find(name);
+    size_t index;
+    if (it != uniformIndex.end()) index = it->second;
     else {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-    }
-    vShaderFile.close();
-    fShaderFile.close();
-
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
-
-    unsigned int vertex, fragment;
-    int success;
-    char infoLog[512];
-
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        index = uniforms.size();
+        uniforms.emplace_back();
+        uniforms.back().name = name;
+        uniformIndex.emplace(name, index);
     }
+    UniformValue& u = uniforms[index];
+    u.type = type;
+    u.version = ++uniformVersion;
+    return index;
+}
 
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+Shader::VariantUniforms& Shader::activeUniforms() const
+{
+    if (!active || active->program != ID) {
+        active = &variantUniforms[activeFeatures];
+        if (active->program != ID) { // first use, or hot reload replaced the program
+            active->program = ID;
+            active->locations.clear();
+            active->applied.clear();
+        }
+    }
+    const size_t n = uniforms.size();
+    if (active->locations.size() < n) {
+        active->locations.resize(n, -2);
+        active->applied.resize(n, 0);
+    }
+    auto& writer = programWriter[ID];
+    if (writer != this) { // another Shader sharing the program wrote its values
+        std::fill(active->applied.begin(), active->applied.end(), 0u);
+        writer = this;
     }
+    return *active;
+}
 
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(ID, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+void Shader::applyUniform(VariantUniforms& state, size_t index) const
+{
+    const UniformValue& value = uniforms[index];
+    state.applied[index] = value.version;
+    GLint& loc = state.locations[index];
+    if (loc == -2) loc = state.program ? glGetUniformLocation(state.program, value.name.c_str()) : -1;
+    if (loc < 0) return;
+    switch (value.type) {
+    case UNIFORM_INT:   glUniform1i(loc, value.i); break;
+    case UNIFORM_FLOAT: glUniform1f(loc, value.f[0]); break;
+    case UNIFORM_VEC3:  glUniform3f(loc, value.f[0], value.f[1], value.f[2]); break;
+    case UNIFORM_MAT3:  glUniformMatrix3fv(loc, 1, GL_FALSE, value.f); break;
+    case UNIFORM_MAT4:  glUniformMatrix4fv(loc, 1, GL_FALSE, value.f); break;
     }
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
 }
 
-void Shader::use()
+void Shader::replayUniforms() const
 {
-    glUseProgram(ID);
+    VariantUniforms& state = activeUniforms();
+    for (size_t i = 0; i < uniforms.size(); ++i)
+        if (state.applied[i] != uniforms[i].version) applyUniform(state, i);
 }
 
 void Shader::setBool(const std::string& name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setInt(name, (int)value);
 }
 
 void Shader::setInt(const std::string& name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    const size_t i = uniformSlot(name, UNIFORM_INT);
+    uniforms[i].i = value;
+    applyUniform(activeUniforms(), i);
 }
 
 void Shader::setFloat(const std::string& name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    const size_t i = uniformSlot(name, UNIFORM_FLOAT);
+    uniforms[i].f[0] = value;
+    applyUniform(activeUniforms(), i);
 }
 
 void Shader::setVec3(const std::string& name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    const size_t i = uniformSlot(name, UNIFORM_VEC3);
+    float* f = uniforms[i].f;
+    f[0] = x; f[1] = y; f[2] = z;
+    applyUniform(activeUniforms(), i);
+}
+
+void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
+{
+    const size_t i = uniformSlot(name, UNIFORM_MAT3);
+    std::memcpy(uniforms[i].f, &mat[0][0], sizeof(float) * 9);
+    applyUniform(activeUniforms(), i);
 }
 
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-}
\ No newline at end of file
+    const size_t i = uniformSlot(name, UNIFORM_MAT4);
+    std::memcpy(uniforms[i].f, &mat[0][0], sizeof(float) * 16);
+    applyUniform(activeUniforms(), i);
+}
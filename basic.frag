@@ -9,7 +9,7 @@ uniform vec3 uViewPos;
 uniform vec3 uLightColor;
 uniform float uLightIntensity;
 
-uniform bool uUseTex;
+// USE_TEX (variant define) => diffuse texture, otherwise the material color
 uniform vec3 uMatColor;
 
 uniform float uSpecularStrength;
@@ -25,10 +25,11 @@ out vec4 FragColor;
 
 void main()
 {
+#ifdef USE_TEX
+    vec3 color = texture(uDiffMap1, TexCoords).rgb;
+#else
     vec3 color = uMatColor;
-    if (uUseTex) {
-        color = texture(uDiffMap1, TexCoords).rgb;
-    }
+#endif
 
     vec3 norm = normalize(NormalWorld);
 
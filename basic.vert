@@ -3,10 +3,21 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoords;
+layout(location = 3) in ivec4 aBoneIds;  // -1 = unused influence
+layout(location = 4) in vec4 aWeights;
+
+const int MAX_BONES = 128; // must match MAX_BONES in Animation.h
 
 uniform mat4 uM;
 uniform mat4 uV;
 uniform mat4 uP;
+uniform mat3 uNormalMat; // transpose(inverse(mat3(uM))), computed once per draw on the CPU
+
+// bone palette sampled on the CPU worker thread (see AnimationWorker)
+layout(std140) uniform BoneBlock {
+    mat4 uBones[MAX_BONES];
+};
+// SKINNED (variant define) => apply the palette
 
 out vec2 TexCoords;
 out vec3 FragPosWorld;
@@ -14,13 +25,29 @@ out vec3 NormalWorld;
 
 void main()
 {
+    // linear blend skinning; vertices without influences keep their bind position
+    mat4 skin = mat4(1.0);
+#ifdef SKINNED
+    mat4 blended = mat4(0.0);
+    float total = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        if (aBoneIds[i] >= 0) {
+            blended += uBones[aBoneIds[i]] * aWeights[i];
+            total += aWeights[i];
+        }
+    }
+    if (total > 0.0) skin = blended;
+#endif
+    vec4 localPos = skin * vec4(aPos, 1.0);
+    vec3 localNormal = mat3(skin) * aNormal;
+
     // compute world / view / clip positions robustly and always write gl_Position
-    vec4 worldPos = uM * vec4(aPos, 1.0);
+    vec4 worldPos = uM * localPos;
     vec4 viewPos = uV * worldPos;
     gl_Position = uP * viewPos;
 
     FragPosWorld = vec3(worldPos);
-    // Normal transform: use model (upper-left 3x3) inverse-transpose via mat3(uM)
-    NormalWorld = mat3(transpose(inverse(uM))) * aNormal;
+    // Normal transform: model (upper-left 3x3) inverse-transpose, uploaded per draw
+    NormalWorld = uNormalMat * localNormal;
     TexCoords = aTexCoords;
-}
\ No newline at end of file
+}
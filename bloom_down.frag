@@ -0,0 +1,41 @@
+#version 330 core
+
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2  uTexel;     // 1 / source size
+uniform float uThreshold; // first pass only: keep what is brighter than this (0 = pass through)
+
+void main()
+{
+#ifdef HQ_FILTER
+    // 13 bilinear taps (36 texels), weighted so the result stays stable when bright pixels move
+    vec3 a = texture(uSource, vUV + uTexel * vec2(-2.0,  2.0)).rgb;
+    vec3 b = texture(uSource, vUV + uTexel * vec2( 0.0,  2.0)).rgb;
+    vec3 c = texture(uSource, vUV + uTexel * vec2( 2.0,  2.0)).rgb;
+    vec3 d = texture(uSource, vUV + uTexel * vec2(-2.0,  0.0)).rgb;
+    vec3 e = texture(uSource, vUV).rgb;
+    vec3 f = texture(uSource, vUV + uTexel * vec2( 2.0,  0.0)).rgb;
+    vec3 g = texture(uSource, vUV + uTexel * vec2(-2.0, -2.0)).rgb;
+    vec3 h = texture(uSource, vUV + uTexel * vec2( 0.0, -2.0)).rgb;
+    vec3 i = texture(uSource, vUV + uTexel * vec2( 2.0, -2.0)).rgb;
+    vec3 j = texture(uSource, vUV + uTexel * vec2(-1.0,  1.0)).rgb;
+    vec3 k = texture(uSource, vUV + uTexel * vec2( 1.0,  1.0)).rgb;
+    vec3 l = texture(uSource, vUV + uTexel * vec2(-1.0, -1.0)).rgb;
+    vec3 m = texture(uSource, vUV + uTexel * vec2( 1.0, -1.0)).rgb;
+    vec3 color = e * 0.125 + (a + c + g + i) * 0.03125 + (b + d + f + h) * 0.0625 + (j + k + l + m) * 0.125;
+#else
+    // 4 bilinear taps = 4x4 box
+    vec3 color = (texture(uSource, vUV + uTexel * vec2(-1.0,  1.0)).rgb +
+                  texture(uSource, vUV + uTexel * vec2( 1.0,  1.0)).rgb +
+                  texture(uSource, vUV + uTexel * vec2(-1.0, -1.0)).rgb +
+                  texture(uSource, vUV + uTexel * vec2( 1.0, -1.0)).rgb) * 0.25;
+#endif
+
+    // scale by how far the brightest channel is over the threshold (keeps the hue)
+    float bright = max(color.r, max(color.g, color.b));
+    color *= max(bright - uThreshold, 0.0) / max(bright, 0.0001);
+
+    FragColor = vec4(color, 1.0);
+}
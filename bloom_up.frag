@@ -0,0 +1,28 @@
+#version 330 core
+
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource; // the smaller mip, added onto this one (additive blending)
+uniform vec2 uTexel;       // 1 / source size
+
+void main()
+{
+#ifdef HQ_FILTER
+    // 3x3 tent
+    vec3 color = texture(uSource, vUV).rgb * 4.0;
+    color += (texture(uSource, vUV + uTexel * vec2( 0.0,  1.0)).rgb +
+              texture(uSource, vUV + uTexel * vec2( 0.0, -1.0)).rgb +
+              texture(uSource, vUV + uTexel * vec2( 1.0,  0.0)).rgb +
+              texture(uSource, vUV + uTexel * vec2(-1.0,  0.0)).rgb) * 2.0;
+    color += texture(uSource, vUV + uTexel * vec2(-1.0,  1.0)).rgb +
+             texture(uSource, vUV + uTexel * vec2( 1.0,  1.0)).rgb +
+             texture(uSource, vUV + uTexel * vec2(-1.0, -1.0)).rgb +
+             texture(uSource, vUV + uTexel * vec2( 1.0, -1.0)).rgb;
+    color *= 1.0 / 16.0;
+#else
+    // bilinear magnification is the blur
+    vec3 color = texture(uSource, vUV).rgb;
+#endif
+    FragColor = vec4(color, 1.0);
+}
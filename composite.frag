@@ -0,0 +1,16 @@
+#version 330 core
+
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uScene; // HDR scene (lit surfaces are already clamped to 0..1, emissive ones are not)
+uniform sampler2D uBloom;
+uniform float uBloomIntensity;
+
+void main()
+{
+    vec3 scene = texture(uScene, vUV).rgb;
+    vec3 bloom = texture(uBloom, vUV).rgb;
+    vec3 color = min(scene, vec3(1.0)) + bloom * uBloomIntensity;
+    FragColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
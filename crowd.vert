@@ -0,0 +1,56 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoords;
+layout(location = 3) in ivec4 aBoneIds;  // -1 = unused influence
+layout(location = 4) in vec4 aWeights;
+layout(location = 5) in vec4 aInstance;  // per agent: x, z, sin(yaw), cos(yaw)
+
+const int MAX_BONES = 128; // must match MAX_BONES in Animation.h
+
+uniform mat4 uBase;   // shared scale / centering / model orientation
+uniform float uLift;  // height of the agent origin above the plane
+uniform mat4 uV;
+uniform mat4 uP;
+
+// the crowd shares the avatar's walk cycle palette
+layout(std140) uniform BoneBlock {
+    mat4 uBones[MAX_BONES];
+};
+// SKINNED (variant define) => apply the palette
+
+out vec2 TexCoords;
+out vec3 FragPosWorld;
+out vec3 NormalWorld;
+
+void main()
+{
+    mat4 skin = mat4(1.0);
+#ifdef SKINNED
+    mat4 blended = mat4(0.0);
+    float total = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        if (aBoneIds[i] >= 0) {
+            blended += uBones[aBoneIds[i]] * aWeights[i];
+            total += aWeights[i];
+        }
+    }
+    if (total > 0.0) skin = blended;
+#endif
+    vec4 localPos = uBase * (skin * vec4(aPos, 1.0));
+    // uBase is rotation + uniform scale, so its upper 3x3 is fine for normals
+    vec3 localNormal = mat3(uBase) * (mat3(skin) * aNormal);
+
+    // yaw around Y then move to the agent's spot on the plane
+    float s = aInstance.z;
+    float c = aInstance.w;
+    vec3 worldPos = vec3(c * localPos.x + s * localPos.z, localPos.y, -s * localPos.x + c * localPos.z);
+    worldPos += vec3(aInstance.x, uLift, aInstance.y);
+
+    gl_Position = uP * uV * vec4(worldPos, 1.0);
+
+    FragPosWorld = worldPos;
+    NormalWorld = normalize(vec3(c * localNormal.x + s * localNormal.z, localNormal.y, -s * localNormal.x + c * localNormal.z));
+    TexCoords = aTexCoords;
+}
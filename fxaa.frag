@@ -0,0 +1,112 @@
+#version 330 core
+
+// FXAA (after Lottes' FXAA 3.11 quality preset): find the local edge, walk along it to both ends and
+// blend the pixel across the edge by how far it sits from the nearer end. Input is the LDR composite.
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2 uTexel; // 1 / source size
+
+#define EDGE_THRESHOLD     0.125  // minimum local contrast, relative to the brightest neighbour
+#define EDGE_THRESHOLD_MIN 0.0312 // ... and absolute, so dark areas are left alone
+#define SUBPIXEL_QUALITY   0.75
+#define SEARCH_STEPS       10
+
+const float stepScale[SEARCH_STEPS] = float[](1.0, 1.0, 1.5, 2.0, 2.0, 2.0, 2.0, 4.0, 8.0, 8.0);
+
+float luma(vec3 c)
+{
+    return sqrt(dot(c, vec3(0.299, 0.587, 0.114)));
+}
+
+float lumaAt(vec2 uv)
+{
+    return luma(textureLod(uSource, uv, 0.0).rgb);
+}
+
+void main()
+{
+    vec3 colorM = textureLod(uSource, vUV, 0.0).rgb;
+    float lumaM = luma(colorM);
+    float lumaN = luma(textureLodOffset(uSource, vUV, 0.0, ivec2( 0,  1)).rgb);
+    float lumaS = luma(textureLodOffset(uSource, vUV, 0.0, ivec2( 0, -1)).rgb);
+    float lumaE = luma(textureLodOffset(uSource, vUV, 0.0, ivec2( 1,  0)).rgb);
+    float lumaW = luma(textureLodOffset(uSource, vUV, 0.0, ivec2(-1,  0)).rgb);
+
+    float lumaMin = min(lumaM, min(min(lumaN, lumaS), min(lumaE, lumaW)));
+    float lumaMax = max(lumaM, max(max(lumaN, lumaS), max(lumaE, lumaW)));
+    float range = lumaMax - lumaMin;
+    if (range < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD)) {
+        FragColor = vec4(colorM, 1.0);
+        return;
+    }
+
+    float lumaNW = luma(textureLodOffset(uSource, vUV, 0.0, ivec2(-1,  1)).rgb);
+    float lumaNE = luma(textureLodOffset(uSource, vUV, 0.0, ivec2( 1,  1)).rgb);
+    float lumaSW = luma(textureLodOffset(uSource, vUV, 0.0, ivec2(-1, -1)).rgb);
+    float lumaSE = luma(textureLodOffset(uSource, vUV, 0.0, ivec2( 1, -1)).rgb);
+
+    // edge orientation from second differences across rows vs columns
+    float edgeH = abs(lumaNW + lumaSW - 2.0 * lumaW) + 2.0 * abs(lumaN + lumaS - 2.0 * lumaM) + abs(lumaNE + lumaSE - 2.0 * lumaE);
+    float edgeV = abs(lumaNW + lumaNE - 2.0 * lumaN) + 2.0 * abs(lumaW + lumaE - 2.0 * lumaM) + abs(lumaSW + lumaSE - 2.0 * lumaS);
+    bool horizontal = edgeH >= edgeV;
+
+    // which side of the pixel the edge is on
+    float luma1 = horizontal ? lumaS : lumaW;
+    float luma2 = horizontal ? lumaN : lumaE;
+    float gradient1 = luma1 - lumaM;
+    float gradient2 = luma2 - lumaM;
+    bool side1 = abs(gradient1) >= abs(gradient2);
+    float gradientScaled = 0.25 * max(abs(gradient1), abs(gradient2));
+
+    float stepLength = horizontal ? uTexel.y : uTexel.x;
+    float lumaLocal;
+    if (side1) {
+        stepLength = -stepLength;
+        lumaLocal = 0.5 * (luma1 + lumaM);
+    } else {
+        lumaLocal = 0.5 * (luma2 + lumaM);
+    }
+
+    // walk along the edge (half a pixel towards it) until the contrast changes at both ends
+    vec2 uvEdge = vUV;
+    if (horizontal) uvEdge.y += stepLength * 0.5;
+    else            uvEdge.x += stepLength * 0.5;
+    vec2 offset = horizontal ? vec2(uTexel.x, 0.0) : vec2(0.0, uTexel.y);
+
+    vec2 uv1 = uvEdge - offset;
+    vec2 uv2 = uvEdge + offset;
+    float end1 = 0.0, end2 = 0.0;
+    bool reached1 = false, reached2 = false;
+    for (int i = 0; i < SEARCH_STEPS; ++i) {
+        if (!reached1) end1 = lumaAt(uv1) - lumaLocal;
+        if (!reached2) end2 = lumaAt(uv2) - lumaLocal;
+        reached1 = abs(end1) >= gradientScaled;
+        reached2 = abs(end2) >= gradientScaled;
+        if (reached1 && reached2) break;
+        if (!reached1) uv1 -= offset * stepScale[i];
+        if (!reached2) uv2 += offset * stepScale[i];
+    }
+
+    float dist1 = horizontal ? (vUV.x - uv1.x) : (vUV.y - uv1.y);
+    float dist2 = horizontal ? (uv2.x - vUV.x) : (uv2.y - vUV.y);
+    bool nearer1 = dist1 < dist2;
+    float pixelOffset = 0.5 - min(dist1, dist2) / (dist1 + dist2);
+
+    // only blend if the nearer end goes the same way as the center (otherwise we are outside the edge)
+    bool centerDarker = lumaM < lumaLocal;
+    bool correct = ((nearer1 ? end1 : end2) < 0.0) != centerDarker;
+    float finalOffset = correct ? pixelOffset : 0.0;
+
+    // sub-pixel aliasing: thin features the edge walk cannot see
+    float lumaAverage = (2.0 * (lumaN + lumaS + lumaE + lumaW) + lumaNW + lumaNE + lumaSW + lumaSE) / 12.0;
+    float sub = clamp(abs(lumaAverage - lumaM) / range, 0.0, 1.0);
+    sub = (-2.0 * sub + 3.0) * sub * sub;
+    finalOffset = max(finalOffset, sub * sub * SUBPIXEL_QUALITY);
+
+    vec2 uv = vUV;
+    if (horizontal) uv.y += finalOffset * stepLength;
+    else            uv.x += finalOffset * stepLength;
+    FragColor = vec4(textureLod(uSource, uv, 0.0).rgb, 1.0);
+}
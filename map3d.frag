@@ -8,16 +8,80 @@ out vec4 FragColor;
 
 uniform sampler2D uMapTex;
 
-// Lighting uniforms
-uniform vec3 uLightPos;
-uniform vec3 uLightColor;
-uniform float uLightIntensity;
-uniform float uLightRadius; // radius for point light falloff
-uniform vec3 uViewPos;
+// Scene light, shared by all views (uploadSceneLight, Lighting.h)
+layout(std140) uniform SceneLightBlock {
+    vec4 uLightPosRadius;       // xyz position, w radius for point light falloff
+    vec4 uLightColorIntensity;  // rgb color, a intensity
+    vec4 uLightDirection;       // xyz direction FROM which light comes (should be normalized)
+};
+#define uLightPos       uLightPosRadius.xyz
+#define uLightRadius    uLightPosRadius.w
+#define uLightColor     uLightColorIntensity.rgb
+#define uLightIntensity uLightColorIntensity.a
+#define uLightDir       uLightDirection.xyz
+
+uniform vec3 uViewPos; // per view
+
+// New directional support: LIGHT_DIRECTIONAL (variant define) => directional, otherwise point light
+
+#ifdef SHADOWS
+// Avatar shadow map (see Shadow.h): depth compare in hardware, (2r+1)^2 taps of 2x2 bilinear PCF
+uniform sampler2DShadow uShadowMap;
+uniform mat4 uLightVP;
+uniform int  uShadowPcf; // kernel radius in texels, clamped to 0..2 on the CPU
+
+float shadowFactor()
+{
+    vec4 ls = uLightVP * vec4(vWorldPos, 1.0);
+    vec3 p = ls.xyz / ls.w * 0.5 + 0.5;
+    if (p.z > 1.0) return 1.0; // beyond the light box (border texels are lit)
+
+    vec2 texel = 1.0 / vec2(textureSize(uShadowMap, 0));
+    float sum = 0.0;
+    for (int y = -uShadowPcf; y <= uShadowPcf; ++y)
+        for (int x = -uShadowPcf; x <= uShadowPcf; ++x)
+            sum += texture(uShadowMap, vec3(p.xy + vec2(x, y) * texel, p.z - 0.0015));
+    float taps = float((2 * uShadowPcf + 1) * (2 * uShadowPcf + 1));
+    return sum / taps;
+}
+#endif
+
+#ifdef TILED_LIGHTS
+// Street lights / pin glows binned per screen tile on the CPU (see Lighting.h)
+uniform samplerBuffer  uLights;     // 2 texels per light: (position, radius), (color * intensity, 0)
+uniform isamplerBuffer uTileLights; // per tile: x = first entry in uLightIndex, y = count
+uniform isamplerBuffer uLightIndex;
+uniform int uTileSize;
+uniform int uTilesX;
+
+vec3 tileLights(vec3 albedo, vec3 N, vec3 V)
+{
+    ivec2 tile = ivec2(gl_FragCoord.xy) / uTileSize;
+    ivec2 range = texelFetch(uTileLights, tile.y * uTilesX + tile.x).xy;
 
-// New directional support
-uniform int  uLightDirectional; // 1 => directional, 0 => point light
-uniform vec3 uLightDir;         // direction FROM which light comes (should be normalized)
+    vec3 sum = vec3(0.0);
+    for (int i = 0; i < range.y; ++i) {
+        int li = texelFetch(uLightIndex, range.x + i).r;
+        vec4 posRadius = texelFetch(uLights, li * 2);
+        vec3 color = texelFetch(uLights, li * 2 + 1).rgb;
+
+        vec3 toLight = posRadius.xyz - vWorldPos;
+        float dist = length(toLight);
+        // smooth window so the light ends exactly at its radius (no seams at tile borders)
+        float x = dist / posRadius.w;
+        float window = clamp(1.0 - x * x * x * x, 0.0, 1.0);
+        float att = window * window / (1.0 + dist * dist);
+        if (att <= 0.0) continue;
+
+        vec3 L = toLight / max(dist, 0.0001);
+        vec3 H = normalize(L + V);
+        float diff = max(dot(N, L), 0.0);
+        float spec = 0.25 * pow(max(dot(N, H), 0.0), 32.0);
+        sum += (diff * albedo + spec) * color * att;
+    }
+    return sum;
+}
+#endif
 
 void main()
 {
@@ -27,21 +91,21 @@ void main()
     vec3 L;
     float att = 1.0;
 
-    if (uLightDirectional == 1) {
-        // directional (sun) - constant intensity across the scene
-        // use given light direction (coming FROM), so vector to light = -dir
-        L = normalize(-uLightDir);
-
-        // directional gets full, no distance attenuation
-        att = 1.0;
-    } else {
-        // point light with smooth radius falloff
-        vec3 toLight = (uLightPos - vWorldPos);
-        float dist = length(toLight);
-        L = normalize(toLight);
-        float r = max(uLightRadius, 0.0001);
-        att = 1.0 / (1.0 + (dist * dist) / (r * r));
-    }
+#ifdef LIGHT_DIRECTIONAL
+    // directional (sun) - constant intensity across the scene
+    // use given light direction (coming FROM), so vector to light = -dir
+    L = normalize(-uLightDir);
+
+    // directional gets full, no distance attenuation
+    att = 1.0;
+#else
+    // point light with smooth radius falloff
+    vec3 toLight = (uLightPos - vWorldPos);
+    float dist = length(toLight);
+    L = normalize(toLight);
+    float r = max(uLightRadius, 0.0001);
+    att = 1.0 / (1.0 + (dist * dist) / (r * r));
+#endif
 
     vec3 V = normalize(uViewPos - vWorldPos);
     vec3 H = normalize(L + V);
@@ -60,7 +124,13 @@ void main()
     float shininess = 32.0;
     vec3 specular = specularStrength * pow(NdotH, shininess) * uLightColor;
 
+#ifdef SHADOWS
+    att *= shadowFactor();
+#endif
     vec3 color = ambient + (diffuse + specular) * uLightIntensity * att;
+#ifdef TILED_LIGHTS
+    color += tileLights(albedo, N, V);
+#endif
 
     // clamp to avoid excessive values
     color = clamp(color, 0.0, 1.0);
@@ -11,23 +11,24 @@ out vec3 vWorldPos;
 uniform mat4 uM; // model
 uniform mat4 uV; // view
 uniform mat4 uP; // projection
+uniform mat3 uNormalMat; // transpose(inverse(mat3(uM))), computed once per draw on the CPU
 uniform vec2 uTexOffset; // texture-space pan (0..1)
 uniform float uTexScale; // texture-space scale (<1 = zoom in)
 
-uniform int uFlipX; // 1 => flip U (horizontal), 0 => normal
+// FLIP_X (variant define) => flip U (horizontal)
 
 void main()
 {
     vec4 worldPos = uM * vec4(inPos, 1.0);
     vWorldPos = worldPos.xyz;
-    vNormal = mat3(transpose(inverse(uM))) * inNormal;
+    vNormal = uNormalMat * inNormal;
 
     vec2 t = inTex * uTexScale + uTexOffset;
-    if (uFlipX == 1) {
-        vTex = vec2(1.0 - t.x, t.y);
-    } else {
-        vTex = t;
-    }
+#ifdef FLIP_X
+    vTex = vec2(1.0 - t.x, t.y);
+#else
+    vTex = t;
+#endif
 
     gl_Position = uP * uV * worldPos;
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 330 core
+
+// depth-only pass for the avatar shadow map (Shadow.cpp); depth is written by the rasterizer
+void main()
+{
+}